@@ -0,0 +1,94 @@
+#include "config.h"
+
+#include "bench.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+/* Measure the cold D-Bus activation latency of an idle exiting daemon.
+ *
+ * It waits until the service has exited, then times a Get of Elapsed,
+ * which makes the bus activate the service and wait for its reply.
+ * The service must be installed with -Didle_exit_timeout set.
+ */
+
+using namespace phosphor::time;
+using namespace std::chrono;
+
+namespace
+{
+constexpr auto dbusService = "org.freedesktop.DBus";
+constexpr auto dbusPath = "/org/freedesktop/DBus";
+constexpr auto dbusInterface = "org.freedesktop.DBus";
+constexpr auto epochIntf = "xyz.openbmc_project.Time.EpochTime";
+constexpr size_t defaultIterations = 5;
+
+// The exit code for meson to report the benchmark as skipped
+constexpr int exitSkip = 77;
+
+bool hasOwner(sdbusplus::bus_t& bus)
+{
+    auto m = bus.new_method_call(dbusService, dbusPath, dbusInterface,
+                                 "NameHasOwner");
+    m.append(busname);
+    bool owned = false;
+    bus.call(m).read(owned);
+    return owned;
+}
+
+bool waitForExit(sdbusplus::bus_t& bus, seconds limit)
+{
+    auto deadline = steady_clock::now() + limit;
+    while (hasOwner(bus))
+    {
+        if (steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(100));
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = defaultIterations;
+    seconds limit(IDLE_EXIT_TIMEOUT_SEC * 3 + 10);
+    if (argc > 1)
+    {
+        iterations = std::strtoul(argv[1], nullptr, 10);
+    }
+    if (argc > 2)
+    {
+        limit = seconds(std::strtoul(argv[2], nullptr, 10));
+    }
+
+    auto bus = sdbusplus::bus::new_default();
+    std::vector<nanoseconds> samples;
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        if (!waitForExit(bus, limit))
+        {
+            std::printf("%s did not exit within %llds, is idle exit "
+                        "enabled?\n",
+                        busname, static_cast<long long>(limit.count()));
+            return exitSkip;
+        }
+
+        auto start = steady_clock::now();
+        auto m = bus.new_method_call(busname, objpathBmc,
+                                     "org.freedesktop.DBus.Properties", "Get");
+        m.append(epochIntf, "Elapsed");
+        bus.call(m);
+        samples.emplace_back(steady_clock::now() - start);
+    }
+
+    bench::print("cold activation Get Elapsed", bench::summarize(samples));
+    return 0;
+}
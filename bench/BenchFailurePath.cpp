@@ -0,0 +1,93 @@
+#include "bench.hpp"
+#include "utils.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/bus.hpp>
+
+#include <cstdlib>
+#include <stdexcept>
+
+/* Compare the cost of a failing D-Bus lookup when it is reported by an
+ * exception against when it is returned in a std::expected.
+ *
+ * The object path below is never registered, so every mapper lookup fails,
+ * or the call fails outright when no mapper is running on the bus. The
+ * throwing helpers log the failure to the journal, so the expected variants
+ * log the same line and the two differ only in how the error is reported.
+ */
+
+using namespace phosphor::time;
+
+PHOSPHOR_LOG2_USING;
+
+namespace
+{
+constexpr auto missingPath = "/xyz/openbmc_project/time/bench/missing";
+constexpr auto missingIntf = "xyz.openbmc_project.Time.Bench.Missing";
+constexpr auto missingService = "xyz.openbmc_project.Time.Bench.Missing";
+constexpr size_t defaultIterations = 2000;
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = defaultIterations;
+    if (argc > 1)
+    {
+        iterations = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    auto bus = sdbusplus::bus::new_default();
+    size_t failures = 0;
+
+    bench::measure("getService (throw)", iterations, [&]() {
+        try
+        {
+            utils::getService(bus, missingPath, missingIntf);
+        }
+        catch (const std::runtime_error&)
+        {
+            ++failures;
+        }
+    });
+
+    bench::measure("tryGetService (expected)", iterations, [&]() {
+        auto service = utils::tryGetService(bus, missingPath, missingIntf);
+        if (!service)
+        {
+            error("Mapper call failed: path:{PATH}, interface:{INTF}, "
+                  "error:{ERROR}",
+                  "PATH", missingPath, "INTF", missingIntf, "ERROR",
+                  service.error().message);
+            ++failures;
+        }
+    });
+
+    bench::measure("getProperty (throw)", iterations, [&]() {
+        try
+        {
+            utils::getProperty<std::string>(bus, missingService, missingPath,
+                                            missingIntf, "Missing");
+        }
+        catch (const std::runtime_error&)
+        {
+            ++failures;
+        }
+    });
+
+    bench::measure("tryGetProperty (expected)", iterations, [&]() {
+        auto value = utils::tryGetProperty<std::string>(
+            bus, missingService, missingPath, missingIntf, "Missing");
+        if (!value)
+        {
+            error("GetProperty call failed, path:{PATH}, interface:{INTF}, "
+                  "propertyName:{NAME}, error:{ERROR}",
+                  "PATH", missingPath, "INTF", missingIntf, "NAME", "Missing",
+                  "ERROR", value.error().message);
+            ++failures;
+        }
+    });
+
+    // Both variants must have failed on every call for the comparison to
+    // be meaningful.
+    return failures == iterations * 4 ? 0 : 1;
+}
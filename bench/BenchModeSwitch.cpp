@@ -0,0 +1,129 @@
+#include "bench.hpp"
+#include "clock.hpp"
+#include "harness.hpp"
+#include "manager.hpp"
+#include "mode_trace.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+/* Time the switches of the time mode from the settings signal to the
+ * synchronized clock.
+ *
+ * Usage: BenchModeSwitch [switches] [sync delay ms]
+ *
+ * The Manager runs in process on a private bus with the stand-in peers and
+ * a SimulatedClock. TimeSyncMethod is flipped between NTP and Manual,
+ * default 200 times, and each switch is waited for until ModeTrace has
+ * it complete. The stand-in timedated reports NTPSynchronized the sync
+ * delay after NTP is enabled, default 100ms, in place of an NTP daemon.
+ * The durations of each stage are summarized per mode.
+ *
+ * The run fails if a target is missed:
+ * - every switch completes within 5 seconds
+ * - from the settings signal to timedate-ntp takes at most 20ms at p99,
+ *   the part of a switch the daemon and timedated are responsible for
+ */
+
+using namespace phosphor::time;
+using namespace phosphor::time::bench;
+using namespace std::chrono;
+
+namespace
+{
+constexpr auto settingsService = "xyz.openbmc_project.Settings";
+constexpr auto settingsPath = "/xyz/openbmc_project/time/sync_method";
+constexpr auto settingsIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto ntpSync = "xyz.openbmc_project.Time.Synchronization.Method.NTP";
+constexpr auto manualSync =
+    "xyz.openbmc_project.Time.Synchronization.Method.Manual";
+
+constexpr size_t defaultSwitches = 200;
+constexpr auto defaultSyncDelay = milliseconds(100);
+constexpr auto maxSwitch = seconds(5);
+constexpr auto maxToTimedateP99 = milliseconds(20);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t switches = (argc > 1) ? std::strtoul(argv[1], nullptr, 10)
+                                 : defaultSwitches;
+    auto syncDelay = (argc > 2) ? milliseconds(std::atoi(argv[2]))
+                                : defaultSyncDelay;
+
+    PrivateBus privateBus;
+    StandinPeers peers(privateBus.address());
+    peers.setSyncDelay(syncDelay);
+    auto bus = connect(privateBus.address());
+
+    SimulatedClock clock;
+    Manager manager(bus, clock);
+    const auto& trace = manager.getModeTrace();
+
+    std::map<std::string, std::vector<nanoseconds>> stages;
+    std::vector<nanoseconds> toTimedate;
+    bool ntp = (Mode::NTP == manager.getTimeMode());
+
+    for (size_t i = 0; i < switches; ++i)
+    {
+        ntp = !ntp;
+        auto mode = ntp ? Mode::NTP : Mode::Manual;
+        std::string method = ntp ? ntpSync : manualSync;
+        utils::setProperty(bus, settingsService, settingsPath, settingsIntf,
+                           "TimeSyncMethod", method);
+        auto complete = runUntil(
+            bus,
+            [&]() {
+                const auto& last = trace.transitions().back();
+                return last.mode == mode && last.complete;
+            },
+            maxSwitch);
+        if (!complete)
+        {
+            std::fprintf(stderr, "Switch %zu to %s did not complete\n", i,
+                         method.c_str());
+            return EXIT_FAILURE;
+        }
+
+        const auto& last = trace.transitions().back();
+        auto prefix = ntp ? "ntp " : "manual ";
+        for (size_t s = 0; s < ModeTrace::stageCount; ++s)
+        {
+            auto stage = static_cast<ModeTrace::Stage>(s);
+            auto duration = last.duration(stage);
+            if (duration && stage != ModeTrace::Stage::Signal)
+            {
+                stages[prefix + std::string(ModeTrace::toString(stage))]
+                    .emplace_back(*duration);
+            }
+        }
+        stages[prefix + std::string("total")].emplace_back(last.total());
+
+        const auto& signal =
+            last.at[static_cast<size_t>(ModeTrace::Stage::Signal)];
+        const auto& timedate =
+            last.at[static_cast<size_t>(ModeTrace::Stage::TimedateNtp)];
+        toTimedate.emplace_back(*timedate - *signal);
+    }
+
+    std::printf("%zu switches, sync delay %lldms, stage durations since the "
+                "previous stage:\n",
+                switches, static_cast<long long>(syncDelay.count()));
+    for (auto& [name, samples] : stages)
+    {
+        print(name, summarize(samples));
+    }
+    auto summary = summarize(toTimedate);
+    print("signal to timedate-ntp", summary);
+
+    if (summary.p99 > maxToTimedateP99)
+    {
+        std::fprintf(stderr, "Missed the target: p99 above %lldms\n",
+                     static_cast<long long>(maxToTimedateP99.count()));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
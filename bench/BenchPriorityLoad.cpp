@@ -0,0 +1,262 @@
+#include "bench.hpp"
+#include "harness.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+/* Switch the time mode while the daemon is flooded with Elapsed Gets.
+ *
+ * Usage: BenchPriorityLoad <phosphor-time-manager> [switches] [readers]
+ *
+ * TimeSyncMethod is flipped between NTP and Manual on the stand-in
+ * settings, default 100 times, and each switch is timed from the Set of the
+ * setting to the SetNTP the daemon calls on the stand-in timedated. The
+ * switches run once on an idle daemon and once while reader threads,
+ * default 8, each keep 16 Gets of Elapsed in flight on their own
+ * connection. The reads are in the low scheduling class and the settings
+ * signal in the high one, so the load costs a switch at most the dispatch
+ * in progress and the SetNTP round trip.
+ *
+ * The run fails if a target is missed:
+ * - every switch reaches SetNTP within 5 seconds
+ * - under load a switch takes at most 20ms at p99
+ * - every Get is answered, at most 1s late at p99
+ */
+
+using namespace phosphor::time;
+using namespace phosphor::time::bench;
+using namespace std::chrono;
+
+namespace
+{
+constexpr auto daemonBusName = "xyz.openbmc_project.Time.Manager";
+constexpr auto epochPath = "/xyz/openbmc_project/time/bmc";
+constexpr auto epochIntf = "xyz.openbmc_project.Time.EpochTime";
+constexpr auto settingsService = "xyz.openbmc_project.Settings";
+constexpr auto settingsPath = "/xyz/openbmc_project/time/sync_method";
+constexpr auto settingsIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto propertiesIntf = "org.freedesktop.DBus.Properties";
+constexpr auto ntpSync = "xyz.openbmc_project.Time.Synchronization.Method.NTP";
+constexpr auto manualSync =
+    "xyz.openbmc_project.Time.Synchronization.Method.Manual";
+
+constexpr size_t window = 16;
+constexpr auto maxSwitch = seconds(5);
+constexpr auto maxSwitchP99 = milliseconds(20);
+constexpr auto maxGetP99 = seconds(1);
+
+/** @brief A connection keeping a window of Gets in flight */
+struct Reader
+{
+    sdbusplus::bus_t conn;
+    std::vector<nanoseconds> latencies;
+    size_t inFlight = 0;
+    size_t failed = 0;
+};
+
+struct Pending
+{
+    Reader* reader;
+    steady_clock::time_point start;
+};
+
+int onReply(sd_bus_message* m, void* userdata, sd_bus_error* /* err */)
+{
+    std::unique_ptr<Pending> pending(static_cast<Pending*>(userdata));
+    auto& reader = *pending->reader;
+    reader.latencies.emplace_back(steady_clock::now() - pending->start);
+    reader.failed += sd_bus_message_is_method_error(m, nullptr) ? 1 : 0;
+    --reader.inFlight;
+    return 0;
+}
+
+void sendGet(Reader& reader)
+{
+    auto m = reader.conn.new_method_call(daemonBusName, epochPath,
+                                         propertiesIntf, "Get");
+    m.append(epochIntf, "Elapsed");
+    auto* pending = new Pending{&reader, steady_clock::now()};
+    if (sd_bus_call_async(reader.conn.get(), nullptr, m.get(), onReply,
+                          pending, 0) < 0)
+    {
+        delete pending;
+        ++reader.failed;
+        return;
+    }
+    ++reader.inFlight;
+}
+
+void readUntil(Reader& reader, const std::atomic<bool>& stop)
+{
+    auto* conn = reader.conn.get();
+    while (!stop)
+    {
+        while (reader.inFlight < window)
+        {
+            sendGet(reader);
+        }
+        while (sd_bus_process(conn, nullptr) > 0)
+        {}
+        sd_bus_wait(conn, 1000);
+    }
+
+    // Every Get is answered, the late ones time out on the client
+    while (reader.inFlight > 0)
+    {
+        while (sd_bus_process(conn, nullptr) > 0)
+        {}
+        sd_bus_wait(conn, 1000);
+    }
+}
+
+/** @brief The SetNTP calls seen by the stand-in timedated */
+class SetNtpSeen
+{
+  public:
+    void onSetNtp(bool value)
+    {
+        std::lock_guard guard(lock);
+        seen = {value, steady_clock::now()};
+        changed.notify_all();
+    }
+
+    /** @brief Wait for a SetNTP with the value, return when it is seen */
+    std::optional<steady_clock::time_point> wait(bool value)
+    {
+        std::unique_lock guard(lock);
+        if (!changed.wait_for(guard, maxSwitch, [&]() {
+                return seen && seen->first == value;
+            }))
+        {
+            return std::nullopt;
+        }
+        auto at = seen->second;
+        seen.reset();
+        return at;
+    }
+
+  private:
+    std::mutex lock;
+    std::condition_variable changed;
+    std::optional<std::pair<bool, steady_clock::time_point>> seen;
+};
+
+/** @brief Flip the mode, return the time until SetNTP or nothing */
+std::optional<std::vector<nanoseconds>> switches(sdbusplus::bus_t& bus,
+                                                 SetNtpSeen& seen, size_t n)
+{
+    std::vector<nanoseconds> samples;
+    bool ntp = false;
+    for (size_t i = 0; i < n; ++i)
+    {
+        ntp = !ntp;
+        auto start = steady_clock::now();
+        auto m = bus.new_method_call(settingsService, settingsPath,
+                                     propertiesIntf, "Set");
+        m.append(settingsIntf, "TimeSyncMethod",
+                 std::variant<std::string>(ntp ? ntpSync : manualSync));
+        bus.call(m);
+        auto at = seen.wait(ntp);
+        if (!at)
+        {
+            std::fprintf(stderr, "Switch %zu did not reach SetNTP\n", i);
+            return std::nullopt;
+        }
+        samples.emplace_back(*at - start);
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    return samples;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s <phosphor-time-manager> [switches] "
+                     "[readers]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t count = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 100;
+    size_t readers = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 8;
+
+    PrivateBus privateBus;
+    privateBus.exportEnvironment();
+    StandinPeers peers(privateBus.address());
+    peers.setTimeSyncMethod(manualSync);
+    SetNtpSeen seen;
+    peers.onSetNtp = [&seen](bool value) { seen.onSetNtp(value); };
+    auto bus = connect(privateBus.address());
+    DaemonProcess daemon(argv[1], bus);
+
+    auto idle = switches(bus, seen, count);
+    if (!idle)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::atomic<bool> stop = false;
+    auto start = steady_clock::now();
+    std::vector<std::unique_ptr<Reader>> flood;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < readers; ++t)
+    {
+        flood.emplace_back(
+            std::make_unique<Reader>(connect(privateBus.address())));
+        threads.emplace_back(
+            [&stop, &reader = *flood.back()]() { readUntil(reader, stop); });
+    }
+
+    // Let the readers fill their windows
+    std::this_thread::sleep_for(milliseconds(200));
+    auto loaded = switches(bus, seen, count);
+    auto length = duration<double>(steady_clock::now() - start).count();
+    stop = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    if (!loaded)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<nanoseconds> gets;
+    size_t failed = 0;
+    for (const auto& reader : flood)
+    {
+        gets.insert(gets.end(), reader->latencies.begin(),
+                    reader->latencies.end());
+        failed += reader->failed;
+    }
+
+    std::printf("%zu switches, %zu readers with %zu Gets in flight each, "
+                "%.0f Gets/s\n",
+                count, readers, window, gets.size() / length);
+    print("switch idle", summarize(*idle));
+    auto switchSummary = summarize(*loaded);
+    print("switch under reads", switchSummary);
+    auto getSummary = summarize(gets);
+    print("Elapsed Get under switches", getSummary);
+
+    bool ok = true;
+    auto target = [&](bool met, const char* what) {
+        std::printf("%-48s %s\n", what, met ? "met" : "MISSED");
+        ok = ok && met;
+    };
+    target(switchSummary.p99 <= maxSwitchP99,
+           "target: switch under reads p99 <= 20ms");
+    target(failed == 0 && getSummary.p99 <= maxGetP99,
+           "target: every Get answered, p99 <= 1s");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
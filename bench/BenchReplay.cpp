@@ -0,0 +1,247 @@
+#include "bench.hpp"
+#include "harness.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <variant>
+
+/* Replay recorded D-Bus traffic against the daemon on a private bus.
+ *
+ * Usage: BenchReplay <phosphor-time-manager> <trace> [speed]
+ *
+ * The trace is either a capture of `busctl capture` (.pcap or .pcapng) or
+ * the text format described in trace.hpp. The events are replayed with
+ * their recorded timing divided by speed, default 1, or back to back with
+ * a speed of 0. The daemon talks to stand-ins of timedated, the settings
+ * manager and the mapper.
+ *
+ * Gets and Sets are timed until their reply. A signal has no reply, so it
+ * is followed by a Peer.Ping to the daemon and timed until the pong, which
+ * the daemon can only send once it has handled the signal.
+ */
+
+using namespace phosphor::time;
+using namespace phosphor::time::bench;
+using namespace std::chrono;
+
+namespace
+{
+constexpr auto daemonBusName = "xyz.openbmc_project.Time.Manager";
+constexpr auto epochPath = "/xyz/openbmc_project/time/bmc";
+constexpr auto epochIntf = "xyz.openbmc_project.Time.EpochTime";
+constexpr auto settingsPath = "/xyz/openbmc_project/time/sync_method";
+constexpr auto settingsIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto timedatePath = "/org/freedesktop/timedate1";
+constexpr auto timedateIntf = "org.freedesktop.timedate1";
+constexpr auto propertiesIntf = "org.freedesktop.DBus.Properties";
+
+/** @brief The state of the replay */
+struct Replay
+{
+    sdbusplus::bus_t& bus;
+    StandinPeers& peers;
+    std::map<Event::Kind, std::vector<nanoseconds>> latencies;
+    size_t pending = 0;
+    size_t errors = 0;
+};
+
+/** @brief An outstanding call */
+struct Call
+{
+    Replay* replay;
+    Event::Kind kind;
+    steady_clock::time_point start;
+};
+
+int onReply(sd_bus_message* m, void* userdata, sd_bus_error* /* err */)
+{
+    auto* call = static_cast<Call*>(userdata);
+    auto* replay = call->replay;
+    if (sd_bus_message_is_method_error(m, nullptr))
+    {
+        ++replay->errors;
+    }
+    replay->latencies[call->kind].emplace_back(steady_clock::now() -
+                                               call->start);
+    --replay->pending;
+    delete call;
+    return 0;
+}
+
+void callAsync(Replay& replay, sdbusplus::message_t& m, Event::Kind kind)
+{
+    auto* call = new Call{&replay, kind, steady_clock::now()};
+    auto r = sd_bus_call_async(replay.bus.get(), nullptr, m.get(), onReply,
+                               call, 0);
+    if (r < 0)
+    {
+        ++replay.errors;
+        delete call;
+        return;
+    }
+    ++replay.pending;
+}
+
+void issue(Replay& replay, const Event& event)
+{
+    auto& bus = replay.bus;
+    switch (event.kind)
+    {
+        case Event::Kind::Get:
+        {
+            auto m = bus.new_method_call(daemonBusName, epochPath,
+                                         propertiesIntf, "Get");
+            m.append(epochIntf, "Elapsed");
+            callAsync(replay, m, event.kind);
+            return;
+        }
+        case Event::Kind::Set:
+        {
+            auto m = bus.new_method_call(daemonBusName, epochPath,
+                                         propertiesIntf, "Set");
+            m.append(epochIntf, "Elapsed", std::variant<uint64_t>(event.value));
+            callAsync(replay, m, event.kind);
+            return;
+        }
+        case Event::Kind::Settings:
+        case Event::Kind::Ntp:
+        {
+            bool settings = (event.kind == Event::Kind::Settings);
+            auto s = bus.new_signal(settings ? settingsPath : timedatePath,
+                                    propertiesIntf, "PropertiesChanged");
+            if (settings)
+            {
+                replay.peers.setTimeSyncMethod(event.text);
+                s.append(settingsIntf,
+                         std::map<std::string, std::variant<std::string>>{
+                             {"TimeSyncMethod", event.text}},
+                         std::vector<std::string>{});
+            }
+            else
+            {
+                replay.peers.setNtp(event.value != 0);
+                s.append(timedateIntf,
+                         std::map<std::string, std::variant<bool>>{
+                             {"NTP", event.value != 0}},
+                         std::vector<std::string>{});
+            }
+            sd_bus_send(bus.get(), s.get(), nullptr);
+
+            auto ping = bus.new_method_call(daemonBusName, epochPath,
+                                            "org.freedesktop.DBus.Peer",
+                                            "Ping");
+            callAsync(replay, ping, event.kind);
+            return;
+        }
+    }
+}
+
+/** @brief Get the time of an event since the start of the replay */
+nanoseconds scaled(const Event& event, double speed)
+{
+    if (speed <= 0)
+    {
+        return {};
+    }
+    return duration_cast<nanoseconds>(event.offset / speed);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s <phosphor-time-manager> <trace> [speed]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string trace = argv[2];
+    bool capture = trace.ends_with(".pcap") || trace.ends_with(".pcapng");
+    auto events = capture ? parsePcap(trace) : parseText(trace);
+    if (!events || events->empty())
+    {
+        std::fprintf(stderr, "No events in %s\n", trace.c_str());
+        return EXIT_FAILURE;
+    }
+    double speed = (argc > 3) ? std::strtod(argv[3], nullptr) : 1.0;
+
+    PrivateBus privateBus;
+    privateBus.exportEnvironment();
+    StandinPeers peers(privateBus.address());
+    auto bus = connect(privateBus.address());
+    DaemonProcess daemon(argv[1], bus);
+
+    Replay replay{bus, peers, {}, 0, 0};
+    auto cpuStart = daemon.cpuTime();
+    auto start = steady_clock::now();
+
+    size_t next = 0;
+    while (next < events->size() || replay.pending > 0)
+    {
+        auto now = steady_clock::now();
+        while (next < events->size())
+        {
+            if (start + scaled((*events)[next], speed) > now)
+            {
+                break;
+            }
+            issue(replay, (*events)[next]);
+            ++next;
+        }
+
+        auto r = sd_bus_process(bus.get(), nullptr);
+        if (r < 0)
+        {
+            std::fprintf(stderr, "Bus failed: %s\n", std::strerror(-r));
+            return EXIT_FAILURE;
+        }
+        if (r > 0)
+        {
+            continue;
+        }
+
+        uint64_t timeout = 100'000;
+        if (next < events->size() && speed > 0)
+        {
+            auto due = start + scaled((*events)[next], speed);
+            auto left = duration_cast<microseconds>(due - now).count();
+            timeout = std::clamp<int64_t>(left, 0, 100'000);
+        }
+        else if (next < events->size())
+        {
+            timeout = 0;
+        }
+        if (timeout > 0)
+        {
+            sd_bus_wait(bus.get(), timeout);
+        }
+    }
+
+    auto wall = steady_clock::now() - start;
+    auto cpu = daemon.cpuTime() - cpuStart;
+
+    // Errors are reported rather than failing the run, e.g. Sets rejected
+    // by the rate limit are part of replaying a misbehaving client.
+    std::printf("replayed %zu events in %.3fs, %zu errors\n", events->size(),
+                duration<double>(wall).count(), replay.errors);
+    for (auto& [kind, samples] : replay.latencies)
+    {
+        print(std::string("latency ") + toString(kind), summarize(samples));
+    }
+    std::printf("daemon cpu time %.3fms (%.1f%% of wall time), "
+                "SetTime %llu, SetNTP %llu, mapper %llu\n",
+                duration<double, std::milli>(cpu).count(),
+                100.0 * duration<double>(cpu).count() /
+                    duration<double>(wall).count(),
+                static_cast<unsigned long long>(peers.setTimeCalls.load()),
+                static_cast<unsigned long long>(peers.setNtpCalls.load()),
+                static_cast<unsigned long long>(peers.mapperCalls.load()));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+#include "bench.hpp"
+#include "harness.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+/* Flood the daemon with PropertiesChanged signals while Elapsed is read.
+ *
+ * Usage: BenchSignalStorm <phosphor-time-manager> [seconds] [signals/s]
+ *
+ * Emitter threads send the signals, default 20000 per second for 10
+ * seconds, from their own connections:
+ * - 40% timedated signals without NTP, e.g. TimeUSec and Timezone
+ * - 20% timedated NTP signals that agree with the mode
+ * - 20% settings TimeSyncMethod signals that agree with the mode
+ * - 20% signals of other interfaces, which the match rules keep from the
+ *   daemon
+ * Meanwhile one thread Gets Elapsed 100 times a second, and one samples the
+ * RSS of the daemon and the round trip of a Ping, which grows with the
+ * queue of the daemon. After the storm the time until a Ping returns is
+ * the backlog still queued.
+ *
+ * The run fails if a target is missed:
+ * - the handlers sustain the matched signal rate, i.e. the backlog drains
+ *   within a second
+ * - Elapsed Gets have a p99 latency of at most 20ms
+ * - the RSS of the daemon grows by at most 2MiB
+ */
+
+using namespace phosphor::time;
+using namespace phosphor::time::bench;
+using namespace std::chrono;
+
+namespace
+{
+constexpr auto daemonBusName = "xyz.openbmc_project.Time.Manager";
+constexpr auto epochPath = "/xyz/openbmc_project/time/bmc";
+constexpr auto epochIntf = "xyz.openbmc_project.Time.EpochTime";
+constexpr auto settingsPath = "/xyz/openbmc_project/time/sync_method";
+constexpr auto settingsIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto timedatePath = "/org/freedesktop/timedate1";
+constexpr auto timedateIntf = "org.freedesktop.timedate1";
+constexpr auto propertiesIntf = "org.freedesktop.DBus.Properties";
+constexpr auto manualSync =
+    "xyz.openbmc_project.Time.Synchronization.Method.Manual";
+
+constexpr size_t emitters = 4;
+constexpr auto maxDrain = seconds(1);
+constexpr auto maxGetP99 = milliseconds(20);
+constexpr uint64_t maxRssGrowthKb = 2048;
+
+uint64_t rssKb(pid_t pid)
+{
+    std::ifstream file("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.starts_with("VmRSS:"))
+        {
+            return std::stoull(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+/** @brief Send the i-th signal of the mix, return whether it is matched */
+bool emit(sd_bus* bus, uint64_t i)
+{
+    switch (i % 5)
+    {
+        case 0:
+            sd_bus_emit_signal(bus, timedatePath, propertiesIntf,
+                               "PropertiesChanged", "sa{sv}as", timedateIntf,
+                               1, "TimeUSec", "t", i, 0);
+            return true;
+        case 1:
+            sd_bus_emit_signal(bus, timedatePath, propertiesIntf,
+                               "PropertiesChanged", "sa{sv}as", timedateIntf,
+                               2, "Timezone", "s", "UTC", "LocalRTC", "b", 0,
+                               0);
+            return true;
+        case 2:
+            sd_bus_emit_signal(bus, timedatePath, propertiesIntf,
+                               "PropertiesChanged", "sa{sv}as", timedateIntf,
+                               1, "NTP", "b", 0, 0);
+            return true;
+        case 3:
+            sd_bus_emit_signal(bus, settingsPath, propertiesIntf,
+                               "PropertiesChanged", "sa{sv}as", settingsIntf,
+                               1, "TimeSyncMethod", "s", manualSync, 0);
+            return true;
+        default:
+            sd_bus_emit_signal(bus, settingsPath, propertiesIntf,
+                               "PropertiesChanged", "sa{sv}as",
+                               "xyz.openbmc_project.Object.Enable", 1,
+                               "Enabled", "b", 1, 0);
+            return false;
+    }
+}
+
+nanoseconds ping(sdbusplus::bus_t& bus)
+{
+    auto start = steady_clock::now();
+    auto m = bus.new_method_call(daemonBusName, epochPath,
+                                 "org.freedesktop.DBus.Peer", "Ping");
+    bus.call(m, duration_cast<microseconds>(seconds(60)).count());
+    return steady_clock::now() - start;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s <phosphor-time-manager> [seconds] "
+                     "[signals/s]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+    auto length = seconds((argc > 2) ? std::atoi(argv[2]) : 10);
+    uint64_t rate = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 20000;
+
+    PrivateBus privateBus;
+    privateBus.exportEnvironment();
+    StandinPeers peers(privateBus.address());
+    auto bus = connect(privateBus.address());
+    DaemonProcess daemon(argv[1], bus);
+
+    std::atomic<bool> stop = false;
+    std::atomic<uint64_t> sent = 0;
+    std::atomic<uint64_t> matched = 0;
+
+    // Emit in slices of a millisecond to keep the rate even
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < emitters; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            auto conn = connect(privateBus.address());
+            auto perSlice = std::max<uint64_t>(1, rate / emitters / 1000);
+            auto next = steady_clock::now();
+            uint64_t i = t;
+            while (!stop)
+            {
+                for (uint64_t n = 0; n < perSlice; ++n, i += emitters)
+                {
+                    matched += emit(conn.get(), i) ? 1 : 0;
+                    ++sent;
+                }
+                sd_bus_flush(conn.get());
+                next += milliseconds(1);
+                std::this_thread::sleep_until(next);
+            }
+            sd_bus_flush(conn.get());
+        });
+    }
+
+    std::vector<nanoseconds> gets;
+    threads.emplace_back([&]() {
+        auto conn = connect(privateBus.address());
+        while (!stop)
+        {
+            auto start = steady_clock::now();
+            auto m = conn.new_method_call(daemonBusName, epochPath,
+                                          propertiesIntf, "Get");
+            m.append(epochIntf, "Elapsed");
+            conn.call(m);
+            gets.emplace_back(steady_clock::now() - start);
+            std::this_thread::sleep_until(start + milliseconds(10));
+        }
+    });
+
+    auto rssStart = rssKb(daemon.getPid());
+    uint64_t rssMax = rssStart;
+    std::vector<nanoseconds> pings;
+    auto start = steady_clock::now();
+    while (steady_clock::now() - start < length)
+    {
+        pings.emplace_back(ping(bus));
+        rssMax = std::max(rssMax, rssKb(daemon.getPid()));
+        std::this_thread::sleep_for(milliseconds(100));
+    }
+    stop = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    auto stormEnd = steady_clock::now();
+    auto drain = ping(bus);
+    rssMax = std::max(rssMax, rssKb(daemon.getPid()));
+
+    auto storm = duration<double>(stormEnd - start).count();
+    auto handled = duration<double>(stormEnd - start + drain).count();
+    auto getSummary = summarize(gets);
+    auto rssGrowth = rssMax - std::min(rssMax, rssStart);
+
+    std::printf("sent %llu signals in %.3fs, %.0f/s, %llu matched\n",
+                static_cast<unsigned long long>(sent.load()), storm,
+                sent.load() / storm,
+                static_cast<unsigned long long>(matched.load()));
+    std::printf("handler throughput %.0f signals/s, backlog drained in "
+                "%.3fms\n",
+                matched.load() / handled,
+                duration<double, std::milli>(drain).count());
+    print("Elapsed Get", getSummary);
+    print("Ping round trip", summarize(pings));
+    std::printf("daemon RSS %llukB, grew by %llukB\n",
+                static_cast<unsigned long long>(rssMax),
+                static_cast<unsigned long long>(rssGrowth));
+
+    bool ok = true;
+    auto target = [&](bool met, const char* what) {
+        std::printf("%-48s %s\n", what, met ? "met" : "MISSED");
+        ok = ok && met;
+    };
+    target(drain <= maxDrain, "target: backlog drains within 1s");
+    target(getSummary.p99 <= maxGetP99, "target: Elapsed Get p99 <= 20ms");
+    target(rssGrowth <= maxRssGrowthKb, "target: RSS growth <= 2MiB");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
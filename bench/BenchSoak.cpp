@@ -0,0 +1,138 @@
+#include "bench.hpp"
+#include "bmc_epoch.hpp"
+#include "clock.hpp"
+#include "harness.hpp"
+#include "manager.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <ctime>
+
+/* Soak the time manager on a simulated clock.
+ *
+ * Usage: BenchSoak [days]
+ *
+ * The Manager and BmcEpoch run in process on a private bus with the
+ * stand-in peers and a SimulatedClock, so days of drift, mode flips and
+ * clock jumps pass in seconds:
+ * - the clock drifts by 15ppm and advances a simulated minute at a time
+ * - every hour the TimeSyncMethod setting flips between NTP and Manual
+ * - every 6 hours the clock jumps by a few seconds, every 12 hours it is
+ *   set through Elapsed
+ * After every step the mode, the SetNTP calls seen by timedated and the
+ * DateTime property are checked against the expected values, and the run
+ * fails on the first mismatch.
+ */
+
+using namespace phosphor::time;
+using namespace phosphor::time::bench;
+using namespace std::chrono;
+
+namespace
+{
+constexpr auto settingsService = "xyz.openbmc_project.Settings";
+constexpr auto settingsPath = "/xyz/openbmc_project/time/sync_method";
+constexpr auto settingsIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto ntpSync = "xyz.openbmc_project.Time.Synchronization.Method.NTP";
+constexpr auto manualSync =
+    "xyz.openbmc_project.Time.Synchronization.Method.Manual";
+
+std::string render(microseconds usec)
+{
+    time_t t = duration_cast<seconds>(usec).count();
+    tm tm{};
+    gmtime_r(&t, &tm);
+    std::array<char, 32> buf{};
+    strftime(buf.data(), buf.size(), "%Y-%m-%dT%H:%M:%S+00:00", &tm);
+    return buf.data();
+}
+
+bool check(bool ok, const char* what, minutes at)
+{
+    if (!ok)
+    {
+        std::fprintf(stderr, "%s at simulated minute %lld\n", what,
+                     static_cast<long long>(at.count()));
+    }
+    return ok;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int days = (argc > 1) ? std::atoi(argv[1]) : 7;
+
+    PrivateBus privateBus;
+    StandinPeers peers(privateBus.address());
+    auto bus = connect(privateBus.address());
+
+    SimulatedClock clock;
+    clock.setDrift(15);
+    Manager manager(bus, clock);
+    BmcEpoch bmcEpoch(bus, objpathBmc, manager, clock);
+
+    std::vector<nanoseconds> flips;
+    uint64_t jumps = 0;
+    bool ntp = (Mode::NTP == manager.getTimeMode());
+    auto start = steady_clock::now();
+
+    for (minutes m{1}; m <= hours(24 * days); ++m)
+    {
+        clock.advance(minutes(1));
+
+        if (m % hours(1) == minutes(0))
+        {
+            ntp = !ntp;
+            auto calls = peers.setNtpCalls.load() + 1;
+            auto flipStart = steady_clock::now();
+            std::string method = ntp ? ntpSync : manualSync;
+            utils::setProperty(bus, settingsService, settingsPath,
+                               settingsIntf, "TimeSyncMethod", method);
+            auto synced = runUntil(
+                bus,
+                [&]() {
+                    return peers.setNtpCalls.load() == calls &&
+                           (Mode::NTP == manager.getTimeMode()) == ntp;
+                },
+                seconds(5));
+            flips.emplace_back(steady_clock::now() - flipStart);
+            if (!check(synced, "Mode flip not synced", m))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (m % hours(12) == minutes(0))
+        {
+            auto to = clock.now() + seconds(90);
+            bmcEpoch.elapsed(duration_cast<microseconds>(to).count());
+            ++jumps;
+        }
+        else if (m % hours(6) == minutes(0))
+        {
+            clock.jump(seconds(-3));
+            ++jumps;
+        }
+
+        if (!check(bmcEpoch.dateTime() == render(clock.now()),
+                   "Stale DateTime", m) ||
+            !check(bmcEpoch.elapsed() ==
+                       static_cast<uint64_t>(clock.now().count()),
+                   "Wrong Elapsed", m))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto wall = duration<double>(steady_clock::now() - start).count();
+    std::printf("simulated %d days in %.3fs (%.0fx), %zu mode flips, "
+                "%llu jumps, %llu steps\n",
+                days, wall, days * 86400.0 / wall, flips.size(),
+                static_cast<unsigned long long>(jumps),
+                static_cast<unsigned long long>(clock.steps()));
+    print("mode flip synced", summarize(flips));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace time
+{
+namespace bench
+{
+
+/** @brief The summary of a series of timed samples */
+struct Summary
+{
+    size_t count = 0;
+    std::chrono::nanoseconds mean{};
+    std::chrono::nanoseconds p50{};
+    std::chrono::nanoseconds p90{};
+    std::chrono::nanoseconds p99{};
+    std::chrono::nanoseconds max{};
+};
+
+/** @brief Summarize the samples, which are sorted in place
+ *
+ * @param[in] samples - The measured durations
+ *
+ * @return The mean and the percentiles of the samples
+ */
+inline Summary summarize(std::vector<std::chrono::nanoseconds>& samples)
+{
+    Summary s;
+    if (samples.empty())
+    {
+        return s;
+    }
+
+    std::ranges::sort(samples);
+    std::chrono::nanoseconds total{};
+    for (const auto& d : samples)
+    {
+        total += d;
+    }
+
+    auto at = [&](double q) {
+        auto i = static_cast<size_t>(q * static_cast<double>(samples.size()));
+        return samples[std::min(i, samples.size() - 1)];
+    };
+
+    s.count = samples.size();
+    s.mean = total / static_cast<long>(samples.size());
+    s.p50 = at(0.50);
+    s.p90 = at(0.90);
+    s.p99 = at(0.99);
+    s.max = samples.back();
+    return s;
+}
+
+/** @brief Print a summary as one line, in microseconds
+ *
+ * @param[in] name - The name of the measurement
+ * @param[in] s    - The summary to print
+ */
+inline void print(const std::string& name, const Summary& s)
+{
+    auto us = [](std::chrono::nanoseconds d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    };
+    std::printf("%-32s n=%-8zu mean=%10.3fus p50=%10.3fus p90=%10.3fus "
+                "p99=%10.3fus max=%10.3fus\n",
+                name.c_str(), s.count, us(s.mean), us(s.p50), us(s.p90),
+                us(s.p99), us(s.max));
+}
+
+/** @brief Time every call of fn and print the summary
+ *
+ * @param[in] name       - The name of the measurement
+ * @param[in] iterations - The number of calls
+ * @param[in] fn         - The operation to measure
+ *
+ * @return The summary of the calls
+ */
+inline Summary measure(const std::string& name, size_t iterations,
+                       const std::function<void()>& fn)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::chrono::nanoseconds> samples;
+    samples.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        auto start = clock::now();
+        fn();
+        samples.emplace_back(clock::now() - start);
+    }
+
+    auto s = summarize(samples);
+    print(name, s);
+    return s;
+}
+
+} // namespace bench
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,447 @@
+#include "harness.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <sdbusplus/vtable.hpp>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace phosphor
+{
+namespace time
+{
+namespace bench
+{
+
+using namespace std::chrono;
+
+namespace // anonymous
+{
+constexpr auto timedateService = "org.freedesktop.timedate1";
+constexpr auto timedatePath = "/org/freedesktop/timedate1";
+constexpr auto timedateIntf = "org.freedesktop.timedate1";
+constexpr auto settingsService = "xyz.openbmc_project.Settings";
+constexpr auto settingsPath = "/xyz/openbmc_project/time/sync_method";
+constexpr auto settingsIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto mapperService = "xyz.openbmc_project.ObjectMapper";
+constexpr auto mapperPath = "/xyz/openbmc_project/object_mapper";
+constexpr auto mapperIntf = "xyz.openbmc_project.ObjectMapper";
+constexpr auto daemonBusName = "xyz.openbmc_project.Time.Manager";
+constexpr auto manualSync =
+    "xyz.openbmc_project.Time.Synchronization.Method.Manual";
+constexpr auto emitsChange = SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE;
+
+bool hasOwner(sdbusplus::bus_t& bus, const char* name)
+{
+    auto m = bus.new_method_call("org.freedesktop.DBus",
+                                 "/org/freedesktop/DBus",
+                                 "org.freedesktop.DBus", "NameHasOwner");
+    m.append(name);
+    bool owned = false;
+    bus.call(m).read(owned);
+    return owned;
+}
+} // namespace
+
+PrivateBus::PrivateBus()
+{
+    std::array<int, 2> fds{};
+    if (pipe2(fds.data(), O_CLOEXEC) != 0)
+    {
+        throw std::runtime_error("Failed to create pipe");
+    }
+
+    pid = fork();
+    if (pid == 0)
+    {
+        dup2(fds[1], 3);
+        fcntl(3, F_SETFD, 0);
+        execlp("dbus-daemon", "dbus-daemon", "--session", "--nofork",
+               "--nopidfile", "--print-address=3", nullptr);
+        _exit(127);
+    }
+    close(fds[1]);
+
+    char c = 0;
+    while (read(fds[0], &c, 1) == 1 && c != '\n')
+    {
+        busAddress.push_back(c);
+    }
+    close(fds[0]);
+
+    if (pid < 0 || busAddress.empty())
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+        throw std::runtime_error("Failed to start dbus-daemon");
+    }
+}
+
+PrivateBus::~PrivateBus()
+{
+    if (pid > 0)
+    {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+void PrivateBus::exportEnvironment() const
+{
+    setenv("DBUS_STARTER_BUS_TYPE", "system", 1);
+    setenv("DBUS_SYSTEM_BUS_ADDRESS", busAddress.c_str(), 1);
+    setenv("DBUS_SESSION_BUS_ADDRESS", busAddress.c_str(), 1);
+}
+
+sdbusplus::bus_t connect(const std::string& address)
+{
+    sd_bus* b = nullptr;
+    if (sd_bus_new(&b) < 0)
+    {
+        throw std::runtime_error("Failed to create bus");
+    }
+    sd_bus_set_address(b, address.c_str());
+    sd_bus_set_bus_client(b, 1);
+    if (sd_bus_start(b) < 0)
+    {
+        sd_bus_unref(b);
+        throw std::runtime_error("Failed to connect to " + address);
+    }
+
+    sdbusplus::bus_t bus(b);
+    sd_bus_unref(b);
+    return bus;
+}
+
+DaemonProcess::DaemonProcess(const std::string& path, sdbusplus::bus_t& bus,
+                             seconds timeout)
+{
+    pid = fork();
+    if (pid == 0)
+    {
+        execl(path.c_str(), path.c_str(), nullptr);
+        _exit(127);
+    }
+    if (pid < 0)
+    {
+        throw std::runtime_error("Failed to fork");
+    }
+
+    auto deadline = steady_clock::now() + timeout;
+    while (!hasOwner(bus, daemonBusName))
+    {
+        if (steady_clock::now() > deadline ||
+            waitpid(pid, nullptr, WNOHANG) == pid)
+        {
+            throw std::runtime_error("The daemon did not come up");
+        }
+        usleep(10000);
+    }
+}
+
+DaemonProcess::~DaemonProcess()
+{
+    if (pid > 0)
+    {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+nanoseconds DaemonProcess::cpuTime() const
+{
+    std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+
+    // The fields after the command name, which may contain spaces; utime
+    // and stime are the 14th and 15th fields of the line.
+    auto pos = stat.rfind(')');
+    if (pos == std::string::npos)
+    {
+        return {};
+    }
+    std::istringstream fields(stat.substr(pos + 2));
+    std::string field;
+    uint64_t utime = 0;
+    uint64_t stime = 0;
+    for (int i = 3; i <= 15 && fields >> field; ++i)
+    {
+        if (i == 14)
+        {
+            utime = std::stoull(field);
+        }
+        else if (i == 15)
+        {
+            stime = std::stoull(field);
+        }
+    }
+
+    auto ticks = sysconf(_SC_CLK_TCK);
+    return nanoseconds((utime + stime) * 1'000'000'000 / ticks);
+}
+
+StandinPeers::StandinPeers(const std::string& address) :
+    bus(connect(address)), timeSyncMethod(manualSync)
+{
+    static const sd_bus_vtable timedateVtable[] = {
+        sdbusplus::vtable::start(),
+        sdbusplus::vtable::method("SetTime", "xbb", "", setTime),
+        sdbusplus::vtable::method("SetNTP", "bb", "", setNtpMethod),
+        sdbusplus::vtable::property("NTP", "b", getNtp, emitsChange),
+        sdbusplus::vtable::property("NTPSynchronized", "b", getNtp,
+                                    emitsChange),
+        sdbusplus::vtable::end(),
+    };
+    static const sd_bus_vtable settingsVtable[] = {
+        sdbusplus::vtable::start(),
+        sdbusplus::vtable::property("TimeSyncMethod", "s", getTimeSyncMethod,
+                                    setTimeSyncMethodProperty, emitsChange),
+        sdbusplus::vtable::end(),
+    };
+    static const sd_bus_vtable mapperVtable[] = {
+        sdbusplus::vtable::start(),
+        sdbusplus::vtable::method("GetObject", "sas", "a{sas}", getObject),
+        sdbusplus::vtable::method("GetSubTree", "sias", "a{sa{sas}}",
+                                  getSubTree),
+        sdbusplus::vtable::end(),
+    };
+
+    auto* b = bus.get();
+    sd_bus_add_object_vtable(b, &timedateSlot, timedatePath, timedateIntf,
+                             timedateVtable, this);
+    sd_bus_add_object_vtable(b, &settingsSlot, settingsPath, settingsIntf,
+                             settingsVtable, this);
+    sd_bus_add_object_vtable(b, &mapperSlot, mapperPath, mapperIntf,
+                             mapperVtable, this);
+
+    for (const auto* name : {timedateService, settingsService, mapperService})
+    {
+        if (sd_bus_request_name(b, name, 0) < 0)
+        {
+            throw std::runtime_error(std::string("Failed to own ") + name);
+        }
+    }
+
+    thread = std::thread([this]() { run(); });
+}
+
+StandinPeers::~StandinPeers()
+{
+    stop = true;
+    thread.join();
+    sd_bus_slot_unref(timedateSlot);
+    sd_bus_slot_unref(settingsSlot);
+    sd_bus_slot_unref(mapperSlot);
+}
+
+void StandinPeers::setTimeSyncMethod(const std::string& method)
+{
+    std::lock_guard guard(lock);
+    timeSyncMethod = method;
+}
+
+void StandinPeers::setNtp(bool value)
+{
+    std::lock_guard guard(lock);
+    ntp = value;
+}
+
+void StandinPeers::setSyncDelay(milliseconds delay)
+{
+    std::lock_guard guard(lock);
+    syncDelay = delay;
+}
+
+void StandinPeers::run()
+{
+    while (!stop)
+    {
+        synchronize();
+        auto r = sd_bus_process(bus.get(), nullptr);
+        if (r < 0)
+        {
+            break;
+        }
+        if (r == 0)
+        {
+            sd_bus_wait(bus.get(), syncAt ? 1'000 : 50'000);
+        }
+    }
+}
+
+void StandinPeers::synchronize()
+{
+    {
+        std::lock_guard guard(lock);
+        if (!syncAt || steady_clock::now() < *syncAt)
+        {
+            return;
+        }
+        syncAt.reset();
+        ntpSynchronized = true;
+    }
+    sd_bus_emit_properties_changed(bus.get(), timedatePath, timedateIntf,
+                                   "NTPSynchronized", nullptr);
+}
+
+int StandinPeers::setTime(sd_bus_message* m, void* userdata,
+                          sd_bus_error* /* err */)
+{
+    auto* self = static_cast<StandinPeers*>(userdata);
+    int64_t usec = 0;
+    int relative = 0;
+    int interactive = 0;
+    sd_bus_message_read(m, "xbb", &usec, &relative, &interactive);
+    ++self->setTimeCalls;
+    return sd_bus_reply_method_return(m, "");
+}
+
+int StandinPeers::setNtpMethod(sd_bus_message* m, void* userdata,
+                               sd_bus_error* /* err */)
+{
+    auto* self = static_cast<StandinPeers*>(userdata);
+    int value = 0;
+    int interactive = 0;
+    sd_bus_message_read(m, "bb", &value, &interactive);
+    ++self->setNtpCalls;
+    bool lost = false;
+    {
+        std::lock_guard guard(self->lock);
+        self->ntp = value;
+        if (value && self->syncDelay && !self->syncAt)
+        {
+            self->syncAt = steady_clock::now() + *self->syncDelay;
+        }
+        else if (!value)
+        {
+            lost = self->ntpSynchronized;
+            self->ntpSynchronized = false;
+            self->syncAt.reset();
+        }
+    }
+
+    auto r = sd_bus_reply_method_return(m, "");
+    sd_bus_emit_properties_changed(sd_bus_message_get_bus(m), timedatePath,
+                                   timedateIntf, "NTP", nullptr);
+    if (lost)
+    {
+        sd_bus_emit_properties_changed(sd_bus_message_get_bus(m),
+                                       timedatePath, timedateIntf,
+                                       "NTPSynchronized", nullptr);
+    }
+    if (self->onSetNtp)
+    {
+        self->onSetNtp(value);
+    }
+    return r;
+}
+
+int StandinPeers::getNtp(sd_bus* /* bus */, const char* /* path */,
+                         const char* /* intf */, const char* property,
+                         sd_bus_message* reply, void* userdata,
+                         sd_bus_error* /* err */)
+{
+    auto* self = static_cast<StandinPeers*>(userdata);
+    std::lock_guard guard(self->lock);
+    int value = (std::string_view(property) == "NTP") ? self->ntp
+                                                      : self->ntpSynchronized;
+    return sd_bus_message_append(reply, "b", value);
+}
+
+int StandinPeers::getTimeSyncMethod(sd_bus* /* bus */, const char* /* path */,
+                                    const char* /* intf */,
+                                    const char* /* property */,
+                                    sd_bus_message* reply, void* userdata,
+                                    sd_bus_error* /* err */)
+{
+    auto* self = static_cast<StandinPeers*>(userdata);
+    std::lock_guard guard(self->lock);
+    return sd_bus_message_append(reply, "s", self->timeSyncMethod.c_str());
+}
+
+int StandinPeers::setTimeSyncMethodProperty(
+    sd_bus* bus, const char* /* path */, const char* /* intf */,
+    const char* /* property */, sd_bus_message* value, void* userdata,
+    sd_bus_error* /* err */)
+{
+    auto* self = static_cast<StandinPeers*>(userdata);
+    const char* method = nullptr;
+    auto r = sd_bus_message_read(value, "s", &method);
+    if (r < 0)
+    {
+        return r;
+    }
+    self->setTimeSyncMethod(method);
+    sd_bus_emit_properties_changed(bus, settingsPath, settingsIntf,
+                                   "TimeSyncMethod", nullptr);
+    return 0;
+}
+
+int StandinPeers::getObject(sd_bus_message* m, void* userdata,
+                            sd_bus_error* err)
+{
+    auto* self = static_cast<StandinPeers*>(userdata);
+    ++self->mapperCalls;
+
+    const char* path = nullptr;
+    sd_bus_message_read(m, "s", &path);
+    if (std::string_view(path) != settingsPath)
+    {
+        return sd_bus_error_set(
+            err, "xyz.openbmc_project.Common.Error.ResourceNotFound",
+            "The resource is not found");
+    }
+    return sd_bus_reply_method_return(m, "a{sas}", 1, settingsService, 1,
+                                      settingsIntf);
+}
+
+int StandinPeers::getSubTree(sd_bus_message* m, void* userdata,
+                             sd_bus_error* /* err */)
+{
+    auto* self = static_cast<StandinPeers*>(userdata);
+    ++self->mapperCalls;
+    return sd_bus_reply_method_return(m, "a{sa{sas}}", 1, settingsPath, 1,
+                                      settingsService, 1, settingsIntf);
+}
+
+bool runUntil(sdbusplus::bus_t& bus, const std::function<bool()>& condition,
+              milliseconds timeout)
+{
+    auto deadline = steady_clock::now() + timeout;
+    while (!condition())
+    {
+        auto now = steady_clock::now();
+        if (now > deadline)
+        {
+            return false;
+        }
+        auto r = sd_bus_process(bus.get(), nullptr);
+        if (r < 0)
+        {
+            return false;
+        }
+        if (r == 0)
+        {
+            auto left = duration_cast<microseconds>(deadline - now);
+            sd_bus_wait(bus.get(), std::min<uint64_t>(left.count(), 10'000));
+        }
+    }
+    return true;
+}
+
+} // namespace bench
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <sdbusplus/bus.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace phosphor
+{
+namespace time
+{
+namespace bench
+{
+
+/** @class PrivateBus
+ *  @brief A private dbus-daemon for the benchmarks.
+ *  @details The daemon under test, the stand-in peers and the load
+ *  generator all connect to it, so a benchmark never touches the system
+ *  bus or the real timedated.
+ */
+class PrivateBus
+{
+  public:
+    /** @brief Start a dbus-daemon with the session configuration
+     *
+     * @throw std::runtime_error when it fails to start
+     */
+    PrivateBus();
+    ~PrivateBus();
+
+    PrivateBus(const PrivateBus&) = delete;
+    PrivateBus(PrivateBus&&) = delete;
+    PrivateBus& operator=(const PrivateBus&) = delete;
+    PrivateBus& operator=(PrivateBus&&) = delete;
+
+    /** @brief Get the address of the bus */
+    const std::string& address() const
+    {
+        return busAddress;
+    }
+
+    /** @brief Make the bus the default system bus of this process and of
+     *         the processes it spawns */
+    void exportEnvironment() const;
+
+  private:
+    pid_t pid = -1;
+    std::string busAddress;
+};
+
+/** @brief Open a new connection to the bus at the address
+ *
+ * @param[in] address - The address of the bus
+ *
+ * @return The connection
+ *
+ * @throw std::runtime_error when it fails to connect
+ */
+sdbusplus::bus_t connect(const std::string& address);
+
+/** @class DaemonProcess
+ *  @brief The phosphor-time-manager daemon under test.
+ */
+class DaemonProcess
+{
+  public:
+    /** @brief Spawn the daemon and wait until it owns its bus name
+     *
+     * @param[in] path    - The path of the executable
+     * @param[in] bus     - A connection to the bus the daemon uses
+     * @param[in] timeout - How long to wait for the bus name
+     *
+     * @throw std::runtime_error when it does not come up in time
+     */
+    DaemonProcess(const std::string& path, sdbusplus::bus_t& bus,
+                  std::chrono::seconds timeout = std::chrono::seconds(10));
+    ~DaemonProcess();
+
+    DaemonProcess(const DaemonProcess&) = delete;
+    DaemonProcess(DaemonProcess&&) = delete;
+    DaemonProcess& operator=(const DaemonProcess&) = delete;
+    DaemonProcess& operator=(DaemonProcess&&) = delete;
+
+    /** @brief Get the user and system CPU time used by the daemon */
+    std::chrono::nanoseconds cpuTime() const;
+
+    /** @brief Get the pid of the daemon */
+    pid_t getPid() const
+    {
+        return pid;
+    }
+
+  private:
+    pid_t pid = -1;
+};
+
+/** @class StandinPeers
+ *  @brief Stand-ins for the services the daemon talks to.
+ *  @details One connection owns the names of timedated, the settings
+ *  manager and the object mapper, and serves them from its own thread:
+ *  - org.freedesktop.timedate1 with SetTime, SetNTP, NTP, NTPSynchronized
+ *  - xyz.openbmc_project.Settings with the TimeSyncMethod setting
+ *  - xyz.openbmc_project.ObjectMapper with GetObject and GetSubTree
+ *  The hooks are called on the thread of the stand-ins.
+ */
+class StandinPeers
+{
+  public:
+    /** @brief Connect to the bus and start serving
+     *
+     * @param[in] address - The address of the bus
+     *
+     * @throw std::runtime_error when it fails to connect
+     */
+    explicit StandinPeers(const std::string& address);
+    ~StandinPeers();
+
+    StandinPeers(const StandinPeers&) = delete;
+    StandinPeers(StandinPeers&&) = delete;
+    StandinPeers& operator=(const StandinPeers&) = delete;
+    StandinPeers& operator=(StandinPeers&&) = delete;
+
+    /** @brief The number of calls served */
+    std::atomic<uint64_t> setTimeCalls = 0;
+    std::atomic<uint64_t> setNtpCalls = 0;
+    std::atomic<uint64_t> mapperCalls = 0;
+
+    /** @brief Called on every SetNTP with the requested value */
+    std::function<void(bool)> onSetNtp;
+
+    /** @brief Set the TimeSyncMethod returned by the stand-in settings */
+    void setTimeSyncMethod(const std::string& method);
+
+    /** @brief Set the NTP property returned by the stand-in timedated */
+    void setNtp(bool ntp);
+
+    /** @brief Let the stand-in timedated report NTPSynchronized the delay
+     *         after NTP is enabled, it never does by default */
+    void setSyncDelay(std::chrono::milliseconds delay);
+
+  private:
+    sdbusplus::bus_t bus;
+    std::thread thread;
+    std::atomic<bool> stop = false;
+
+    std::mutex lock;
+    std::string timeSyncMethod;
+    bool ntp = false;
+    bool ntpSynchronized = false;
+    std::optional<std::chrono::milliseconds> syncDelay;
+    std::optional<std::chrono::steady_clock::time_point> syncAt;
+
+    sd_bus_slot* timedateSlot = nullptr;
+    sd_bus_slot* settingsSlot = nullptr;
+    sd_bus_slot* mapperSlot = nullptr;
+
+    void run();
+
+    /** @brief Report NTPSynchronized once the sync delay passed */
+    void synchronize();
+
+    static int setTime(sd_bus_message* m, void* userdata, sd_bus_error* err);
+    static int setNtpMethod(sd_bus_message* m, void* userdata,
+                            sd_bus_error* err);
+    static int getNtp(sd_bus* bus, const char* path, const char* intf,
+                      const char* property, sd_bus_message* reply,
+                      void* userdata, sd_bus_error* err);
+    static int getTimeSyncMethod(sd_bus* bus, const char* path,
+                                 const char* intf, const char* property,
+                                 sd_bus_message* reply, void* userdata,
+                                 sd_bus_error* err);
+    static int setTimeSyncMethodProperty(sd_bus* bus, const char* path,
+                                         const char* intf,
+                                         const char* property,
+                                         sd_bus_message* value,
+                                         void* userdata, sd_bus_error* err);
+    static int getObject(sd_bus_message* m, void* userdata,
+                         sd_bus_error* err);
+    static int getSubTree(sd_bus_message* m, void* userdata,
+                          sd_bus_error* err);
+};
+
+/** @brief Run the connection until the condition holds or it times out
+ *
+ * @param[in] bus       - The connection
+ * @param[in] condition - The condition to wait for
+ * @param[in] timeout   - How long to wait
+ *
+ * @return true if the condition holds
+ */
+bool runUntil(sdbusplus::bus_t& bus, const std::function<bool()>& condition,
+              std::chrono::milliseconds timeout);
+
+} // namespace bench
+} // namespace time
+} // namespace phosphor
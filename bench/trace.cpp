@@ -0,0 +1,657 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+
+namespace phosphor
+{
+namespace time
+{
+namespace bench
+{
+
+using namespace std::chrono;
+
+namespace // anonymous
+{
+
+constexpr auto propertiesIntf = "org.freedesktop.DBus.Properties";
+constexpr auto epochPath = "/xyz/openbmc_project/time/bmc";
+constexpr auto epochIntf = "xyz.openbmc_project.Time.EpochTime";
+constexpr auto syncIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto timedateIntf = "org.freedesktop.timedate1";
+
+constexpr uint8_t msgMethodCall = 1;
+constexpr uint8_t msgSignal = 4;
+
+constexpr uint32_t linkTypeDBus = 231;
+
+/** @brief A bounds checked reader of the D-Bus wire format */
+class Reader
+{
+  public:
+    Reader(std::string_view data, bool bigEndian) :
+        data(data), bigEndian(bigEndian)
+    {}
+
+    bool ok() const
+    {
+        return !failed;
+    }
+
+    size_t position() const
+    {
+        return pos;
+    }
+
+    void align(size_t n)
+    {
+        pos = (pos + n - 1) / n * n;
+        if (pos > data.size())
+        {
+            failed = true;
+        }
+    }
+
+    uint8_t u8()
+    {
+        uint8_t v = 0;
+        copy(&v, 1);
+        return v;
+    }
+
+    uint32_t u32()
+    {
+        align(4);
+        uint32_t v = 0;
+        copy(&v, sizeof(v));
+        return bigEndian ? __builtin_bswap32(v) : v;
+    }
+
+    uint64_t u64()
+    {
+        align(8);
+        uint64_t v = 0;
+        copy(&v, sizeof(v));
+        return bigEndian ? __builtin_bswap64(v) : v;
+    }
+
+    std::string str()
+    {
+        return text(u32());
+    }
+
+    std::string signature()
+    {
+        return text(u8());
+    }
+
+    /** @brief Skip a single complete type
+     *
+     * @param[in] sig - The signature
+     * @param[in,out] i - The index of the type, moved past it
+     */
+    void skip(std::string_view sig, size_t& i)
+    {
+        if (i >= sig.size())
+        {
+            failed = true;
+            return;
+        }
+
+        switch (sig[i++])
+        {
+            case 'y':
+                u8();
+                break;
+            case 'n':
+            case 'q':
+                align(2);
+                pos += 2;
+                break;
+            case 'b':
+            case 'i':
+            case 'u':
+            case 'h':
+                u32();
+                break;
+            case 'x':
+            case 't':
+            case 'd':
+                u64();
+                break;
+            case 's':
+            case 'o':
+                str();
+                break;
+            case 'g':
+                signature();
+                break;
+            case 'v':
+            {
+                auto inner = signature();
+                size_t j = 0;
+                skip(inner, j);
+                break;
+            }
+            case 'a':
+            {
+                auto len = u32();
+                align(alignment(sig[i]));
+                pos += len;
+                skipSignature(sig, i);
+                break;
+            }
+            case '(':
+            case '{':
+                align(8);
+                while (ok() && i < sig.size() && sig[i] != ')' && sig[i] != '}')
+                {
+                    skip(sig, i);
+                }
+                ++i;
+                break;
+            default:
+                failed = true;
+                break;
+        }
+
+        if (pos > data.size())
+        {
+            failed = true;
+        }
+    }
+
+  private:
+    std::string_view data;
+    bool bigEndian;
+    size_t pos = 0;
+    bool failed = false;
+
+    void copy(void* dest, size_t n)
+    {
+        if (pos + n > data.size())
+        {
+            failed = true;
+            return;
+        }
+        std::memcpy(dest, data.data() + pos, n);
+        pos += n;
+    }
+
+    std::string text(size_t len)
+    {
+        if (failed || pos + len + 1 > data.size())
+        {
+            failed = true;
+            return {};
+        }
+        std::string s(data.substr(pos, len));
+        pos += len + 1;
+        return s;
+    }
+
+    static size_t alignment(char type)
+    {
+        switch (type)
+        {
+            case 'n':
+            case 'q':
+                return 2;
+            case 'b':
+            case 'i':
+            case 'u':
+            case 'h':
+            case 's':
+            case 'o':
+            case 'a':
+                return 4;
+            case 'x':
+            case 't':
+            case 'd':
+            case '(':
+            case '{':
+                return 8;
+            default:
+                return 1;
+        }
+    }
+
+    /** @brief Move past a single complete type in the signature only */
+    void skipSignature(std::string_view sig, size_t& i)
+    {
+        if (i >= sig.size())
+        {
+            failed = true;
+            return;
+        }
+        auto c = sig[i++];
+        if (c == 'a')
+        {
+            skipSignature(sig, i);
+        }
+        else if (c == '(' || c == '{')
+        {
+            while (i < sig.size() && sig[i] != ')' && sig[i] != '}')
+            {
+                skipSignature(sig, i);
+            }
+            ++i;
+        }
+    }
+};
+
+/** @brief Turn one D-Bus message into an event
+ *
+ * @param[in] data - The message
+ * @param[out] event - The event, if the message is of interest
+ *
+ * @return true if the message is of interest
+ */
+bool toEvent(std::string_view data, Event& event)
+{
+    if (data.size() < 16)
+    {
+        return false;
+    }
+
+    Reader r(data, data[0] == 'B');
+    r.u8(); // endianness
+    auto type = r.u8();
+    r.u8(); // flags
+    r.u8(); // version
+    r.u32(); // body length
+    r.u32(); // serial
+
+    std::string path;
+    std::string interface;
+    std::string member;
+    std::string signature;
+
+    auto fieldsLen = r.u32();
+    auto fieldsEnd = r.position() + fieldsLen;
+    while (r.ok() && r.position() < fieldsEnd)
+    {
+        r.align(8);
+        auto code = r.u8();
+        auto sig = r.signature();
+        if (sig == "s" || sig == "o")
+        {
+            auto value = r.str();
+            switch (code)
+            {
+                case 1:
+                    path = std::move(value);
+                    break;
+                case 2:
+                    interface = std::move(value);
+                    break;
+                case 3:
+                    member = std::move(value);
+                    break;
+                default:
+                    break;
+            }
+        }
+        else if (sig == "g" && code == 8)
+        {
+            signature = r.signature();
+        }
+        else
+        {
+            size_t i = 0;
+            r.skip(sig, i);
+        }
+    }
+    r.align(8);
+    if (!r.ok() || interface != propertiesIntf)
+    {
+        return false;
+    }
+
+    if (type == msgMethodCall && path == epochPath)
+    {
+        auto intf = r.str();
+        auto property = r.str();
+        if (intf != epochIntf || property != "Elapsed")
+        {
+            return false;
+        }
+        if (member == "Get" && signature == "ss")
+        {
+            event.kind = Event::Kind::Get;
+            return r.ok();
+        }
+        if (member == "Set" && signature == "ssv" && r.signature() == "t")
+        {
+            event.kind = Event::Kind::Set;
+            event.value = r.u64();
+            return r.ok();
+        }
+        return false;
+    }
+
+    if (type != msgSignal || member != "PropertiesChanged" ||
+        signature != "sa{sv}as")
+    {
+        return false;
+    }
+
+    auto intf = r.str();
+    auto len = r.u32();
+    r.align(8);
+    auto end = r.position() + len;
+    while (r.ok() && r.position() < end)
+    {
+        r.align(8);
+        auto key = r.str();
+        auto sig = r.signature();
+        if (intf == syncIntf && key == "TimeSyncMethod" && sig == "s")
+        {
+            event.kind = Event::Kind::Settings;
+            event.text = r.str();
+            return r.ok();
+        }
+        if (intf == timedateIntf && key == "NTP" && sig == "b")
+        {
+            event.kind = Event::Kind::Ntp;
+            event.value = r.u32();
+            return r.ok();
+        }
+        size_t i = 0;
+        r.skip(sig, i);
+    }
+    return false;
+}
+
+/** @brief Add a captured message to the trace */
+void addMessage(std::vector<Event>& events, std::string_view data,
+                microseconds timestamp)
+{
+    Event event;
+    if (!toEvent(data, event))
+    {
+        return;
+    }
+    event.offset = timestamp;
+    events.push_back(std::move(event));
+}
+
+uint32_t swap32(uint32_t v, bool swapped)
+{
+    return swapped ? __builtin_bswap32(v) : v;
+}
+
+uint16_t swap16(uint16_t v, bool swapped)
+{
+    return swapped ? __builtin_bswap16(v) : v;
+}
+
+template <typename T>
+bool readAt(std::string_view data, size_t pos, T& value)
+{
+    if (pos + sizeof(T) > data.size())
+    {
+        return false;
+    }
+    std::memcpy(&value, data.data() + pos, sizeof(T));
+    return true;
+}
+
+/** @brief Parse the classic pcap format */
+std::optional<std::vector<Event>> parseClassic(std::string_view data)
+{
+    uint32_t magic = 0;
+    readAt(data, 0, magic);
+    bool swapped = (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1);
+    bool nano = (swap32(magic, swapped) == 0xa1b23c4d);
+
+    uint32_t network = 0;
+    if (!readAt(data, 20, network) ||
+        swap32(network, swapped) != linkTypeDBus)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<Event> events;
+    size_t pos = 24;
+    uint32_t sec = 0;
+    uint32_t frac = 0;
+    uint32_t len = 0;
+    while (readAt(data, pos, sec) && readAt(data, pos + 4, frac) &&
+           readAt(data, pos + 8, len))
+    {
+        len = swap32(len, swapped);
+        pos += 16;
+        if (pos + len > data.size())
+        {
+            break;
+        }
+        auto ts = seconds(swap32(sec, swapped)) +
+                  (nano ? duration_cast<microseconds>(
+                              nanoseconds(swap32(frac, swapped)))
+                        : microseconds(swap32(frac, swapped)));
+        addMessage(events, data.substr(pos, len), ts);
+        pos += len;
+    }
+    return events;
+}
+
+/** @brief Parse the pcapng format, as written by newer busctl */
+std::optional<std::vector<Event>> parseNg(std::string_view data)
+{
+    constexpr uint32_t blockSection = 0x0A0D0D0A;
+    constexpr uint32_t blockInterface = 1;
+    constexpr uint32_t blockEnhancedPacket = 6;
+    constexpr uint16_t optionTsResol = 9;
+
+    uint32_t byteOrder = 0;
+    readAt(data, 8, byteOrder);
+    bool swapped = (byteOrder == 0x4D3C2B1A);
+
+    std::vector<Event> events;
+    std::vector<double> ticksPerUsec;
+    size_t pos = 0;
+    uint32_t type = 0;
+    uint32_t len = 0;
+    while (readAt(data, pos, type) && readAt(data, pos + 4, len))
+    {
+        type = swap32(type, swapped);
+        len = swap32(len, swapped);
+        if (len < 12 || pos + len > data.size())
+        {
+            break;
+        }
+        auto block = data.substr(pos + 8, len - 12);
+
+        if (type == blockSection)
+        {
+            ticksPerUsec.clear();
+        }
+        else if (type == blockInterface)
+        {
+            uint16_t linkType = 0;
+            readAt(block, 0, linkType);
+            if (swap16(linkType, swapped) != linkTypeDBus)
+            {
+                return std::nullopt;
+            }
+
+            // The timestamps are in microseconds unless if_tsresol says
+            // otherwise
+            double resolution = 1;
+            size_t opt = 8;
+            uint16_t code = 0;
+            uint16_t optLen = 0;
+            while (readAt(block, opt, code) && readAt(block, opt + 2, optLen))
+            {
+                code = swap16(code, swapped);
+                optLen = swap16(optLen, swapped);
+                if (code == 0)
+                {
+                    break;
+                }
+                if (code == optionTsResol && optLen >= 1)
+                {
+                    uint8_t v = block[opt + 4];
+                    double ticksPerSec = (v & 0x80) ? double(1ULL << (v & 0x7f))
+                                                    : std::pow(10.0, v);
+                    resolution = ticksPerSec / 1e6;
+                }
+                opt += 4 + (optLen + 3) / 4 * 4;
+            }
+            ticksPerUsec.push_back(resolution);
+        }
+        else if (type == blockEnhancedPacket)
+        {
+            uint32_t intf = 0;
+            uint32_t high = 0;
+            uint32_t low = 0;
+            uint32_t captured = 0;
+            readAt(block, 0, intf);
+            readAt(block, 4, high);
+            readAt(block, 8, low);
+            readAt(block, 12, captured);
+            intf = swap32(intf, swapped);
+            captured = swap32(captured, swapped);
+            if (intf < ticksPerUsec.size() && 20 + captured <= block.size())
+            {
+                auto ticks = (uint64_t(swap32(high, swapped)) << 32) |
+                             swap32(low, swapped);
+                auto ts = microseconds(
+                    static_cast<int64_t>(ticks / ticksPerUsec[intf]));
+                addMessage(events, block.substr(20, captured), ts);
+            }
+        }
+        pos += len;
+    }
+    return events;
+}
+
+/** @brief Order the events and make the offsets relative to the first */
+void rebase(std::vector<Event>& events)
+{
+    if (events.empty())
+    {
+        return;
+    }
+    std::ranges::stable_sort(events, {}, &Event::offset);
+    auto first = events.front().offset;
+    for (auto& e : events)
+    {
+        e.offset -= first;
+    }
+}
+
+} // namespace
+
+const char* toString(Event::Kind kind)
+{
+    switch (kind)
+    {
+        case Event::Kind::Get:
+            return "get";
+        case Event::Kind::Set:
+            return "set";
+        case Event::Kind::Settings:
+            return "settings";
+        case Event::Kind::Ntp:
+            return "ntp";
+    }
+    return "unknown";
+}
+
+std::optional<std::vector<Event>> parseText(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<Event> events;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        int64_t offset = 0;
+        std::string kind;
+        if (!(fields >> offset >> kind))
+        {
+            return std::nullopt;
+        }
+
+        Event event;
+        event.offset = microseconds(offset);
+        if (kind == "get")
+        {
+            event.kind = Event::Kind::Get;
+        }
+        else if (kind == "set" && (fields >> event.value))
+        {
+            event.kind = Event::Kind::Set;
+        }
+        else if (kind == "settings" && (fields >> event.text))
+        {
+            event.kind = Event::Kind::Settings;
+        }
+        else if (kind == "ntp" && (fields >> event.value))
+        {
+            event.kind = Event::Kind::Ntp;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+        events.push_back(std::move(event));
+    }
+    rebase(events);
+    return events;
+}
+
+std::optional<std::vector<Event>> parsePcap(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+
+    uint32_t magic = 0;
+    if (!readAt(std::string_view(data), 0, magic))
+    {
+        return std::nullopt;
+    }
+
+    std::optional<std::vector<Event>> events;
+    if (magic == 0x0A0D0D0A)
+    {
+        events = parseNg(data);
+    }
+    else
+    {
+        events = parseClassic(data);
+    }
+
+    if (events)
+    {
+        rebase(*events);
+    }
+    return events;
+}
+
+} // namespace bench
+} // namespace time
+} // namespace phosphor
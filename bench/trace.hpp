@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace time
+{
+namespace bench
+{
+
+/** @brief A recorded message to replay against the daemon */
+struct Event
+{
+    enum class Kind
+    {
+        /** @brief A Get of Elapsed */
+        Get,
+        /** @brief A Set of Elapsed to value */
+        Set,
+        /** @brief A settings TimeSyncMethod PropertiesChanged to text */
+        Settings,
+        /** @brief A timedate1 NTP PropertiesChanged to value */
+        Ntp,
+    };
+
+    /** @brief The time since the first event of the trace */
+    std::chrono::microseconds offset{};
+
+    Kind kind = Kind::Get;
+
+    /** @brief The value of a Set, or 0/1 of an NTP change */
+    uint64_t value = 0;
+
+    /** @brief The TimeSyncMethod of a settings change */
+    std::string text;
+};
+
+/** @brief Get the name of an event kind as used in the text format */
+const char* toString(Event::Kind kind);
+
+/** @brief Parse a trace in the text format
+ *
+ * Every line is "<offset-usec> <kind> [value]" with the kinds
+ *   get
+ *   set <usec>
+ *   settings <TimeSyncMethod>
+ *   ntp <0|1>
+ * Empty lines and lines starting with # are skipped.
+ *
+ * @param[in] path - The path of the trace
+ *
+ * @return The events, or std::nullopt if the file is invalid
+ */
+std::optional<std::vector<Event>> parseText(const std::string& path);
+
+/** @brief Parse a capture of `busctl capture`
+ *
+ * The pcap file holds one D-Bus message per packet. Gets and Sets of
+ * Elapsed, and PropertiesChanged of the settings TimeSyncMethod and of the
+ * timedate1 NTP are turned into events, every other message is skipped.
+ *
+ * @param[in] path - The path of the pcap file
+ *
+ * @return The events, or std::nullopt if the file is invalid
+ */
+std::optional<std::vector<Event>> parsePcap(const std::string& path);
+
+} // namespace bench
+} // namespace time
+} // namespace phosphor
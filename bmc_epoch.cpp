@@ -1,9 +1,10 @@
 #include "bmc_epoch.hpp"
 
+#include "metrics.hpp"
+#include "probes.hpp"
 #include "utils.hpp"
 
-#include <sys/timerfd.h>
-#include <unistd.h>
+#include <time.h>
 
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
@@ -11,24 +12,18 @@
 #include <xyz/openbmc_project/Common/error.hpp>
 #include <xyz/openbmc_project/Time/error.hpp>
 
+#include <array>
 #include <chrono>
 
-// Need to do this since its not exported outside of the kernel.
-// Refer : https://gist.github.com/lethean/446cea944b7441228298
-#ifndef TFD_TIMER_CANCEL_ON_SET
-#define TFD_TIMER_CANCEL_ON_SET (1 << 1)
-#endif
-
 namespace phosphor
 {
 namespace time
 {
 namespace // anonymous
 {
-constexpr auto systemdTimeService = "org.freedesktop.timedate1";
-constexpr auto systemdTimePath = "/org/freedesktop/timedate1";
-constexpr auto systemdTimeInterface = "org.freedesktop.timedate1";
-constexpr auto methodSetTime = "SetTime";
+constexpr auto propertyDateTime = "DateTime";
+constexpr auto propertySenders = "Senders";
+constexpr auto propertyRejected = "Rejected";
 } // namespace
 
 PHOSPHOR_LOG2_USING;
@@ -40,50 +35,21 @@ using namespace std::chrono;
 
 void BmcEpoch::initialize()
 {
-    using InternalFailure =
-        sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
-
-    // Subscribe time change event
-    // Choose the MAX time that is possible to avoid mis fires.
-    constexpr itimerspec maxTime = {
-        {0, 0},                                     // it_interval
-        {system_clock::duration::max().count(), 0}, // it_value
-    };
-
-    timeFd = timerfd_create(CLOCK_REALTIME, 0);
-    if (timeFd == -1)
-    {
-        error("Failed to create timerfd: {ERRNO}", "ERRNO", errno);
-        elog<InternalFailure>();
-    }
-
-    auto r = timerfd_settime(
-        timeFd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &maxTime, nullptr);
-    if (r != 0)
-    {
-        error("Failed to set timerfd: {ERRNO}", "ERRNO", errno);
-        elog<InternalFailure>();
-    }
-
-    sd_event_source* es = nullptr;
-    r = sd_event_add_io(bus.get_event(), &es, timeFd, EPOLLIN, onTimeChange,
-                        this);
-    if (r < 0)
-    {
-        error("Failed to add event: {ERRNO}", "ERRNO", errno);
-        elog<InternalFailure>();
-    }
-    timeChangeEventSource.reset(es);
+    manager.getEvents().subscribe(*this);
 }
 
 BmcEpoch::~BmcEpoch()
 {
-    close(timeFd);
+    manager.getEvents().unsubscribe(*this);
 }
 
 uint64_t BmcEpoch::elapsed() const
 {
-    return getTime().count();
+    TIME_PROBE(elapsed_get_entry);
+    metrics::Latency latency(metrics::get().elapsedGet);
+    auto value = getTime().count();
+    TIME_PROBE(elapsed_get_return, value);
+    return value;
 }
 
 uint64_t BmcEpoch::elapsed(uint64_t value)
@@ -94,58 +60,160 @@ uint64_t BmcEpoch::elapsed(uint64_t value)
         NTP   | Fail to set
         MANUAL| OK
     */
+    TIME_PROBE(elapsed_set_entry, value);
+    metrics::Latency latency(metrics::get().elapsedSet);
+
+    // Sets made internally have no current message and are not limited
+    auto* msg = sd_bus_get_current_message(bus.get());
+    const char* sender = msg ? sd_bus_message_get_sender(msg) : nullptr;
+    if (sender && !admit(sender))
+    {
+        using Unavailable =
+            sdbusplus::xyz::openbmc_project::Common::Error::Unavailable;
+        throw Unavailable();
+    }
+
     auto time = microseconds(value);
     setTime(time);
 
     server::EpochTime::elapsed(value);
+    TIME_PROBE(elapsed_set_return, value);
     return value;
 }
 
-int BmcEpoch::onTimeChange(sd_event_source* /* es */, int fd,
-                           uint32_t /* revents */, void* /* userdata */)
+const sdbusplus::vtable_t BmcEpoch::dateTimeVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyDateTime, "s", getDateTime),
+    sdbusplus::vtable::end(),
+};
+
+const std::string& BmcEpoch::dateTime() const
+{
+    auto second = duration_cast<seconds>(getTime()).count();
+    if (!dateTimeStale && second == dateTimeSecond)
+    {
+        return dateTimeCache;
+    }
+
+    std::array<char, 32> buf{};
+    time_t t = second;
+    tm tm{};
+    gmtime_r(&t, &tm);
+    auto len = strftime(buf.data(), buf.size(), "%Y-%m-%dT%H:%M:%S+00:00", &tm);
+
+    dateTimeCache.assign(buf.data(), len);
+    dateTimeSecond = second;
+    dateTimeStale = false;
+    return dateTimeCache;
+}
+
+int BmcEpoch::getDateTime(sd_bus* /* bus */, const char* /* path */,
+                          const char* /* intf */, const char* /* property */,
+                          sd_bus_message* reply, void* userdata,
+                          sd_bus_error* /* error */)
+{
+    const auto* epoch = static_cast<const BmcEpoch*>(userdata);
+    return sd_bus_message_append(reply, "s", epoch->dateTime().c_str());
+}
+
+const sdbusplus::vtable_t BmcEpoch::rateLimitVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertySenders, "a{s(tt)}", getSenders),
+    sdbusplus::vtable::property(propertyRejected, "t", getRejected),
+    sdbusplus::vtable::end(),
+};
+
+int BmcEpoch::getSenders(sd_bus* /* bus */, const char* /* path */,
+                         const char* /* intf */, const char* /* property */,
+                         sd_bus_message* reply, void* userdata,
+                         sd_bus_error* /* error */)
 {
-    std::array<char, 64> time{};
+    const auto* epoch = static_cast<const BmcEpoch*>(userdata);
 
-    // We are not interested in the data here.
-    // So read until there is no new data here in the FD
-    while (read(fd, time.data(), time.max_size()) > 0)
+    auto r = sd_bus_message_open_container(reply, 'a', "{s(tt)}");
+    for (const auto& [sender, counters] : epoch->setLimiter.counters())
+    {
+        if (r < 0)
+        {
+            return r;
+        }
+        r = sd_bus_message_append(reply, "{s(tt)}", sender.c_str(),
+                                  counters.admitted, counters.rejected);
+    }
+    if (r < 0)
     {
-        ;
+        return r;
     }
+    return sd_bus_message_close_container(reply);
+}
 
-    return 0;
+int BmcEpoch::getRejected(sd_bus* /* bus */, const char* /* path */,
+                          const char* /* intf */, const char* /* property */,
+                          sd_bus_message* reply, void* userdata,
+                          sd_bus_error* /* error */)
+{
+    const auto* epoch = static_cast<const BmcEpoch*>(userdata);
+    return sd_bus_message_append(reply, "t",
+                                 epoch->setLimiter.totalRejected());
 }
 
-void BmcEpoch::onModeChanged(Mode mode)
+void BmcEpoch::onTimeChange(microseconds delta)
 {
-    manager.setTimeMode(mode);
+    ++metrics::get().jumps;
+    debug("Clock stepped by {DELTA}us", "DELTA", delta.count());
+
+    // The clock is stepped, the cached DateTime may be off by less than a
+    // second and must not be reused.
+    dateTimeStale = true;
 }
 
-bool BmcEpoch::setTime(const microseconds& usec)
+void BmcEpoch::onEvent(const event::Jump& event)
 {
-    auto method = bus.new_method_call(systemdTimeService, systemdTimePath,
-                                      systemdTimeInterface, methodSetTime);
-    method.append(static_cast<int64_t>(usec.count()),
-                  false,  // relative
-                  false); // user_interaction
+    onTimeChange(event.delta);
+}
 
-    try
+utils::Expected<void> BmcEpoch::admit(const char* sender)
+{
+    if (setLimiter.admit(sender))
+    {
+        return {};
+    }
+    if (setLimiter.counters(sender).rejected == 1)
     {
-        bus.call_noreply(method);
+        warning("Rate limiting the sets of the time from {SENDER}", "SENDER",
+                sender);
     }
-    catch (const sdbusplus::exception_t& ex)
+    TIME_PROBE(elapsed_set_rejected, sender);
+    using Unavailable =
+        sdbusplus::xyz::openbmc_project::Common::Error::Unavailable;
+    return std::unexpected(utils::Error{-EBUSY, Unavailable().name(),
+                                        "Too many sets of the time"});
+}
+
+utils::Expected<void> BmcEpoch::trySetTime(const microseconds& usec)
+{
+    TIME_PROBE(settime_entry, usec.count());
+    auto result = clock.step(usec);
+    TIME_PROBE(settime_return, result ? 0 : result.error().errnum);
+    return result;
+}
+
+bool BmcEpoch::setTime(const microseconds& usec)
+{
+    auto result = trySetTime(usec);
+    if (!result)
     {
-        error("Error in setting system time: {ERROR}", "ERROR", ex);
+        error("Error in setting system time: {ERROR}", "ERROR",
+              result.error().message);
         using namespace xyz::openbmc_project::Time;
-        elog<FailedError>(Failed::REASON(ex.what()));
+        elog<FailedError>(Failed::REASON(result.error().message.c_str()));
     }
     return true;
 }
 
-microseconds BmcEpoch::getTime()
+microseconds BmcEpoch::getTime() const
 {
-    auto now = system_clock::now();
-    return duration_cast<microseconds>(now.time_since_epoch());
+    return clock.now();
 }
 
 } // namespace time
@@ -1,12 +1,22 @@
 #pragma once
 
+#include "config.h"
+
+#include "clock.hpp"
+#include "events.hpp"
 #include "manager.hpp"
-#include "property_change_listener.hpp"
+#include "rate_limiter.hpp"
+#include "scheduled_set.hpp"
+#include "time_transaction.hpp"
+#include "utils.hpp"
 
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
 #include <xyz/openbmc_project/Time/EpochTime/server.hpp>
 
 #include <chrono>
+#include <string>
 
 namespace phosphor
 {
@@ -21,11 +31,32 @@ using EpochTimeIntf = sdbusplus::server::object_t<
  *  @details A concrete implementation for
  * xyz.openbmc_project.Time.EpochTime DBus API for BMC's epoch time.
  */
-class BmcEpoch : public EpochTimeIntf, public PropertyChangeListner
+class BmcEpoch : public EpochTimeIntf
 {
   public:
-    BmcEpoch(sdbusplus::bus_t& bus, const char* objPath, Manager& manager) :
-        EpochTimeIntf(bus, objPath), bus(bus), manager(manager)
+    BmcEpoch(sdbusplus::bus_t& bus, const char* objPath, Manager& manager,
+             Clock& clock) :
+        EpochTimeIntf(bus, objPath), bus(bus), manager(manager), clock(clock),
+        dateTimeInterface(bus, objPath, dateTimeIntf, dateTimeVtable, this),
+        rateLimitInterface(bus, objPath, rateLimitIntf, rateLimitVtable, this),
+        scheduledSet(
+            bus, objPath, clock,
+            [this](std::chrono::microseconds delta) {
+                return this->clock.stepBy(delta);
+            },
+            [this](const char* sender) { return admit(sender); }),
+        transaction(bus, objPath, clock,
+                    {[this]() { return this->manager.getTimeMode(); },
+                     [this](Mode mode) {
+                         return this->manager.trySetTimeMode(mode);
+                     },
+                     [this](bool enable) {
+                         return this->manager.trySetNtp(enable);
+                     },
+                     [this](std::chrono::microseconds t) {
+                         return trySetTime(t);
+                     }},
+                    [this](const char* sender) { return admit(sender); })
     {
         initialize();
     }
@@ -37,8 +68,8 @@ class BmcEpoch : public EpochTimeIntf, public PropertyChangeListner
     BmcEpoch& operator=(const BmcEpoch&) = delete;
     BmcEpoch& operator=(BmcEpoch&&) = delete;
 
-    /** @brief Notified on time mode changed */
-    void onModeChanged(Mode mode) override;
+    /** @brief Notified on the clock is stepped */
+    void onEvent(const event::Jump& event);
 
     /**
      * @brief Get value of Elapsed property
@@ -50,11 +81,31 @@ class BmcEpoch : public EpochTimeIntf, public PropertyChangeListner
     /**
      * @brief Set value of Elapsed property
      *
+     * The Set is rejected with Unavailable when its sender exceeds the
+     * configured rate, before any call to systemd time service is made.
+     *
      * @param[in] value - The microseconds since UTC to set
      * @return The updated elapsed microseconds since UTC
      **/
     uint64_t elapsed(uint64_t value) override;
 
+    /**
+     * @brief Get value of DateTime property
+     *
+     * The UTC time is rendered as ISO 8601 with second resolution, e.g.
+     * "2024-01-31T12:00:00+00:00". The string is cached and only rendered
+     * again when the second changes or the clock is stepped.
+     *
+     * @return The current UTC date and time
+     **/
+    const std::string& dateTime() const;
+
+    /** @brief Get the sets scheduled at a deadline */
+    const ScheduledSet& getScheduledSet() const
+    {
+        return scheduledSet;
+    }
+
   protected:
     /** @brief Persistent sdbusplus DBus connection */
     sdbusplus::bus_t& bus;
@@ -62,10 +113,13 @@ class BmcEpoch : public EpochTimeIntf, public PropertyChangeListner
     /** @brief The manager to handle OpenBMC time */
     Manager& manager;
 
+    /** @brief The clock that is read and stepped */
+    Clock& clock;
+
     /** @brief Set current time to system
      *
-     * This function set the time to system by invoking systemd
-     * org.freedesktop.timedate1's SetTime method.
+     * This function steps the clock, for the system clock by invoking
+     * systemd org.freedesktop.timedate1's SetTime method.
      *
      * @param[in] timeOfDayUsec - Microseconds since UTC
      *
@@ -73,42 +127,93 @@ class BmcEpoch : public EpochTimeIntf, public PropertyChangeListner
      */
     bool setTime(const std::chrono::microseconds& timeOfDayUsec);
 
+    /** @brief Set current time to system without throwing
+     *
+     * The same as setTime() but the failure is returned to the caller
+     * instead of being logged and raised as a D-Bus error.
+     *
+     * @param[in] timeOfDayUsec - Microseconds since UTC
+     *
+     * @return Nothing or the error of the step
+     */
+    utils::Expected<void>
+        trySetTime(const std::chrono::microseconds& timeOfDayUsec);
+
     /** @brief Get current time
      *
      * @return Microseconds since UTC
      */
-    static std::chrono::microseconds getTime();
+    std::chrono::microseconds getTime() const;
 
   private:
-    /** @brief The fd for time change event */
-    int timeFd = -1;
+    /** @brief The second since UTC that dateTimeCache is rendered for */
+    mutable int64_t dateTimeSecond = 0;
+
+    /** @brief Whether dateTimeCache must be rendered on the next read */
+    mutable bool dateTimeStale = true;
+
+    /** @brief The cached value of DateTime property */
+    mutable std::string dateTimeCache;
+
+    /** @brief The DateTime interface next to EpochTime */
+    sdbusplus::server::interface_t dateTimeInterface;
+
+    /** @brief The vtable of the DateTime interface */
+    static const sdbusplus::vtable_t dateTimeVtable[];
+
+    /** @brief The getter of DateTime property */
+    static int getDateTime(sd_bus* bus, const char* path, const char* intf,
+                           const char* property, sd_bus_message* reply,
+                           void* userdata, sd_bus_error* error);
+
+    /** @brief The admission control of Elapsed Sets */
+    RateLimiter setLimiter{ELAPSED_SET_RATE, ELAPSED_SET_BURST,
+                           maxRateLimitedSenders};
+
+    /** @brief The number of senders tracked by setLimiter */
+    static constexpr size_t maxRateLimitedSenders = 64;
+
+    /** @brief Admit a set of the time by a sender through setLimiter, be
+     *         it of Elapsed, a scheduled set or a transaction
+     *
+     * @param[in] sender - The unique name of the sender
+     *
+     * @return Nothing or the Unavailable error of a rejected set
+     */
+    utils::Expected<void> admit(const char* sender);
+
+    /** @brief The RateLimit interface exposing the per sender counters */
+    sdbusplus::server::interface_t rateLimitInterface;
+
+    /** @brief The vtable of the RateLimit interface */
+    static const sdbusplus::vtable_t rateLimitVtable[];
+
+    /** @brief The getter of Senders property, a{s(tt)} of the admitted and
+     *         rejected Sets of each sender */
+    static int getSenders(sd_bus* bus, const char* path, const char* intf,
+                          const char* property, sd_bus_message* reply,
+                          void* userdata, sd_bus_error* error);
+
+    /** @brief The getter of Rejected property, the rejected Sets of all
+     *         senders */
+    static int getRejected(sd_bus* bus, const char* path, const char* intf,
+                           const char* property, sd_bus_message* reply,
+                           void* userdata, sd_bus_error* error);
+
+    /** @brief The sets of the time at a deadline */
+    ScheduledSet scheduledSet;
+
+    /** @brief The sets of a manual time in NTP mode in one call */
+    TimeTransaction transaction;
 
-    /** @brief Initialize timerFd related resource */
+    /** @brief Subscribe to the time events */
     void initialize();
 
-    /** @brief The callback function on system time change
+    /** @brief Called after the clock is stepped
      *
-     * @param[in] es - Source of the event
-     * @param[in] fd - File descriptor of the timer
-     * @param[in] revents - Not used
-     * @param[in] userdata - User data pointer
+     * @param[in] delta - The size of the step
      */
-    static int onTimeChange(sd_event_source* es, int fd, uint32_t revents,
-                            void* userdata);
-
-    /** @brief The deleter of sd_event_source */
-    std::function<void(sd_event_source*)> sdEventSourceDeleter =
-        [](sd_event_source* p) {
-            if (p)
-            {
-                sd_event_source_unref(p);
-            }
-        };
-    using SdEventSource =
-        std::unique_ptr<sd_event_source, decltype(sdEventSourceDeleter)>;
-
-    /** @brief The event source on system time change */
-    SdEventSource timeChangeEventSource{nullptr, sdEventSourceDeleter};
+    void onTimeChange(std::chrono::microseconds delta);
 };
 
 } // namespace time
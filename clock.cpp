@@ -0,0 +1,259 @@
+#include "clock.hpp"
+
+#include "probes.hpp"
+#include "scheduling.hpp"
+
+#include <sys/timerfd.h>
+#include <sys/timex.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <phosphor-logging/elog-errors.hpp>
+#include <phosphor-logging/elog.hpp>
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+// Need to do this since its not exported outside of the kernel.
+// Refer : https://gist.github.com/lethean/446cea944b7441228298
+#ifndef TFD_TIMER_CANCEL_ON_SET
+#define TFD_TIMER_CANCEL_ON_SET (1 << 1)
+#endif
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto systemdTimeService = "org.freedesktop.timedate1";
+constexpr auto systemdTimePath = "/org/freedesktop/timedate1";
+constexpr auto systemdTimeInterface = "org.freedesktop.timedate1";
+constexpr auto methodSetTime = "SetTime";
+
+/** @brief The frequency limit of the kernel, MAXFREQ */
+constexpr double maxFrequency = 500;
+
+/** @brief timex.freq is in ppm with a 16 bit fraction */
+constexpr double frequencyScale = 65536;
+
+utils::Error errnoError(const char* what)
+{
+    auto e = errno;
+    return {-e, "", std::string(what) + ": " + std::strerror(e)};
+}
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+using namespace phosphor::logging;
+using namespace std::chrono;
+
+SystemClock::SystemClock(sdbusplus::bus_t& bus) :
+    bus(bus), offset(realtimeOffset())
+{
+    initialize();
+}
+
+void SystemClock::initialize()
+{
+    using InternalFailure =
+        sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
+
+    // Subscribe time change event
+    // Choose the MAX time that is possible to avoid mis fires.
+    constexpr itimerspec maxTime = {
+        {0, 0},                                     // it_interval
+        {system_clock::duration::max().count(), 0}, // it_value
+    };
+
+    timeFd = timerfd_create(CLOCK_REALTIME, 0);
+    if (timeFd == -1)
+    {
+        error("Failed to create timerfd: {ERRNO}", "ERRNO", errno);
+        elog<InternalFailure>();
+    }
+
+    auto r = timerfd_settime(
+        timeFd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &maxTime, nullptr);
+    if (r != 0)
+    {
+        error("Failed to set timerfd: {ERRNO}", "ERRNO", errno);
+        elog<InternalFailure>();
+    }
+
+    sd_event_source* es = nullptr;
+    r = sd_event_add_io(bus.get_event(), &es, timeFd, EPOLLIN, onTimeChange,
+                        this);
+    if (r < 0)
+    {
+        error("Failed to add event: {ERRNO}", "ERRNO", errno);
+        elog<InternalFailure>();
+    }
+    timeChangeEventSource.reset(es);
+
+    // A jump is handled ahead of the calls queued on the bus
+    sd_event_source_set_priority(es, priority::high);
+}
+
+SystemClock::~SystemClock()
+{
+    close(timeFd);
+}
+
+microseconds SystemClock::now() const
+{
+    auto now = system_clock::now();
+    return duration_cast<microseconds>(now.time_since_epoch());
+}
+
+microseconds SystemClock::coarseNow() const
+{
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return seconds(ts.tv_sec) +
+           duration_cast<microseconds>(nanoseconds(ts.tv_nsec));
+}
+
+microseconds SystemClock::monotonic() const
+{
+    timespec ts{};
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return seconds(ts.tv_sec) +
+           duration_cast<microseconds>(nanoseconds(ts.tv_nsec));
+}
+
+utils::Expected<Discipline> SystemClock::discipline() const
+{
+    timex tx{};
+    auto r = adjtimex(&tx);
+    if (r < 0)
+    {
+        return std::unexpected(errnoError("adjtimex"));
+    }
+
+    Discipline d;
+    d.synchronized = (r != TIME_ERROR) && !(tx.status & STA_UNSYNC);
+    d.frequency = static_cast<double>(tx.freq) / frequencyScale;
+    d.maxError = microseconds(tx.maxerror);
+    d.estError = microseconds(tx.esterror);
+    return d;
+}
+
+utils::Expected<void> SystemClock::setFrequency(double ppm)
+{
+    timex tx{};
+    tx.modes = ADJ_FREQUENCY;
+    tx.freq = std::lround(std::clamp(ppm, -maxFrequency, maxFrequency) *
+                          frequencyScale);
+    if (adjtimex(&tx) < 0)
+    {
+        return std::unexpected(errnoError("adjtimex"));
+    }
+    return {};
+}
+
+utils::Expected<void> SystemClock::step(microseconds time)
+{
+    return setTime(time, false);
+}
+
+utils::Expected<void> SystemClock::stepBy(microseconds delta)
+{
+    return setTime(delta, true);
+}
+
+utils::Expected<void> SystemClock::setTime(microseconds usec, bool relative)
+{
+    auto method = bus.new_method_call(systemdTimeService, systemdTimePath,
+                                      systemdTimeInterface, methodSetTime);
+    method.append(static_cast<int64_t>(usec.count()), relative,
+                  false); // user_interaction
+
+    auto reply = utils::call(bus, method);
+    if (!reply)
+    {
+        return std::unexpected(std::move(reply.error()));
+    }
+    ++pendingSteps;
+    return {};
+}
+
+microseconds SystemClock::realtimeOffset()
+{
+    timespec realtime{};
+    timespec monotonic{};
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+    clock_gettime(CLOCK_REALTIME, &realtime);
+
+    auto toUsec = [](const timespec& ts) {
+        return seconds(ts.tv_sec) + duration_cast<microseconds>(
+                                        nanoseconds(ts.tv_nsec));
+    };
+    return toUsec(realtime) - toUsec(monotonic);
+}
+
+int SystemClock::onTimeChange(sd_event_source* /* es */, int fd,
+                              uint32_t /* revents */, void* userdata)
+{
+    std::array<char, 64> time{};
+    size_t drained = 0;
+
+    // We are not interested in the data here.
+    // So read until there is no new data here in the FD
+    ssize_t n = 0;
+    while ((n = read(fd, time.data(), time.max_size())) > 0)
+    {
+        drained += n;
+    }
+
+    auto* clock = static_cast<SystemClock*>(userdata);
+    auto offset = realtimeOffset();
+    auto delta = offset - clock->offset;
+    clock->offset = offset;
+    TIME_PROBE(time_change, drained, delta.count());
+    // Jumps coming together are detected as one, which is ours if any is
+    bool own = clock->pendingSteps > 0;
+    clock->pendingSteps = 0;
+    clock->notifyJump(delta, own);
+
+    return 0;
+}
+
+utils::Expected<void> SimulatedClock::step(microseconds to)
+{
+    if (stepError)
+    {
+        return std::unexpected(*stepError);
+    }
+
+    auto delta = to - time;
+    time = to;
+    ++stepCount;
+    notifyJump(delta, true);
+    return {};
+}
+
+void SimulatedClock::advance(microseconds elapsed)
+{
+    // Keep the fraction of a microsecond so small steps drift as well
+    auto ppm = driftPpm + state.frequency;
+    driftRemainder += static_cast<double>(elapsed.count()) * ppm / 1e6;
+    auto drift = std::trunc(driftRemainder);
+    driftRemainder -= drift;
+    time += elapsed + microseconds(static_cast<int64_t>(drift));
+    uptime += elapsed;
+}
+
+void SimulatedClock::jump(microseconds delta)
+{
+    time += delta;
+    notifyJump(delta, false);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,362 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <systemd/sd-event.h>
+
+#include <sdbusplus/bus.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @brief The state of the kernel clock discipline, see adjtimex(2) */
+struct Discipline
+{
+    /** @brief Whether an NTP daemon keeps the clock synchronized */
+    bool synchronized = false;
+
+    /** @brief The frequency correction in ppm, positive speeds it up */
+    double frequency = 0;
+
+    /** @brief The maximum error reported by the NTP daemon */
+    std::chrono::microseconds maxError{};
+
+    /** @brief The estimated error reported by the NTP daemon */
+    std::chrono::microseconds estError{};
+};
+
+/** @class Clock
+ *  @brief The realtime clock of the BMC as seen by the time manager.
+ *  @details The time is read, stepped and watched for jumps through this
+ *  interface only, so the tests and the benchmarks can replace the system
+ *  clock with a SimulatedClock.
+ */
+class Clock
+{
+  public:
+    /** @brief Called after the clock is stepped, with the size of the step
+     *         and whether it was made by step() or stepBy() */
+    using JumpCallback =
+        std::function<void(std::chrono::microseconds delta, bool own)>;
+
+    Clock() = default;
+    virtual ~Clock() = default;
+
+    Clock(const Clock&) = delete;
+    Clock(Clock&&) = delete;
+    Clock& operator=(const Clock&) = delete;
+    Clock& operator=(Clock&&) = delete;
+
+    /** @brief Get the current time
+     *
+     * @return Microseconds since UTC
+     */
+    virtual std::chrono::microseconds now() const = 0;
+
+    /** @brief Get the time since boot, which is never stepped
+     *
+     * @return Microseconds since boot
+     */
+    virtual std::chrono::microseconds monotonic() const = 0;
+
+    /** @brief Get the state of the kernel clock discipline
+     *
+     * @return The discipline or the error of reading it
+     */
+    virtual utils::Expected<Discipline> discipline() const = 0;
+
+    /** @brief Set the frequency correction of the clock
+     *
+     * @param[in] ppm - The correction in ppm, positive speeds it up
+     *
+     * @return Nothing or the error of setting it
+     */
+    virtual utils::Expected<void> setFrequency(double ppm) = 0;
+
+    /** @brief Step the clock to the given time
+     *
+     * The jump callback is called once the step is applied, which may be
+     * after this returns.
+     *
+     * @param[in] time - Microseconds since UTC
+     *
+     * @return Nothing or the error of the step
+     */
+    virtual utils::Expected<void> step(std::chrono::microseconds time) = 0;
+
+    /** @brief Step the clock by the given delta
+     *
+     * The delta is added to the time the clock reads when the step is
+     * applied, so the time it takes to get there is not lost.
+     *
+     * @param[in] delta - The size of the step
+     *
+     * @return Nothing or the error of the step
+     */
+    virtual utils::Expected<void> stepBy(std::chrono::microseconds delta) = 0;
+
+    /** @brief Set the function called after every jump of the clock,
+     *         whether it is stepped by us or by anyone else
+     *
+     * @param[in] callback - The function to call
+     */
+    void onJump(JumpCallback callback)
+    {
+        jumpCallback = std::move(callback);
+    }
+
+  protected:
+    /** @brief Notify the jump callback
+     *
+     * @param[in] delta - The size of the step
+     * @param[in] own   - Whether it was made by step() or stepBy()
+     */
+    void notifyJump(std::chrono::microseconds delta, bool own) const
+    {
+        if (jumpCallback)
+        {
+            jumpCallback(delta, own);
+        }
+    }
+
+  private:
+    /** @brief The function called after every jump */
+    JumpCallback jumpCallback;
+};
+
+/** @class SystemClock
+ *  @brief The CLOCK_REALTIME of the system.
+ *  @details The time is stepped by systemd timedated's SetTime, and the
+ *  jumps are detected by a timerfd with TFD_TIMER_CANCEL_ON_SET on the
+ *  sd_event loop of the bus.
+ */
+class SystemClock : public Clock
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param[in] bus - The Dbus bus object, attached to an event loop
+     */
+    explicit SystemClock(sdbusplus::bus_t& bus);
+    ~SystemClock() override;
+
+    SystemClock(const SystemClock&) = delete;
+    SystemClock(SystemClock&&) = delete;
+    SystemClock& operator=(const SystemClock&) = delete;
+    SystemClock& operator=(SystemClock&&) = delete;
+
+    /** @brief Get CLOCK_REALTIME */
+    std::chrono::microseconds now() const override;
+
+    /** @brief Get CLOCK_REALTIME_COARSE, which is cheap with any
+     *         clocksource but only as precise as a tick */
+    std::chrono::microseconds coarseNow() const;
+
+    /** @brief Get CLOCK_BOOTTIME */
+    std::chrono::microseconds monotonic() const override;
+
+    /** @brief Read the discipline with adjtimex(2) */
+    utils::Expected<Discipline> discipline() const override;
+
+    /** @brief Set the frequency with adjtimex(2), clamped to the kernel
+     *         limit of 500ppm */
+    utils::Expected<void> setFrequency(double ppm) override;
+
+    /** @brief Set the time by invoking systemd org.freedesktop.timedate1's
+     *         SetTime method */
+    utils::Expected<void> step(std::chrono::microseconds time) override;
+
+    /** @brief Step the time by invoking systemd org.freedesktop.timedate1's
+     *         SetTime method with relative set */
+    utils::Expected<void> stepBy(std::chrono::microseconds delta) override;
+
+  private:
+    /** @brief Persistent sdbusplus DBus connection */
+    sdbusplus::bus_t& bus;
+
+    /** @brief Call SetTime of systemd time service
+     *
+     * @param[in] usec     - The time, or the delta if relative
+     * @param[in] relative - Whether usec is added to the current time
+     */
+    utils::Expected<void> setTime(std::chrono::microseconds usec,
+                                  bool relative);
+
+    /** @brief The fd for time change event */
+    int timeFd = -1;
+
+    /** @brief The steps SetTime accepted that no jump was detected of yet */
+    unsigned pendingSteps = 0;
+
+    /** @brief CLOCK_REALTIME minus CLOCK_MONOTONIC when last checked, the
+     *         difference of two offsets is the size of a jump */
+    std::chrono::microseconds offset{};
+
+    /** @brief Get CLOCK_REALTIME minus CLOCK_MONOTONIC */
+    static std::chrono::microseconds realtimeOffset();
+
+    /** @brief Initialize timerFd related resource */
+    void initialize();
+
+    /** @brief The callback function on system time change
+     *
+     * @param[in] es - Source of the event
+     * @param[in] fd - File descriptor of the timer
+     * @param[in] revents - Not used
+     * @param[in] userdata - User data pointer
+     */
+    static int onTimeChange(sd_event_source* es, int fd, uint32_t revents,
+                            void* userdata);
+
+    /** @brief The deleter of sd_event_source */
+    std::function<void(sd_event_source*)> sdEventSourceDeleter =
+        [](sd_event_source* p) {
+            if (p)
+            {
+                sd_event_source_unref(p);
+            }
+        };
+    using SdEventSource =
+        std::unique_ptr<sd_event_source, decltype(sdEventSourceDeleter)>;
+
+    /** @brief The event source on system time change */
+    SdEventSource timeChangeEventSource{nullptr, sdEventSourceDeleter};
+};
+
+/** @class SimulatedClock
+ *  @brief A clock that only moves when it is told to.
+ *  @details Days of drift and jumps are simulated in no time: advance()
+ *  is the regular passage of time, scaled by the drift and the frequency
+ *  correction, and jump() is a step made by someone else, e.g. an NTP
+ *  daemon. Jumps are notified synchronously. The discipline is only what
+ *  was set, setSynchronized() plays the part of the NTP daemon.
+ */
+class SimulatedClock : public Clock
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param[in] start - The initial time, microseconds since UTC
+     */
+    explicit SimulatedClock(std::chrono::microseconds start = defaultStart) :
+        time(start)
+    {}
+
+    std::chrono::microseconds now() const override
+    {
+        return time;
+    }
+
+    /** @brief Get the time passed by advance(), without drift */
+    std::chrono::microseconds monotonic() const override
+    {
+        return uptime;
+    }
+
+    utils::Expected<Discipline> discipline() const override
+    {
+        return state;
+    }
+
+    utils::Expected<void> setFrequency(double ppm) override
+    {
+        state.frequency = ppm;
+        return {};
+    }
+
+    /** @brief Set whether the clock is synchronized, as an NTP daemon does
+     *
+     * @param[in] synchronized - Whether the clock is synchronized
+     * @param[in] estError     - The estimated error to report
+     */
+    void setSynchronized(bool synchronized,
+                         std::chrono::microseconds estError = {})
+    {
+        state.synchronized = synchronized;
+        state.estError = estError;
+        state.maxError = estError;
+    }
+
+    /** @brief Step to the given time, or fail with the injected error */
+    utils::Expected<void> step(std::chrono::microseconds to) override;
+
+    /** @brief Step by delta, or fail with the injected error */
+    utils::Expected<void> stepBy(std::chrono::microseconds delta) override
+    {
+        return step(time + delta);
+    }
+
+    /** @brief Let the given time pass, scaled by the drift and the
+     *         frequency correction
+     *
+     * @param[in] elapsed - The time passed on a perfect clock
+     */
+    void advance(std::chrono::microseconds elapsed);
+
+    /** @brief Step the clock by delta from outside of the time manager
+     *
+     * @param[in] delta - The size of the step
+     */
+    void jump(std::chrono::microseconds delta);
+
+    /** @brief Set the drift of the clock
+     *
+     * @param[in] ppm - Parts per million the clock runs fast, negative if
+     *                  it runs slow
+     */
+    void setDrift(double ppm)
+    {
+        driftPpm = ppm;
+    }
+
+    /** @brief Make the following steps fail, or succeed again
+     *
+     * @param[in] error - The error to return, std::nullopt to succeed
+     */
+    void failSteps(std::optional<utils::Error> error)
+    {
+        stepError = std::move(error);
+    }
+
+    /** @brief Get the number of successful steps */
+    uint64_t steps() const
+    {
+        return stepCount;
+    }
+
+    /** @brief 2020-01-01T00:00:00Z */
+    static constexpr std::chrono::microseconds defaultStart{
+        1577836800000000};
+
+  private:
+    /** @brief The current time */
+    std::chrono::microseconds time;
+
+    /** @brief The time passed by advance() */
+    std::chrono::microseconds uptime{};
+
+    /** @brief The drift applied by advance() */
+    double driftPpm = 0;
+
+    /** @brief The discipline, its frequency is applied by advance() */
+    Discipline state;
+
+    /** @brief The drift in microseconds not applied yet */
+    double driftRemainder = 0;
+
+    /** @brief The error returned by step(), if any */
+    std::optional<utils::Error> stepError;
+
+    /** @brief The number of successful steps */
+    uint64_t stepCount = 0;
+};
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,162 @@
+#include "clock_source.hpp"
+
+#include "types.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto propertyName = "Name";
+constexpr auto propertyReadCost = "ReadCost";
+constexpr auto propertyCoarseElapsed = "CoarseElapsed";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+
+/** @brief The batches of reads measured, the cheapest one counts */
+constexpr size_t batches = 5;
+
+/** @brief The reads of a batch */
+constexpr size_t batchReads = 200;
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+ClockSource::ClockSource(sdbusplus::bus_t& bus, const char* objPath,
+                         TimeEvents& events, fs::path dir,
+                         ReadCoarse readCoarse) :
+    events(events), dir(std::move(dir)), readCoarse(std::move(readCoarse)),
+    interface(bus, objPath, clockSourceIntf, vtable, this)
+{
+    events.subscribe(*this);
+    refresh();
+}
+
+ClockSource::~ClockSource()
+{
+    events.unsubscribe(*this);
+}
+
+void ClockSource::refresh()
+{
+    auto newName = readName(dir);
+    auto newCost = measure(CLOCK_REALTIME);
+
+    bool wasSlow = (cost > slowReadCost);
+    bool renamed = (newName != sourceName);
+    if (renamed)
+    {
+        sourceName = std::move(newName);
+        interface.property_changed(propertyName);
+    }
+    if (newCost != cost)
+    {
+        cost = newCost;
+        interface.property_changed(propertyReadCost);
+    }
+
+    // Warned once as the reads turn slow, not as the cost of a slow
+    // clocksource varies
+    if (cost > slowReadCost && (renamed || !wasSlow))
+    {
+        warning("Reading the clock costs {COST}ns with clocksource {NAME}",
+                "COST", cost.count(), "NAME", sourceName);
+    }
+}
+
+void ClockSource::onEvent(const event::Jump& /* event */)
+{
+    refresh();
+}
+
+nanoseconds ClockSource::measure(clockid_t id)
+{
+    auto best = nanoseconds::max();
+    for (size_t batch = 0; batch < batches; ++batch)
+    {
+        timespec ts{};
+        auto start = steady_clock::now();
+        for (size_t i = 0; i < batchReads; ++i)
+        {
+            clock_gettime(id, &ts);
+        }
+        auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+        best = std::min<nanoseconds>(best, elapsed / batchReads);
+    }
+    return best;
+}
+
+std::string ClockSource::readName(const fs::path& dir)
+{
+    // There is one clocksource0 in practice, the order is only for a
+    // stable result
+    std::error_code ec;
+    std::vector<fs::path> sources;
+    for (const auto& entry : fs::directory_iterator(dir, ec))
+    {
+        sources.push_back(entry.path());
+    }
+    std::ranges::sort(sources);
+
+    for (const auto& source : sources)
+    {
+        std::ifstream file(source / "current_clocksource");
+        std::string name;
+        if (file && std::getline(file, name))
+        {
+            return name;
+        }
+    }
+    return {};
+}
+
+const sdbusplus::vtable_t ClockSource::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyName, "s", getName, emitsChange),
+    sdbusplus::vtable::property(propertyReadCost, "t", getReadCost,
+                                emitsChange),
+    sdbusplus::vtable::property(propertyCoarseElapsed, "t", getCoarseElapsed),
+    sdbusplus::vtable::end(),
+};
+
+int ClockSource::getName(sd_bus* /* bus */, const char* /* path */,
+                         const char* /* intf */, const char* /* property */,
+                         sd_bus_message* reply, void* userdata,
+                         sd_bus_error* /* error */)
+{
+    const auto* source = static_cast<const ClockSource*>(userdata);
+    return sd_bus_message_append(reply, "s", source->name().c_str());
+}
+
+int ClockSource::getReadCost(sd_bus* /* bus */, const char* /* path */,
+                             const char* /* intf */, const char* /* property */,
+                             sd_bus_message* reply, void* userdata,
+                             sd_bus_error* /* error */)
+{
+    const auto* source = static_cast<const ClockSource*>(userdata);
+    uint64_t cost = source->readCost().count();
+    return sd_bus_message_append(reply, "t", cost);
+}
+
+int ClockSource::getCoarseElapsed(sd_bus* /* bus */, const char* /* path */,
+                                  const char* /* intf */,
+                                  const char* /* property */,
+                                  sd_bus_message* reply, void* userdata,
+                                  sd_bus_error* /* error */)
+{
+    const auto* source = static_cast<const ClockSource*>(userdata);
+    uint64_t elapsed = source->coarseElapsed().count();
+    return sd_bus_message_append(reply, "t", elapsed);
+}
+
+} // namespace time
+} // namespace phosphor
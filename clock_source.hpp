@@ -0,0 +1,142 @@
+#pragma once
+
+#include "events.hpp"
+
+#include <time.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class ClockSource
+ *  @brief Check what reading the clock costs.
+ *  @details A read of Elapsed is a clock_gettime(), a vDSO call as long as
+ *  the kernel clocksource can be read from user space. When the kernel
+ *  falls back to a slow clocksource, every read becomes a syscall or a
+ *  slow MMIO access. The cost of clock_gettime(CLOCK_REALTIME) is measured
+ *  at startup and after every jump of the clock, as the lowest average of
+ *  a few batches of reads, so a preemption does not inflate it, along with
+ *  the name of the current clocksource.
+ *
+ *  The result is published as xyz.openbmc_project.Time.Manager.ClockSource:
+ *  - Name s: the current clocksource, e.g. "arch_sys_counter"
+ *  - ReadCost t: the cost of a read in nanoseconds
+ *  - CoarseElapsed t: the time read from CLOCK_REALTIME_COARSE, in
+ *    microseconds since UTC, which is always cheap but only as precise as
+ *    a tick of the kernel. It is offered next to Elapsed for the readers
+ *    that do not need microseconds, so Elapsed stays precise for the
+ *    others.
+ */
+class ClockSource
+{
+  public:
+    /** @brief Read the coarse clock */
+    using ReadCoarse = std::function<std::chrono::microseconds()>;
+
+    /** @brief Constructor
+     *
+     * @param[in] bus       - The Dbus bus object
+     * @param[in] objPath   - The object to add the interface to
+     * @param[in] events    - The time events to subscribe to
+     * @param[in] dir       - The clocksource directory of sysfs
+     * @param[in] readCoarse - The function that reads the coarse clock
+     */
+    ClockSource(sdbusplus::bus_t& bus, const char* objPath, TimeEvents& events,
+                std::filesystem::path dir, ReadCoarse readCoarse);
+    ~ClockSource();
+
+    ClockSource(const ClockSource&) = delete;
+    ClockSource(ClockSource&&) = delete;
+    ClockSource& operator=(const ClockSource&) = delete;
+    ClockSource& operator=(ClockSource&&) = delete;
+
+    /** @brief Read the clocksource and measure the cost of a read */
+    void refresh();
+
+    /** @brief Measure again after the clock is stepped */
+    void onEvent(const event::Jump& event);
+
+    /** @brief Get the current clocksource, empty if it is unknown */
+    const std::string& name() const
+    {
+        return sourceName;
+    }
+
+    /** @brief Get the cost of a read at the last refresh */
+    std::chrono::nanoseconds readCost() const
+    {
+        return cost;
+    }
+
+    /** @brief Get the time read from the coarse clock */
+    std::chrono::microseconds coarseElapsed() const
+    {
+        return readCoarse();
+    }
+
+    /** @brief Measure the cost of clock_gettime()
+     *
+     * @param[in] id - The clock to read
+     *
+     * @return The lowest average cost of a read of the batches
+     */
+    static std::chrono::nanoseconds measure(clockid_t id);
+
+    /** @brief Read the current clocksource
+     *
+     * @param[in] dir - The clocksource directory of sysfs
+     *
+     * @return The name in the first current_clocksource found, empty if
+     *         there is none
+     */
+    static std::string readName(const std::filesystem::path& dir);
+
+    /** @brief A read costing more is not served by the vDSO */
+    static constexpr std::chrono::nanoseconds slowReadCost{1000};
+
+  private:
+    /** @brief The time events subscribed to */
+    TimeEvents& events;
+
+    /** @brief The clocksource directory of sysfs */
+    std::filesystem::path dir;
+
+    /** @brief The function that reads the coarse clock */
+    ReadCoarse readCoarse;
+
+    /** @brief The current clocksource */
+    std::string sourceName;
+
+    /** @brief The cost of a read at the last refresh */
+    std::chrono::nanoseconds cost{};
+
+    /** @brief The ClockSource interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the ClockSource interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    static int getName(sd_bus* bus, const char* path, const char* intf,
+                       const char* property, sd_bus_message* reply,
+                       void* userdata, sd_bus_error* error);
+    static int getReadCost(sd_bus* bus, const char* path, const char* intf,
+                           const char* property, sd_bus_message* reply,
+                           void* userdata, sd_bus_error* error);
+    static int getCoarseElapsed(sd_bus* bus, const char* path,
+                                const char* intf, const char* property,
+                                sd_bus_message* reply, void* userdata,
+                                sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,94 @@
+#include "event_timer.hpp"
+
+#include <time.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+namespace phosphor
+{
+namespace time
+{
+
+PHOSPHOR_LOG2_USING;
+
+using namespace std::chrono;
+
+EventTimer::EventTimer(sd_event* event, clockid_t clock, Callback callback,
+                       microseconds accuracy) :
+    clock(clock), callback(std::move(callback))
+{
+    if (event == nullptr)
+    {
+        return;
+    }
+
+    sd_event_source* es = nullptr;
+    auto r = sd_event_add_time(event, &es, clock, UINT64_MAX,
+                               accuracy.count(), onExpired, this);
+    if (r < 0)
+    {
+        error("Failed to add timer: {ERRNO}", "ERRNO", -r);
+        return;
+    }
+    sd_event_source_set_enabled(es, SD_EVENT_OFF);
+    eventSource.reset(es);
+}
+
+bool EventTimer::armRelative(microseconds duration)
+{
+    return armAbsolute(now() + duration);
+}
+
+bool EventTimer::armAbsolute(microseconds deadline)
+{
+    if (!eventSource)
+    {
+        return false;
+    }
+
+    auto r = sd_event_source_set_time(eventSource.get(), deadline.count());
+    if (r < 0)
+    {
+        error("Failed to set timer: {ERRNO}", "ERRNO", -r);
+        return false;
+    }
+    r = sd_event_source_set_enabled(eventSource.get(), SD_EVENT_ONESHOT);
+    return r >= 0;
+}
+
+void EventTimer::disarm()
+{
+    if (eventSource)
+    {
+        sd_event_source_set_enabled(eventSource.get(), SD_EVENT_OFF);
+    }
+}
+
+bool EventTimer::isArmed() const
+{
+    int enabled = SD_EVENT_OFF;
+    if (eventSource)
+    {
+        sd_event_source_get_enabled(eventSource.get(), &enabled);
+    }
+    return enabled != SD_EVENT_OFF;
+}
+
+microseconds EventTimer::now() const
+{
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return duration_cast<microseconds>(seconds(ts.tv_sec) +
+                                       nanoseconds(ts.tv_nsec));
+}
+
+int EventTimer::onExpired(sd_event_source* /* es */, uint64_t /* usec */,
+                          void* userdata)
+{
+    auto* timer = static_cast<EventTimer*>(userdata);
+    timer->callback();
+    return 0;
+}
+
+} // namespace time
+} // namespace phosphor
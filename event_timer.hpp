@@ -0,0 +1,96 @@
+#pragma once
+
+#include <systemd/sd-event.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class EventTimer
+ *  @brief A one shot timer on the sd_event loop.
+ *  @details The event source is created once and only re-armed afterwards,
+ *  so arming the timer does not allocate. Without an event loop the timer
+ *  is inert and arm() returns false.
+ */
+class EventTimer
+{
+  public:
+    using Callback = std::function<void()>;
+
+    /** @brief Constructor
+     *
+     * @param[in] event    - The event loop, may be nullptr
+     * @param[in] clock    - The clock of the timer, e.g. CLOCK_MONOTONIC
+     * @param[in] callback - The function called when the timer expires
+     * @param[in] accuracy - The accuracy of the timer, 0 for sd_event's
+     *                       default
+     */
+    EventTimer(sd_event* event, clockid_t clock, Callback callback,
+               std::chrono::microseconds accuracy = {});
+    ~EventTimer() = default;
+
+    EventTimer(const EventTimer&) = delete;
+    EventTimer(EventTimer&&) = delete;
+    EventTimer& operator=(const EventTimer&) = delete;
+    EventTimer& operator=(EventTimer&&) = delete;
+
+    /** @brief Arm the timer to expire after the given duration
+     *
+     * @param[in] duration - The time from now until expiry
+     *
+     * @return true if the timer is armed
+     */
+    bool armRelative(std::chrono::microseconds duration);
+
+    /** @brief Arm the timer to expire at the given time of its clock
+     *
+     * @param[in] deadline - The absolute time on the clock of the timer
+     *
+     * @return true if the timer is armed
+     */
+    bool armAbsolute(std::chrono::microseconds deadline);
+
+    /** @brief Disarm the timer */
+    void disarm();
+
+    /** @brief Whether the timer is armed */
+    bool isArmed() const;
+
+    /** @brief Get the current time of the clock of the timer
+     *
+     * @return The time since the epoch of the clock
+     */
+    std::chrono::microseconds now() const;
+
+  private:
+    /** @brief The clock of the timer */
+    clockid_t clock;
+
+    /** @brief The function called when the timer expires */
+    Callback callback;
+
+    /** @brief The callback of the sd_event time source */
+    static int onExpired(sd_event_source* es, uint64_t usec, void* userdata);
+
+    /** @brief The deleter of sd_event_source */
+    std::function<void(sd_event_source*)> sdEventSourceDeleter =
+        [](sd_event_source* p) {
+            if (p)
+            {
+                sd_event_source_unref(p);
+            }
+        };
+    using SdEventSource =
+        std::unique_ptr<sd_event_source, decltype(sdEventSourceDeleter)>;
+
+    /** @brief The time event source */
+    SdEventSource eventSource{nullptr, sdEventSourceDeleter};
+};
+
+} // namespace time
+} // namespace phosphor
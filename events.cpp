@@ -0,0 +1,37 @@
+#include "events.hpp"
+
+#include "bmc_epoch.hpp"
+#include "clock_source.hpp"
+#include "holdover.hpp"
+#include "jump_notifier.hpp"
+#include "ptp_sync.hpp"
+#include "rtc_monitor.hpp"
+#include "time_zone.hpp"
+
+namespace phosphor
+{
+namespace time
+{
+
+void TimeEvents::publish(const event::Jump& event) const
+{
+    EventBus::publish(event);
+}
+
+void TimeEvents::publish(const event::ModeChanged& event) const
+{
+    EventBus::publish(event);
+}
+
+void TimeEvents::publish(const event::SyncStatus& event) const
+{
+    EventBus::publish(event);
+}
+
+void TimeEvents::publish(const event::Timezone& event) const
+{
+    EventBus::publish(event);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <chrono>
+#include <string>
+#include <tuple>
+
+namespace phosphor
+{
+namespace time
+{
+namespace event
+{
+
+/** @brief The clock is stepped, by us or by anyone else */
+struct Jump
+{
+    /** @brief The size of the step */
+    std::chrono::microseconds delta;
+
+    /** @brief Whether the step was made by this daemon through SetTime */
+    bool own = false;
+};
+
+/** @brief The time mode is changed */
+struct ModeChanged
+{
+    /** @brief The new time mode */
+    Mode mode;
+};
+
+/** @brief systemd time service reports the NTP sync is gained or lost */
+struct SyncStatus
+{
+    /** @brief Whether the clock is synchronized by NTP */
+    bool synchronized;
+};
+
+/** @brief systemd time service reports the time zone */
+struct Timezone
+{
+    /** @brief The zone name, e.g. "Europe/Berlin" */
+    std::string name;
+};
+
+} // namespace event
+
+/** @class EventBus
+ *  @brief Publish typed time events to a fixed set of listeners.
+ *  @details The listener types are given at compile time, and an event is
+ *  delivered to every listener with an onEvent() overload taking it, by a
+ *  direct call. A listener that does not handle the event type costs
+ *  nothing. At most one object of each listener type is subscribed at a
+ *  time, and it must unsubscribe before it is destroyed.
+ *
+ *  The listener types must be complete where publish() is called.
+ */
+template <typename... Listeners>
+class EventBus
+{
+  public:
+    /** @brief Deliver the events to a listener from now on */
+    template <typename Listener>
+    void subscribe(Listener& listener)
+    {
+        std::get<Listener*>(listeners) = &listener;
+    }
+
+    /** @brief Stop delivering the events to a listener */
+    template <typename Listener>
+    void unsubscribe(Listener& listener)
+    {
+        auto& slot = std::get<Listener*>(listeners);
+        if (slot == &listener)
+        {
+            slot = nullptr;
+        }
+    }
+
+    /** @brief Deliver an event to the subscribed listeners handling it,
+     *         in the order of the listener types */
+    template <typename Event>
+    void publish(const Event& event) const
+    {
+        std::apply([&](auto*... listener) { (deliver(listener, event), ...); },
+                   listeners);
+    }
+
+  private:
+    /** @brief The subscribed object of each listener type, if any */
+    std::tuple<Listeners*...> listeners{};
+
+    template <typename Listener, typename Event>
+    static void deliver(Listener* listener, const Event& event)
+    {
+        if constexpr (requires { listener->onEvent(event); })
+        {
+            if (listener)
+            {
+                listener->onEvent(event);
+            }
+        }
+    }
+};
+
+class BmcEpoch;
+class ClockSource;
+class Holdover;
+class JumpNotifier;
+class PtpSync;
+class RtcMonitor;
+class TimeZone;
+
+/** @class TimeEvents
+ *  @brief The events of the time manager and its components.
+ *  @details The publish() overloads are defined where all listeners are
+ *  complete, so the publishers only need this header. A new listener is
+ *  added to the base class and its header to events.cpp. JumpNotifier is
+ *  last, so its clients are told of a jump once the others processed it.
+ */
+class TimeEvents :
+    public EventBus<Holdover, BmcEpoch, TimeZone, RtcMonitor, ClockSource,
+                    PtpSync, JumpNotifier>
+{
+  public:
+    void publish(const event::Jump& event) const;
+    void publish(const event::ModeChanged& event) const;
+    void publish(const event::SyncStatus& event) const;
+    void publish(const event::Timezone& event) const;
+};
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,245 @@
+#include "holdover.hpp"
+
+#include "types.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cmath>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto propertyActive = "Active";
+constexpr auto propertyFrequency = "Frequency";
+constexpr auto propertySamples = "Samples";
+constexpr auto propertyEstimatedError = "EstimatedError";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+using namespace std::chrono;
+
+Holdover::Holdover(sdbusplus::bus_t& bus, const char* objPath, Clock& clock,
+                   TimeEvents& events, seconds maxAge) :
+    clock(clock), events(events), maxAge(maxAge),
+    timer(bus.get_event(), CLOCK_BOOTTIME,
+          [this]() {
+              sample();
+              timer.armRelative(sampleInterval);
+          },
+          seconds(1)),
+    interface(bus, objPath, holdoverIntf, vtable, this)
+{
+    events.subscribe(*this);
+}
+
+Holdover::~Holdover()
+{
+    events.unsubscribe(*this);
+}
+
+void Holdover::setNtpMode(bool ntp)
+{
+    if (maxAge.count() == 0 || ntp == ntpMode)
+    {
+        return;
+    }
+
+    ntpMode = ntp;
+    if (ntp)
+    {
+        timer.armRelative(sampleInterval);
+    }
+    else
+    {
+        // The time is set by hand from now on, the learned frequency is
+        // kept until it is too old to be held.
+        timer.disarm();
+        setActive(false);
+    }
+}
+
+void Holdover::onEvent(const event::ModeChanged& event)
+{
+    setNtpMode(Mode::NTP == event.mode);
+}
+
+void Holdover::onEvent(const event::SyncStatus& /* event */)
+{
+    sample();
+}
+
+void Holdover::sample()
+{
+    if (!ntpMode)
+    {
+        return;
+    }
+
+    auto d = clock.discipline();
+    if (!d)
+    {
+        error("Failed to sample the clock discipline: {ERROR}", "ERROR",
+              d.error().message);
+        return;
+    }
+
+    if (d->synchronized)
+    {
+        learn(*d);
+    }
+    else
+    {
+        hold(*d);
+    }
+}
+
+void Holdover::learn(const Discipline& d)
+{
+    if (active)
+    {
+        info("NTP sync is back, end holdover after {SECONDS}s", "SECONDS",
+             duration_cast<seconds>(clock.monotonic() - lastSynced).count());
+        setActive(false);
+    }
+
+    if (count == 0)
+    {
+        mean = d.frequency;
+        variance = 0;
+    }
+    else
+    {
+        auto diff = d.frequency - mean;
+        mean += sampleWeight * diff;
+        variance = (1 - sampleWeight) * (variance + sampleWeight * diff * diff);
+    }
+    ++count;
+    lastSynced = clock.monotonic();
+    lastError = d.estError;
+}
+
+void Holdover::hold(const Discipline& d)
+{
+    if (count < minSamples)
+    {
+        return;
+    }
+
+    if (clock.monotonic() - lastSynced > maxAge)
+    {
+        warning("NTP sync lost for too long, stop holding {FREQUENCY}ppm",
+                "FREQUENCY", mean);
+        setActive(false);
+        reset();
+        return;
+    }
+
+    if (!active)
+    {
+        info("NTP sync lost, hold {FREQUENCY}ppm learned from {SAMPLES} "
+             "samples",
+             "FREQUENCY", mean, "SAMPLES", count);
+        setActive(true);
+    }
+
+    if (std::abs(d.frequency - mean) > tolerance)
+    {
+        auto result = clock.setFrequency(mean);
+        if (!result)
+        {
+            error("Failed to hold the frequency: {ERROR}", "ERROR",
+                  result.error().message);
+        }
+    }
+}
+
+void Holdover::reset()
+{
+    mean = 0;
+    variance = 0;
+    count = 0;
+}
+
+void Holdover::setActive(bool value)
+{
+    if (active != value)
+    {
+        active = value;
+        interface.property_changed(propertyActive);
+    }
+}
+
+microseconds Holdover::estimatedError() const
+{
+    if (!active)
+    {
+        auto d = clock.discipline();
+        if (!d)
+        {
+            return {};
+        }
+        return d->synchronized ? d->estError : d->maxError;
+    }
+
+    // ppm times seconds is microseconds
+    auto age = duration<double>(clock.monotonic() - lastSynced).count();
+    auto spread = std::sqrt(variance) * age;
+    auto aging = 0.5 * agingPerDay / 86400 * age * age;
+    return lastError + microseconds(std::llround(spread + aging));
+}
+
+const sdbusplus::vtable_t Holdover::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyActive, "b", getActive, emitsChange),
+    sdbusplus::vtable::property(propertyFrequency, "d", getFrequency),
+    sdbusplus::vtable::property(propertySamples, "t", getSamples),
+    sdbusplus::vtable::property(propertyEstimatedError, "t",
+                                getEstimatedError),
+    sdbusplus::vtable::end(),
+};
+
+int Holdover::getActive(sd_bus* /* bus */, const char* /* path */,
+                        const char* /* intf */, const char* /* property */,
+                        sd_bus_message* reply, void* userdata,
+                        sd_bus_error* /* error */)
+{
+    const auto* holdover = static_cast<const Holdover*>(userdata);
+    return sd_bus_message_append(reply, "b", holdover->isActive());
+}
+
+int Holdover::getFrequency(sd_bus* /* bus */, const char* /* path */,
+                           const char* /* intf */, const char* /* property */,
+                           sd_bus_message* reply, void* userdata,
+                           sd_bus_error* /* error */)
+{
+    const auto* holdover = static_cast<const Holdover*>(userdata);
+    return sd_bus_message_append(reply, "d", holdover->frequency());
+}
+
+int Holdover::getSamples(sd_bus* /* bus */, const char* /* path */,
+                         const char* /* intf */, const char* /* property */,
+                         sd_bus_message* reply, void* userdata,
+                         sd_bus_error* /* error */)
+{
+    const auto* holdover = static_cast<const Holdover*>(userdata);
+    return sd_bus_message_append(reply, "t", holdover->samples());
+}
+
+int Holdover::getEstimatedError(sd_bus* /* bus */, const char* /* path */,
+                                const char* /* intf */,
+                                const char* /* property */,
+                                sd_bus_message* reply, void* userdata,
+                                sd_bus_error* /* error */)
+{
+    const auto* holdover = static_cast<const Holdover*>(userdata);
+    uint64_t usec = holdover->estimatedError().count();
+    return sd_bus_message_append(reply, "t", usec);
+}
+
+} // namespace time
+} // namespace phosphor
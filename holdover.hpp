@@ -0,0 +1,187 @@
+#pragma once
+
+#include "clock.hpp"
+#include "event_timer.hpp"
+#include "events.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class Holdover
+ *  @brief Keep the clock on frequency while NTP is unavailable.
+ *  @details In NTP mode the frequency correction of the kernel is sampled
+ *  while the NTP daemon keeps the clock synchronized. Once the sync is
+ *  lost, the learned frequency is applied again whenever the kernel's
+ *  differs from it, so the clock does not free-run with the frequency
+ *  error of the crystal. The holdover ends when the sync returns, when
+ *  NTP mode is left, or when the learned frequency is older than the
+ *  maximum age, and the learning then starts over. The time mode and the
+ *  sync status come as time events.
+ *
+ *  The state is published as xyz.openbmc_project.Time.Manager.Holdover:
+ *  - Active: whether the learned frequency is being held
+ *  - Frequency: the learned frequency in ppm
+ *  - Samples: the synchronized samples it is learned from
+ *  - EstimatedError: the error of the clock in microseconds, as reported
+ *    by the NTP daemon while synchronized, or estimated from the error at
+ *    the loss of sync, the spread of the samples and aging during holdover
+ */
+class Holdover
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param[in] bus     - The Dbus bus object
+     * @param[in] objPath - The object to add the interface to
+     * @param[in] clock   - The clock to sample and correct
+     * @param[in] events  - The time events to subscribe to
+     * @param[in] maxAge  - How long the learned frequency is held, 0 to
+     *                      disable holdover
+     */
+    Holdover(sdbusplus::bus_t& bus, const char* objPath, Clock& clock,
+             TimeEvents& events, std::chrono::seconds maxAge);
+    ~Holdover();
+
+    Holdover(const Holdover&) = delete;
+    Holdover(Holdover&&) = delete;
+    Holdover& operator=(const Holdover&) = delete;
+    Holdover& operator=(Holdover&&) = delete;
+
+    /** @brief Enable the sampling in NTP mode, disable it otherwise
+     *
+     * @param[in] ntp - Whether the time mode is NTP
+     */
+    void setNtpMode(bool ntp);
+
+    /** @brief Follow the time mode */
+    void onEvent(const event::ModeChanged& event);
+
+    /** @brief Sample at once when the NTP sync is gained or lost, rather
+     *         than at the next sample */
+    void onEvent(const event::SyncStatus& event);
+
+    /** @brief Take one sample of the discipline and act on it, called by
+     *         the sample timer */
+    void sample();
+
+    /** @brief Whether the learned frequency is being held */
+    bool isActive() const
+    {
+        return active;
+    }
+
+    /** @brief Whether the discipline is sampled, i.e. the time mode is NTP
+     *         and holdover is enabled, be it learning or holding */
+    bool isSampling() const
+    {
+        return ntpMode;
+    }
+
+    /** @brief Get the learned frequency in ppm */
+    double frequency() const
+    {
+        return mean;
+    }
+
+    /** @brief Get the number of samples the frequency is learned from */
+    uint64_t samples() const
+    {
+        return count;
+    }
+
+    /** @brief Get the estimated error of the clock */
+    std::chrono::microseconds estimatedError() const;
+
+    /** @brief The interval of the samples */
+    static constexpr std::chrono::seconds sampleInterval{64};
+
+    /** @brief The samples needed before the frequency is held */
+    static constexpr uint64_t minSamples = 8;
+
+    /** @brief The weight of a new sample in the learned frequency */
+    static constexpr double sampleWeight = 1.0 / 8;
+
+    /** @brief The difference to the learned frequency that is corrected */
+    static constexpr double tolerance = 0.01;
+
+    /** @brief The assumed aging of the crystal, in ppm per day */
+    static constexpr double agingPerDay = 0.1;
+
+  private:
+    /** @brief The clock to sample and correct */
+    Clock& clock;
+
+    /** @brief The time events subscribed to */
+    TimeEvents& events;
+
+    /** @brief How long the learned frequency is held */
+    std::chrono::microseconds maxAge;
+
+    /** @brief Whether the time mode is NTP */
+    bool ntpMode = false;
+
+    /** @brief Whether the learned frequency is being held */
+    bool active = false;
+
+    /** @brief The learned frequency, an exponential moving average */
+    double mean = 0;
+
+    /** @brief The moving variance of the samples */
+    double variance = 0;
+
+    /** @brief The number of synchronized samples */
+    uint64_t count = 0;
+
+    /** @brief The monotonic time of the last synchronized sample */
+    std::chrono::microseconds lastSynced{};
+
+    /** @brief The error reported by the NTP daemon at the last
+     *         synchronized sample */
+    std::chrono::microseconds lastError{};
+
+    /** @brief The timer of the samples */
+    EventTimer timer;
+
+    /** @brief The Holdover interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the Holdover interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Learn from a synchronized sample */
+    void learn(const Discipline& d);
+
+    /** @brief Hold the learned frequency on an unsynchronized sample */
+    void hold(const Discipline& d);
+
+    /** @brief Forget the learned frequency */
+    void reset();
+
+    /** @brief Start or end the holdover */
+    void setActive(bool value);
+
+    static int getActive(sd_bus* bus, const char* path, const char* intf,
+                         const char* property, sd_bus_message* reply,
+                         void* userdata, sd_bus_error* error);
+    static int getFrequency(sd_bus* bus, const char* path, const char* intf,
+                            const char* property, sd_bus_message* reply,
+                            void* userdata, sd_bus_error* error);
+    static int getSamples(sd_bus* bus, const char* path, const char* intf,
+                          const char* property, sd_bus_message* reply,
+                          void* userdata, sd_bus_error* error);
+    static int getEstimatedError(sd_bus* bus, const char* path,
+                                 const char* intf, const char* property,
+                                 sd_bus_message* reply, void* userdata,
+                                 sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
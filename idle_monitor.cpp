@@ -0,0 +1,66 @@
+#include "idle_monitor.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+namespace phosphor
+{
+namespace time
+{
+
+PHOSPHOR_LOG2_USING;
+
+IdleMonitor::IdleMonitor(sdbusplus::bus_t& bus, std::chrono::seconds timeout,
+                         Callback onIdle) :
+    timeout(timeout), onIdle(std::move(onIdle)),
+    timer(bus.get_event(), CLOCK_MONOTONIC, [this]() { onTimeout(); },
+          std::chrono::seconds(1))
+{
+    // Without the count of the messages a busy daemon would look idle
+    if (watch(bus))
+    {
+        timer.armRelative(timeout);
+    }
+}
+
+bool IdleMonitor::watch(sdbusplus::bus_t& other)
+{
+    sd_bus_slot* slot = nullptr;
+    auto r = sd_bus_add_filter(other.get(), &slot, onMessage, this);
+    if (r < 0)
+    {
+        error("Failed to add bus filter: {ERRNO}", "ERRNO", -r);
+        return false;
+    }
+    filterSlots.emplace_back(slot, sdBusSlotDeleter);
+    return true;
+}
+
+void IdleMonitor::onTimeout()
+{
+    if (activity != lastActivity)
+    {
+        lastActivity = activity;
+        timer.armRelative(timeout);
+        return;
+    }
+
+    info("No activity for {SECONDS}s", "SECONDS", timeout.count());
+    timer.armRelative(timeout);
+    onIdle();
+}
+
+int IdleMonitor::onMessage(sd_bus_message* msg, void* userData,
+                           sd_bus_error* /* retError */)
+{
+    auto* self = static_cast<IdleMonitor*>(userData);
+    if (!self->repeated || !self->repeated(msg))
+    {
+        self->touch();
+    }
+
+    // Let the message be processed as usual
+    return 0;
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "event_timer.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class IdleMonitor
+ *  @brief Detect a quiet period without any incoming D-Bus message.
+ *  @details A bus filter counts every message delivered to the daemon, i.e.
+ *  Gets, Sets and the subscribed settings and timedate signals. A timer
+ *  checks the count once per timeout, so recording activity costs a single
+ *  increment. The daemon is treated as idle when a whole timeout has passed
+ *  without any message.
+ */
+class IdleMonitor
+{
+  public:
+    using Callback = std::function<void()>;
+    using Repeated = std::function<bool(sd_bus_message*)>;
+
+    /** @brief Constructor
+     *
+     * @param[in] bus     - The Dbus bus object, attached to an event loop
+     * @param[in] timeout - The quiet period after which onIdle is called
+     * @param[in] onIdle  - The function called once the daemon is idle, it
+     *                      is called again after the next quiet period if
+     *                      the daemon stays
+     */
+    IdleMonitor(sdbusplus::bus_t& bus, std::chrono::seconds timeout,
+                Callback onIdle);
+    ~IdleMonitor() = default;
+
+    IdleMonitor(const IdleMonitor&) = delete;
+    IdleMonitor(IdleMonitor&&) = delete;
+    IdleMonitor& operator=(const IdleMonitor&) = delete;
+    IdleMonitor& operator=(IdleMonitor&&) = delete;
+
+    /** @brief Count the messages of another connection as well
+     *
+     * @param[in] other - The connection, e.g. the one of the signals
+     *
+     * @return Whether its messages are counted
+     */
+    bool watch(sdbusplus::bus_t& other);
+
+    /** @brief Count a message seen twice by the filters only once
+     *
+     * @param[in] isRepeated - Whether a message is seen a second time, e.g.
+     *                         a read put back by the ReadQueue
+     */
+    void skipRepeated(Repeated isRepeated)
+    {
+        repeated = std::move(isRepeated);
+    }
+
+    /** @brief Record activity that does not arrive as a D-Bus message */
+    void touch()
+    {
+        ++activity;
+    }
+
+  private:
+    /** @brief The quiet period */
+    std::chrono::seconds timeout;
+
+    /** @brief The function called once the daemon is idle */
+    Callback onIdle;
+
+    /** @brief Whether a message is seen a second time */
+    Repeated repeated;
+
+    /** @brief The number of messages seen so far */
+    uint64_t activity = 0;
+
+    /** @brief The number of messages seen at the last check */
+    uint64_t lastActivity = 0;
+
+    /** @brief The deleter of sd_bus_slot */
+    std::function<void(sd_bus_slot*)> sdBusSlotDeleter = [](sd_bus_slot* p) {
+        if (p)
+        {
+            sd_bus_slot_unref(p);
+        }
+    };
+    using SdBusSlot = std::unique_ptr<sd_bus_slot, decltype(sdBusSlotDeleter)>;
+
+    /** @brief The slots of the bus filters */
+    std::vector<SdBusSlot> filterSlots;
+
+    /** @brief The timer to check the activity */
+    EventTimer timer;
+
+    /** @brief Called on each timeout to check the activity */
+    void onTimeout();
+
+    /** @brief The bus filter called for every incoming message
+     *
+     * @param[in] msg - The incoming message
+     * @param[in] userData - Pointer to this object instance
+     * @param[out] retError  - Not used but required with filter API
+     */
+    static int onMessage(sd_bus_message* msg, void* userData,
+                         sd_bus_error* retError);
+};
+
+} // namespace time
+} // namespace phosphor
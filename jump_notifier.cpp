@@ -0,0 +1,180 @@
+#include "jump_notifier.hpp"
+
+#include "types.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto methodNameSubscribe = "Subscribe";
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+namespace common = sdbusplus::xyz::openbmc_project::Common::Error;
+
+static_assert(sizeof(JumpNotifier::Record) == 16,
+              "The record is read by other processes");
+
+JumpNotifier::JumpNotifier(sdbusplus::bus_t& bus, const char* objPath,
+                           TimeEvents& events) :
+    events(events),
+    ownerMatch(bus,
+               sdbusplus::bus::match::rules::nameOwnerChanged() +
+                   sdbusplus::bus::match::rules::argN(2, ""),
+               [this](sdbusplus::message_t& m) {
+                   std::string name;
+                   std::string oldOwner;
+                   std::string newOwner;
+                   m.read(name, oldOwner, newOwner);
+                   // Every name leaving the bus is seen, a name without
+                   // clients drops nothing
+                   if (newOwner.empty())
+                   {
+                       release(name);
+                   }
+               }),
+    interface(bus, objPath, jumpNotifierIntf, vtable, this)
+{
+    events.subscribe(*this);
+}
+
+JumpNotifier::~JumpNotifier()
+{
+    events.unsubscribe(*this);
+    for (const auto& subscriber : subscribers)
+    {
+        close(subscriber.fd);
+    }
+}
+
+utils::Expected<int> JumpNotifier::subscribe(const std::string& owner)
+{
+    auto full = [&]() {
+        return subscribers.size() >= maxClients ||
+               (!owner.empty() && clientsOf(owner) >= maxClientsPerOwner);
+    };
+    if (full())
+    {
+        dropClosed();
+    }
+    if (subscribers.size() >= maxClients)
+    {
+        return std::unexpected(
+            utils::Error{-EMFILE, common::TooManyResources().name(),
+                         "Too many clients are subscribed to the jumps"});
+    }
+    if (full())
+    {
+        return std::unexpected(utils::Error{
+            -EMFILE, common::TooManyResources().name(),
+            "The client holds too many subscriptions to the jumps"});
+    }
+
+    int pair[2] = {-1, -1};
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) < 0)
+    {
+        auto e = errno;
+        return std::unexpected(utils::Error{
+            -e, common::InternalFailure().name(),
+            std::string("socketpair: ") + std::strerror(e)});
+    }
+
+    // The client only reads, our end only sends
+    shutdown(pair[0], SHUT_RD);
+    shutdown(pair[1], SHUT_WR);
+    subscribers.push_back({pair[0], owner});
+    return pair[1];
+}
+
+void JumpNotifier::release(std::string_view owner)
+{
+    std::erase_if(subscribers, [&](const Subscriber& subscriber) {
+        if (subscriber.owner != owner)
+        {
+            return false;
+        }
+        close(subscriber.fd);
+        return true;
+    });
+}
+
+void JumpNotifier::onEvent(const event::Jump& event)
+{
+    Record record{event.delta.count(), ++sequence};
+    std::erase_if(subscribers, [&](const Subscriber& subscriber) {
+        auto fd = subscriber.fd;
+        if (send(fd, &record, sizeof(record), MSG_DONTWAIT | MSG_NOSIGNAL) >=
+                0 ||
+            errno == EAGAIN)
+        {
+            // A client with a full queue misses this jump but stays
+            return false;
+        }
+        close(fd);
+        return true;
+    });
+}
+
+void JumpNotifier::dropClosed()
+{
+    std::erase_if(subscribers, [](const Subscriber& subscriber) {
+        pollfd p{subscriber.fd, 0, 0};
+        if (poll(&p, 1, 0) > 0 && (p.revents & (POLLHUP | POLLERR)))
+        {
+            close(subscriber.fd);
+            return true;
+        }
+        return false;
+    });
+}
+
+size_t JumpNotifier::clientsOf(std::string_view owner) const
+{
+    return std::ranges::count_if(subscribers, [&](const Subscriber& s) {
+        return s.owner == owner;
+    });
+}
+
+const sdbusplus::vtable_t JumpNotifier::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method(methodNameSubscribe, "", "h", methodSubscribe),
+    sdbusplus::vtable::end(),
+};
+
+int JumpNotifier::methodSubscribe(sd_bus_message* msg, void* userdata,
+                                  sd_bus_error* error)
+{
+    auto* notifier = static_cast<JumpNotifier*>(userdata);
+
+    const auto* sender = sd_bus_message_get_sender(msg);
+    auto fd = notifier->subscribe(sender ? sender : "");
+    if (!fd)
+    {
+        warning("Failed to subscribe to the jumps: {ERROR}", "ERROR",
+                fd.error().message);
+        return sd_bus_error_set(error, fd.error().name.c_str(),
+                                fd.error().message.c_str());
+    }
+
+    // The reply holds a duplicate of the fd
+    auto r = sd_bus_reply_method_return(msg, "h", *fd);
+    close(*fd);
+    return r;
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "events.hpp"
+#include "utils.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class JumpNotifier
+ *  @brief Notify the jumps of the clock through file descriptors.
+ *  @details Rather than each creating a TFD_TIMER_CANCEL_ON_SET timerfd,
+ *  or waking the broker with a signal on each jump, a client subscribes
+ *  once and waits on the returned fd in its own event loop. It becomes
+ *  readable after the time manager has processed a jump, and each read
+ *  returns one Record.
+ *
+ *  The fd is a SOCK_SEQPACKET socket rather than an eventfd, since an
+ *  eventfd can only carry a counter and not the delta. The records are
+ *  sent without blocking: a client that does not read for a long time
+ *  misses jumps, and one that closes its fd is dropped on the next jump.
+ *  A subscription also ends when the connection of the client leaves the
+ *  bus, so a client that exits without closing its fd, e.g. because it
+ *  handed the fd on, does not keep the daemon from its idle exit. The
+ *  names leaving the bus are watched by one match added at startup, so a
+ *  Subscribe() does not wait for the broker to add one.
+ *
+ *  A connection may hold maxClientsPerOwner of the maxClients
+ *  subscriptions, so a single client cannot take all of them.
+ *
+ *  The fds are handed out by Subscribe() -> h of
+ *  xyz.openbmc_project.Time.Manager.JumpNotifier.
+ */
+class JumpNotifier
+{
+  public:
+    /** @brief What a client reads for a jump */
+    struct Record
+    {
+        /** @brief The size of the jump in microseconds */
+        int64_t delta;
+
+        /** @brief The number of the jump, a gap tells a client it missed
+         *         some */
+        uint64_t sequence;
+    };
+
+    /** @brief Constructor
+     *
+     * @param[in] bus     - The Dbus bus object
+     * @param[in] objPath - The object to add the interface to
+     * @param[in] events  - The time events to subscribe to
+     */
+    JumpNotifier(sdbusplus::bus_t& bus, const char* objPath,
+                 TimeEvents& events);
+    ~JumpNotifier();
+
+    JumpNotifier(const JumpNotifier&) = delete;
+    JumpNotifier(JumpNotifier&&) = delete;
+    JumpNotifier& operator=(const JumpNotifier&) = delete;
+    JumpNotifier& operator=(JumpNotifier&&) = delete;
+
+    /** @brief Add a client
+     *
+     * @param[in] owner - The unique bus name of the client, its fd is
+     *                    dropped when the name leaves the bus, empty to
+     *                    keep it until the client closes it
+     *
+     * @return The fd of the client, owned by the caller, or the error
+     */
+    utils::Expected<int> subscribe(const std::string& owner = {});
+
+    /** @brief Drop the clients of a unique bus name that left the bus
+     *
+     * @param[in] owner - The unique bus name
+     */
+    void release(std::string_view owner);
+
+    /** @brief Send the jump to the clients */
+    void onEvent(const event::Jump& event);
+
+    /** @brief Get the number of clients that have not closed their fd */
+    size_t clients()
+    {
+        dropClosed();
+        return subscribers.size();
+    }
+
+    /** @brief The clients that may subscribe at once */
+    static constexpr size_t maxClients = 64;
+
+    /** @brief The subscriptions one unique bus name may hold at once */
+    static constexpr size_t maxClientsPerOwner = 8;
+
+  private:
+    /** @brief A subscribed client */
+    struct Subscriber
+    {
+        /** @brief Our end of the socket of the client */
+        int fd;
+
+        /** @brief The unique bus name of the client, if known */
+        std::string owner;
+    };
+
+    /** @brief The time events subscribed to */
+    TimeEvents& events;
+
+    /** @brief The subscribed clients */
+    std::vector<Subscriber> subscribers;
+
+    /** @brief The match of the names leaving the bus */
+    sdbusplus::bus::match_t ownerMatch;
+
+    /** @brief The number of the last jump */
+    uint64_t sequence = 0;
+
+    /** @brief The JumpNotifier interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the JumpNotifier interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Drop the clients that closed their fd */
+    void dropClosed();
+
+    /** @brief Get the number of clients of a unique bus name */
+    size_t clientsOf(std::string_view owner) const;
+
+    static int methodSubscribe(sd_bus_message* msg, void* userdata,
+                               sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
@@ -1,10 +1,25 @@
 #include "config.h"
 
 #include "bmc_epoch.hpp"
+#include "clock.hpp"
+#include "clock_source.hpp"
+#include "idle_monitor.hpp"
+#include "jump_notifier.hpp"
 #include "manager.hpp"
+#include "metrics_exporter.hpp"
+#include "persistent_state.hpp"
+#include "ptp_sync.hpp"
+#include "rtc_monitor.hpp"
+#include "scheduling.hpp"
+#include "time_zone.hpp"
 
 #include <sdbusplus/bus.hpp>
 
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
 int main()
 {
     auto bus = sdbusplus::bus::new_default();
@@ -19,20 +34,140 @@ int main()
     event = nullptr;
 
     // attach bus to this event loop
-    bus.attach_event(sdEvent.get(), SD_EVENT_PRIORITY_NORMAL);
+    bus.attach_event(sdEvent.get(), phosphor::time::priority::medium);
+
+    // The signals the mode sync follows arrive on a connection of their own,
+    // so a flood of calls queued on the bus does not hold them back
+    auto signalBus = phosphor::time::openSignalBus(sdEvent.get());
 
     // Add sdbusplus ObjectManager
     sdbusplus::server::manager_t bmcEpochObjManager(bus, objmgrpath);
 
-    phosphor::time::Manager manager(bus);
-    phosphor::time::BmcEpoch bmc(bus, objpathBmc, manager);
+    // Resume from the state of a previous idle exit, it is consumed here so
+    // that a crash later on does not start from a stale state.
+    constexpr std::chrono::seconds idleExitTimeout(IDLE_EXIT_TIMEOUT_SEC);
+    std::optional<phosphor::time::state::State> restored;
+    if constexpr (idleExitTimeout.count() > 0)
+    {
+        restored = phosphor::time::state::load(stateFile);
+        std::error_code ec;
+        std::filesystem::remove(stateFile, ec);
+    }
+
+    phosphor::time::SystemClock clock(bus);
+    phosphor::time::Manager manager(bus, clock, restored,
+                                    signalBus ? &*signalBus : nullptr);
+    phosphor::time::BmcEpoch bmc(bus, objpathBmc, manager, clock);
+    phosphor::time::TimeZone timeZone(bus, objpathBmc, clock,
+                                      manager.getEvents(), localtimeFile);
+
+    phosphor::time::ClockSource clockSource(
+        bus, objpathBmc, manager.getEvents(), clockSourceDir,
+        [&clock]() { return clock.coarseNow(); });
+    phosphor::time::JumpNotifier jumpNotifier(bus, objpathBmc,
+                                              manager.getEvents());
+
+    constexpr std::string_view rtcDevice = RTC_DEVICE;
+    std::optional<phosphor::time::RtcMonitor> rtcMonitor;
+    if constexpr (!rtcDevice.empty())
+    {
+        rtcMonitor.emplace(bus, objpathBmc, clock, manager.getEvents(),
+                           manager.getTimeMode(), rtcDevice);
+    }
+
+    constexpr std::string_view ptpSocket = PTP_SOCKET;
+    std::optional<phosphor::time::PtpSync> ptpSync;
+    if constexpr (!ptpSocket.empty())
+    {
+        ptpSync.emplace(
+            bus, objpathBmc, manager.getEvents(), ptpSocket,
+            manager.getTimeMode(),
+            [&manager]() -> phosphor::time::utils::Expected<void> {
+                using phosphor::time::Mode;
+                if (manager.getTimeMode() != Mode::Manual)
+                {
+                    auto result = manager.trySetTimeMode(Mode::Manual);
+                    if (!result)
+                    {
+                        return result;
+                    }
+                }
+                return manager.trySetNtp(false);
+            },
+            [&bus](bool start) {
+                return phosphor::time::PtpSync::controlUnits(bus, PTP_UNITS,
+                                                             start);
+            },
+            [&bus]() {
+                return phosphor::time::PtpSync::unitsActive(bus, PTP_UNITS);
+            });
+    }
+
+    constexpr std::string_view metricsFile = METRICS_FILE;
+    std::optional<phosphor::time::MetricsExporter> metricsExporter;
+    if constexpr (!metricsFile.empty())
+    {
+        metricsExporter.emplace(bus.get_event(), metricsFile,
+                                phosphor::time::metrics::get());
+    }
+
+    std::optional<phosphor::time::IdleMonitor> idleMonitor;
+    bool idled = false;
+    if constexpr (idleExitTimeout.count() > 0)
+    {
+        idleMonitor.emplace(bus, idleExitTimeout, [&]() {
+            // A scheduled set would be lost by the exit, the subscribers
+            // would stop being notified, PTP stop being monitored and the
+            // frequency learned or held by holdover be forgotten
+            if (!bmc.getScheduledSet().pending().empty() ||
+                jumpNotifier.clients() > 0 ||
+                (ptpSync && ptpSync->enabled()) ||
+                manager.getHoldover().isSampling())
+            {
+                return;
+            }
+            // A call sent from now on activates the daemon again
+            sd_bus_release_name(bus.get(), busname);
+            idled = true;
+            sd_event_exit(sdEvent.get(), 0);
+        });
+        if (signalBus)
+        {
+            idleMonitor->watch(*signalBus);
+        }
+    }
+
+    // Reads are served after everything else, a few per iteration
+    phosphor::time::ReadQueue readQueue(bus);
+    if (idleMonitor)
+    {
+        // A call put back passes the filters a second time
+        idleMonitor->skipRepeated([&readQueue](sd_bus_message* msg) {
+            return readQueue.isPutBack(msg);
+        });
+    }
 
     bus.request_name(busname);
 
     // Start event loop for all sd-bus events and timer event
-    sd_event_loop(bus.get_event());
+    auto r = sd_event_loop(bus.get_event());
+
+    if (idled)
+    {
+        // Serve the calls that arrived while the name was held, the reads
+        // queued included, before the state is saved
+        while (sd_bus_process(bus.get(), nullptr) > 0 ||
+               readQueue.release() > 0)
+        {}
+        bus.flush();
+        phosphor::time::state::save(stateFile, manager.getState());
+    }
 
     bus.detach_event();
+    if (signalBus)
+    {
+        signalBus->detach_event();
+    }
 
-    return 0;
+    return r < 0 ? 1 : 0;
 }
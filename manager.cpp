@@ -1,5 +1,7 @@
 #include "manager.hpp"
 
+#include "metrics.hpp"
+#include "probes.hpp"
 #include "utils.hpp"
 
 #include <phosphor-logging/lg2.hpp>
@@ -16,6 +18,35 @@ constexpr auto systemdTimePath = "/org/freedesktop/timedate1";
 constexpr auto systemdTimeInterface = "org.freedesktop.timedate1";
 constexpr auto methodSetNtp = "SetNTP";
 constexpr auto propertyNtp = "NTP";
+constexpr auto propertyNtpSynchronized = "NTPSynchronized";
+constexpr auto propertyTimezone = "Timezone";
+
+/** @brief Expect the signal of a value written, the oldest one expected is
+ *         dropped once max are */
+template <typename T>
+void expectEcho(std::deque<T>& echoes, T value, size_t max)
+{
+    if (echoes.size() >= max)
+    {
+        echoes.pop_front();
+    }
+    echoes.push_back(std::move(value));
+}
+
+/** @brief Check if a signaled value is the next one expected. A value that
+ *         is not was changed by someone else, and the values written before
+ *         are not waited for anymore. */
+template <typename T>
+bool isEcho(std::deque<T>& echoes, const T& value)
+{
+    if (!echoes.empty() && echoes.front() == value)
+    {
+        echoes.pop_front();
+        return true;
+    }
+    echoes.clear();
+    return false;
+}
 } // namespace
 
 namespace phosphor
@@ -25,16 +56,39 @@ namespace time
 
 PHOSPHOR_LOG2_USING;
 
-Manager::Manager(sdbusplus::bus_t& bus) : bus(bus), settings(bus)
+Manager::Manager(sdbusplus::bus_t& bus, Clock& clock,
+                 const std::optional<state::State>& restored,
+                 sdbusplus::bus_t* signalBus) :
+    bus(bus), clock(clock),
+    settings(restored ? settings::Objects(restored->settingsPath)
+                      : settings::Objects(bus)),
+    settingsWriteBack(bus, objpathBmc,
+                      [this](const std::string& mode, WriteBack::Done done) {
+                          return writeTimeMode(mode, done);
+                      }),
+    modeTrace(bus, objpathBmc, clock),
+    holdover(bus, objpathBmc, clock, events,
+             std::chrono::seconds(HOLDOVER_MAX_AGE_SEC))
 {
+    clock.onJump([this](std::chrono::microseconds delta, bool own) {
+        events.publish(event::Jump{delta, own});
+    });
+
     using namespace sdbusplus::bus::match::rules;
+    auto& matchBus = signalBus ? *signalBus : bus;
     timedateMatches.emplace_back(
-        bus, propertiesChanged(systemdTimePath, systemdTimeInterface),
+        matchBus, propertiesChanged(systemdTimePath, systemdTimeInterface),
         [&](sdbusplus::message_t& m) { onTimedateChanged(m); });
     settingsMatches.emplace_back(
-        bus, propertiesChanged(settings.timeSyncMethod, settings::timeSyncIntf),
+        matchBus,
+        propertiesChanged(settings.timeSyncMethod, settings::timeSyncIntf),
         [&](sdbusplus::message_t& m) { onSettingsChanged(m); });
 
+    if (restored && restore(*restored))
+    {
+        return;
+    }
+
     // Check the settings daemon to process the new settings
     auto mode = getSetting(settings.timeSyncMethod.c_str(),
                            settings::timeSyncIntf, propertyTimeMode);
@@ -42,6 +96,44 @@ Manager::Manager(sdbusplus::bus_t& bus) : bus(bus), settings(bus)
     onPropertyChanged(propertyTimeMode, mode, true);
 }
 
+Manager::~Manager()
+{
+    clock.onJump({});
+}
+
+bool Manager::restore(const state::State& restored)
+{
+    auto mode = utils::tryGetProperty<std::string>(
+        bus, restored.settingsService.c_str(), settings.timeSyncMethod.c_str(),
+        settings::timeSyncIntf, propertyTimeMode);
+    if (!mode)
+    {
+        info("Saved settings service is gone, start from scratch: {ERROR}",
+             "ERROR", mode.error().message);
+        return false;
+    }
+
+    settingsService = restored.settingsService;
+    setTimeMode(restored.mode);
+    timedateNtp = restored.ntp;
+
+    // A setting changed while the daemon was not running is picked up as
+    // a regular change, the sync is only forced if timedated was behind.
+    bool forceSet = (restored.ntp != (Mode::NTP == restored.mode));
+    onPropertyChanged(propertyTimeMode, *mode, forceSet);
+    return true;
+}
+
+state::State Manager::getState() const
+{
+    state::State s;
+    s.mode = timeMode;
+    s.settingsPath = settings.timeSyncMethod;
+    s.settingsService = settingsService;
+    s.ntp = timedateNtp.value_or(Mode::NTP == timeMode);
+    return s;
+}
+
 void Manager::onPropertyChanged(const std::string& key,
                                 const std::string& value, bool forceSet)
 {
@@ -49,36 +141,37 @@ void Manager::onPropertyChanged(const std::string& key,
 
     bool newNtpMode = (settings::ntpSync == value);
     bool oldNtpMode = (Mode::NTP == getTimeMode());
+    TIME_PROBE(property_changed, newNtpMode, oldNtpMode, forceSet);
+
+    // An unchanged mode is the bulk of a signal storm and is not logged,
+    // every log line is a write to the journal.
     if (forceSet || (newNtpMode != oldNtpMode))
     {
-        // Notify listeners
         onTimeModeChanged(value);
         setCurrentTimeMode(value);
         debug("NTP property changed in phosphor-settings, update to systemd"
               " time service.");
     }
-    else
-    {
-        debug("NTP mode is already the same, skip setting to systemd time"
-              " service again.");
-    }
 }
 
 int Manager::onSettingsChanged(sdbusplus::message_t& msg)
 {
-    using Interface = std::string;
-    using Property = std::string;
-    using Value = std::string;
-    using Properties = std::map<Property, std::variant<Value>>;
+    auto received = ModeTrace::Timestamp::clock::now();
 
-    Interface interface;
-    Properties properties;
-
-    msg.read(interface, properties);
-
-    for (const auto& p : properties)
+    // Only TimeSyncMethod is of interest, other properties of the settings
+    // object are skipped whatever their type.
+    auto mode = utils::getChangedProperty<std::string>(msg, propertyTimeMode);
+    if (mode)
     {
-        onPropertyChanged(p.first, std::get<std::string>(p.second));
+        // The signals of the writes of trySetTimeMode come after the fact,
+        // e.g. the Manual of a transaction that restored NTP mode since
+        if (isEcho(modeEchoes, *mode))
+        {
+            return 0;
+        }
+        settingsWriteBack.superseded(*mode);
+        modeTrace.signal(received);
+        onPropertyChanged(propertyTimeMode, *mode);
     }
 
     return 0;
@@ -86,45 +179,50 @@ int Manager::onSettingsChanged(sdbusplus::message_t& msg)
 
 int Manager::onTimedateChanged(sdbusplus::message_t& msg)
 {
-    using Properties = std::map<std::string, std::variant<std::string, bool>>;
-
-    std::string interface;
-    Properties properties;
+    // timedated also signals e.g. LocalRTC and TimeUSec, which are skipped
+    // without being unpacked.
+    auto zone = utils::getChangedProperty<std::string>(msg, propertyTimezone);
+    if (zone)
+    {
+        events.publish(event::Timezone{std::move(*zone)});
+    }
 
-    msg.read(interface, properties);
+    auto synchronized =
+        utils::getChangedProperty<bool>(msg, propertyNtpSynchronized);
+    if (synchronized && synchronized != timedateSynchronized)
+    {
+        timedateSynchronized = synchronized;
+        modeTrace.onSynchronized(*synchronized);
+        events.publish(event::SyncStatus{*synchronized});
+    }
 
-    auto iter = properties.find(propertyNtp);
-    if (iter == properties.end())
+    auto ntp = utils::getChangedProperty<bool>(msg, propertyNtp);
+    TIME_PROBE(timedate_changed, ntp.has_value());
+    if (!ntp)
     {
         return -1;
     }
 
-    try
+    bool newNtpMode = *ntp;
+    timedateNtp = newNtpMode;
+    modeTrace.onNtp(newNtpMode);
+    if (isEcho(ntpEchoes, newNtpMode))
     {
-        bool newNtpMode = std::get<bool>(iter->second);
-        bool oldNtpMode = (Mode::NTP == getTimeMode());
-        if (newNtpMode != oldNtpMode)
-        {
-            const auto& timeMode =
-                newNtpMode ? settings::ntpSync : settings::manualSync;
-            std::string settingManager = utils::getService(
-                bus, settings.timeSyncMethod.c_str(), settings::timeSyncIntf);
-            utils::setProperty(bus, settingManager, settings.timeSyncMethod,
-                               settings::timeSyncIntf, propertyTimeMode,
-                               timeMode);
-            setCurrentTimeMode(timeMode);
-            debug("NTP property changed in systemd time service, update to"
-                  " phosphor-settings.");
-        }
-        else
-        {
-            debug("NTP mode is already the same, skip setting to"
-                  " phosphor-settings again.");
-        }
+        return 0;
     }
-    catch (const std::exception& ex)
+
+    bool oldNtpMode = (Mode::NTP == getTimeMode());
+    if (newNtpMode != oldNtpMode)
     {
-        error("Failed to sync NTP: {ERROR}", "ERROR", ex);
+        const auto& timeMode =
+            newNtpMode ? settings::ntpSync : settings::manualSync;
+
+        // The settings follow in the background, a failed write is retried
+        // rather than leaving them out of sync with timedated
+        settingsWriteBack.write(timeMode);
+        setCurrentTimeMode(timeMode);
+        debug("NTP property changed in systemd time service, update to"
+              " phosphor-settings.");
     }
 
     return 0;
@@ -132,22 +230,123 @@ int Manager::onTimedateChanged(sdbusplus::message_t& msg)
 
 void Manager::updateNtpSetting(const std::string& value)
 {
-    try
+    bool isNtp =
+        (value == "xyz.openbmc_project.Time.Synchronization.Method.NTP");
+    modeTrace.begin(isNtp ? Mode::NTP : Mode::Manual);
+    modeTrace.mark(ModeTrace::Stage::NtpIssued);
+    auto result = trySetNtp(isNtp);
+    modeTrace.mark(ModeTrace::Stage::NtpReturned);
+    if (!result)
     {
-        bool isNtp =
-            (value == "xyz.openbmc_project.Time.Synchronization.Method.NTP");
-        auto method = bus.new_method_call(systemdTimeService, systemdTimePath,
-                                          systemdTimeInterface, methodSetNtp);
-        method.append(isNtp, false); // isNtp: 'true/false' means Enable/Disable
-                                     // 'false' meaning no policy-kit
+        error("Failed to update NTP setting: {ERROR}", "ERROR",
+              result.error().message);
+        return;
+    }
+    info("Updated NTP setting: {ENABLED}", "ENABLED", isNtp);
+}
 
-        bus.call_noreply(method);
-        info("Updated NTP setting: {ENABLED}", "ENABLED", isNtp);
+utils::Expected<void> Manager::trySetNtp(bool enable)
+{
+    auto method = bus.new_method_call(systemdTimeService, systemdTimePath,
+                                      systemdTimeInterface, methodSetNtp);
+    method.append(enable, false); // enable: 'true/false' means Enable/Disable
+                                  // 'false' meaning no policy-kit
+
+    TIME_PROBE(update_ntp_entry, enable);
+    auto reply = [&]() {
+        metrics::Latency latency(metrics::get().setNtp);
+        return utils::call(bus, method);
+    }();
+    TIME_PROBE(update_ntp_return, enable, reply ? 0 : reply.error().errnum);
+    if (!reply)
+    {
+        ++metrics::get().setNtpFailures;
+        return std::unexpected(std::move(reply.error()));
     }
-    catch (const sdbusplus::exception_t& ex)
+    wroteNtp(enable);
+    return {};
+}
+
+void Manager::wroteNtp(bool enable)
+{
+    // timedated signals nothing if NTP is unchanged
+    if (timedateNtp != enable)
     {
-        error("Failed to update NTP setting: {ERROR}", "ERROR", ex);
+        expectEcho(ntpEchoes, enable, maxEchoes);
     }
+    timedateNtp = enable;
+}
+
+utils::Expected<void> Manager::trySetTimeMode(Mode mode)
+{
+    auto settingManager = utils::tryGetService(
+        bus, settings.timeSyncMethod.c_str(), settings::timeSyncIntf);
+    if (!settingManager)
+    {
+        return std::unexpected(std::move(settingManager.error()));
+    }
+    settingsService = *settingManager;
+
+    auto value = utils::modeToStr(mode);
+    settingsWriteBack.superseded(value);
+    auto result =
+        utils::trySetProperty(bus, *settingManager, settings.timeSyncMethod,
+                              settings::timeSyncIntf, propertyTimeMode, value);
+    if (!result)
+    {
+        return result;
+    }
+    wroteTimeMode(value);
+    return {};
+}
+
+void Manager::wroteTimeMode(const std::string& mode)
+{
+    // The settings signal nothing if the mode is unchanged
+    if (setCurrentTimeMode(mode))
+    {
+        expectEcho(modeEchoes, mode, maxEchoes);
+    }
+}
+
+utils::Expected<void> Manager::writeTimeMode(const std::string& mode,
+                                             const WriteBack::Done& done)
+{
+    if (settingsService.empty())
+    {
+        return utils::getServiceAsync(
+            bus, settings.timeSyncMethod.c_str(), settings::timeSyncIntf,
+            [this, mode, done](utils::Expected<std::string> service) {
+                if (!service)
+                {
+                    done(std::unexpected(std::move(service.error())));
+                    return;
+                }
+                settingsService = std::move(*service);
+                auto result = writeTimeMode(mode, done);
+                if (!result)
+                {
+                    done(result);
+                }
+            });
+    }
+
+    auto method = bus.new_method_call(settingsService.c_str(),
+                                      settings.timeSyncMethod.c_str(),
+                                      "org.freedesktop.DBus.Properties", "Set");
+    method.append(settings::timeSyncIntf, propertyTimeMode,
+                  std::variant<std::string>(mode));
+    return utils::callAsync(
+        bus, method, [this, done](utils::Expected<sdbusplus::message_t> reply) {
+            if (!reply)
+            {
+                // Looked up again on the retry
+                settingsService.clear();
+                done(std::unexpected(std::move(reply.error())));
+                return;
+            }
+            done({});
+        });
 }
 
 bool Manager::setCurrentTimeMode(const std::string& mode)
@@ -158,7 +357,8 @@ bool Manager::setCurrentTimeMode(const std::string& mode)
         if (newMode != timeMode)
         {
             info("Time mode has been changed to {MODE}", "MODE", newMode);
-            timeMode = newMode;
+            ++metrics::get().modeChanges;
+            setTimeMode(newMode);
             return true;
         }
     }
@@ -177,21 +377,30 @@ void Manager::onTimeModeChanged(const std::string& mode)
 }
 
 std::string Manager::getSetting(const char* path, const char* interface,
-                                const char* setting) const
+                                const char* setting)
 {
-    try
+    auto settingManager = utils::tryGetService(bus, path, interface);
+    if (!settingManager)
     {
-        std::string settingManager = utils::getService(bus, path, interface);
-        return utils::getProperty<std::string>(bus, settingManager.c_str(),
-                                               path, interface, setting);
+        error(
+            "Failed to get property: {ERROR}, path: {PATH}, interface: {INTERFACE}, name: {NAME}",
+            "ERROR", settingManager.error().message, "PATH", path, "INTERFACE",
+            interface, "NAME", setting);
+        return {};
     }
-    catch (const std::exception& ex)
+    settingsService = *settingManager;
+
+    auto value = utils::tryGetProperty<std::string>(
+        bus, settingManager->c_str(), path, interface, setting);
+    if (!value)
     {
         error(
             "Failed to get property: {ERROR}, path: {PATH}, interface: {INTERFACE}, name: {NAME}",
-            "ERROR", ex, "PATH", path, "INTERFACE", interface, "NAME", setting);
+            "ERROR", value.error().message, "PATH", path, "INTERFACE",
+            interface, "NAME", setting);
         return {};
     }
+    return std::move(*value);
 }
 
 } // namespace time
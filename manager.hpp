@@ -2,13 +2,21 @@
 
 #include "config.h"
 
-#include "property_change_listener.hpp"
+#include "clock.hpp"
+#include "events.hpp"
+#include "holdover.hpp"
+#include "mode_trace.hpp"
+#include "persistent_state.hpp"
 #include "settings.hpp"
 #include "types.hpp"
+#include "utils.hpp"
+#include "write_back.hpp"
 
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/bus/match.hpp>
 
+#include <deque>
+#include <optional>
 #include <string>
 
 namespace phosphor
@@ -20,34 +28,96 @@ namespace time
  *  @brief The manager to handle OpenBMC time.
  *  @details It registers various time related settings and properties signals
  *  on DBus and handle the changes.
- *  For certain properties it also notifies the changed events to listeners.
+ *  The jumps of the clock and the changes of the time mode, the sync status
+ *  and the time zone are published as time events to the components.
  */
 class Manager
 {
   public:
     friend class TestManager;
 
-    explicit Manager(sdbusplus::bus_t& bus);
+    /** @brief Constructor
+     *
+     * @param[in] bus      - The Dbus bus object
+     * @param[in] clock    - The clock to publish the jumps of and to hold
+     *                       on frequency in NTP mode
+     * @param[in] restored - The state saved by an idle exit, if any
+     * @param[in] signalBus - The connection to subscribe the signals of
+     *                        timedate and the settings on, so they are not
+     *                        queued behind the calls of the clients on bus,
+     *                        bus if null
+     */
+    Manager(sdbusplus::bus_t& bus, Clock& clock,
+            const std::optional<state::State>& restored = {},
+            sdbusplus::bus_t* signalBus = nullptr);
     Manager(const Manager&) = delete;
     Manager& operator=(const Manager&) = delete;
     Manager(Manager&&) = delete;
     Manager& operator=(Manager&&) = delete;
-    ~Manager() = default;
+    ~Manager();
 
     void setTimeMode(Mode mode)
     {
         this->timeMode = mode;
+        events.publish(event::ModeChanged{mode});
     }
 
-    Mode getTimeMode()
+    Mode getTimeMode() const
     {
         return this->timeMode;
     }
 
+    /** @brief Switch the time mode without waiting for the settings signal
+     *
+     * The mode is written to the settings and taken as the current one at
+     * once, so the signal of the settings that follows is a no-op. The NTP
+     * setting of systemd time service is left to the caller.
+     *
+     * @param[in] mode - The time mode
+     *
+     * @return Nothing or the error of writing the settings
+     */
+    utils::Expected<void> trySetTimeMode(Mode mode);
+
+    /** @brief Enable or disable NTP of systemd time service
+     *
+     * @param[in] enable - Whether to enable NTP
+     *
+     * @return Nothing or the error of the SetNTP call
+     */
+    utils::Expected<void> trySetNtp(bool enable);
+
+    /** @brief Get the timing of the last switches of the time mode */
+    const ModeTrace& getModeTrace() const
+    {
+        return modeTrace;
+    }
+
+    /** @brief Get the frequency holdover */
+    const Holdover& getHoldover() const
+    {
+        return holdover;
+    }
+
+    /** @brief Get the time events for the components to subscribe to */
+    TimeEvents& getEvents()
+    {
+        return events;
+    }
+
+    /** @brief Get the state to save before an idle exit */
+    state::State getState() const;
+
   private:
     /** @brief Persistent sdbusplus DBus connection */
     sdbusplus::bus_t& bus;
 
+    /** @brief The clock whose jumps are published */
+    Clock& clock;
+
+    /** @brief The time events published to the components */
+    TimeEvents events;
+
     /** @brief The match of systemd timedate property change */
     std::vector<sdbusplus::bus::match_t> timedateMatches;
 
@@ -60,6 +130,62 @@ class Manager
     /** @brief The current time mode */
     Mode timeMode = DEFAULT_TIME_MODE;
 
+    /** @brief The service of the time sync method settings object */
+    utils::Service settingsService;
+
+    /** @brief The last known NTP property of systemd time service */
+    std::optional<bool> timedateNtp;
+
+    /** @brief The last known NTPSynchronized property of systemd time
+     *         service */
+    std::optional<bool> timedateSynchronized;
+
+    /** @brief The write back of the NTP setting of systemd time service
+     *         to the settings */
+    WriteBack settingsWriteBack;
+
+    /** @brief The timing of the last switches of the time mode */
+    ModeTrace modeTrace;
+
+    /** @brief The frequency holdover while NTP is unavailable */
+    Holdover holdover;
+
+    /** @brief The time modes written to the settings by trySetTimeMode
+     *         whose signal is not back yet */
+    std::deque<std::string> modeEchoes;
+
+    /** @brief The NTP values set by trySetNtp whose signal of systemd time
+     *         service is not back yet */
+    std::deque<bool> ntpEchoes;
+
+    /** @brief The most echoes expected of each, the oldest are dropped */
+    static constexpr size_t maxEchoes = 4;
+
+    /** @brief Take a time mode written to the settings as the current one
+     *         and expect its signal back
+     *
+     * @param[in] mode - The string of time mode
+     */
+    void wroteTimeMode(const std::string& mode);
+
+    /** @brief Take an NTP value set on systemd time service as the current
+     *         one and expect its signal back
+     *
+     * @param[in] enable - Whether NTP is enabled
+     */
+    void wroteNtp(bool enable);
+
+    /** @brief Resume from the state saved by an idle exit
+     *
+     * The saved settings service is queried directly, and the NTP setting
+     * is only pushed to systemd time service if it differs from the mode.
+     *
+     * @param[in] restored - The saved state
+     *
+     * @return true if the state is used, false if a full start is needed
+     */
+    bool restore(const state::State& restored);
+
     /** @brief Get setting from settingsd service
      *
      * @param[in] path - The dbus object path
@@ -69,7 +195,7 @@ class Manager
      * @return The setting value in string
      */
     std::string getSetting(const char* path, const char* interface,
-                           const char* setting) const;
+                           const char* setting);
 
     /** @brief Set current time mode from the time mode string
      *
@@ -82,13 +208,28 @@ class Manager
 
     /** @brief Called on time mode is changed
      *
-     * Notify listeners that time mode is changed and update ntp setting
+     * Update the NTP setting, the time event follows once the mode is set
      *
      * @param[in] mode - The string of time mode
      */
     void onTimeModeChanged(const std::string& mode);
 
-    /** @brief Callback to handle change in NTP
+    /** @brief Write the time mode to the settings without waiting
+     *
+     * The settings service is looked up first if it is not known, or the
+     * last write to it failed, as it may have been restarted.
+     *
+     * @param[in] mode - The string of time mode
+     * @param[in] done - Called with the result of the write
+     *
+     * @return Nothing or the error of sending the call, done is not
+     *         called then
+     */
+    utils::Expected<void> writeTimeMode(const std::string& mode,
+                                        const WriteBack::Done& done);
+
+    /** @brief Callback to handle change in NTP, NTPSynchronized and
+     *         Timezone
      *
      *  @param[in] msg - sdbusplus dbusmessage
      *
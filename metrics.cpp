@@ -0,0 +1,96 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+
+namespace phosphor
+{
+namespace time
+{
+namespace metrics
+{
+
+namespace // anonymous
+{
+constexpr auto prefix = "phosphor_time_";
+
+/** @brief Format microseconds as seconds, e.g. "0.000050" */
+std::string toSeconds(uint64_t usec)
+{
+    auto fraction = std::to_string(usec % 1000000);
+    return std::to_string(usec / 1000000) + "." +
+           std::string(6 - fraction.size(), '0') + fraction;
+}
+
+void renderCounter(std::string& out, const char* name, const char* help,
+                   uint64_t value)
+{
+    auto family = std::string(prefix) + name + "_total";
+    out += "# TYPE " + family + " counter\n";
+    out += "# HELP " + family + " " + help + "\n";
+    out += family + " " + std::to_string(value) + "\n";
+}
+
+void renderHistogram(std::string& out, const char* name, const char* help,
+                     const Histogram& histogram)
+{
+    auto family = std::string(prefix) + name + "_seconds";
+    out += "# TYPE " + family + " histogram\n";
+    out += "# HELP " + family + " " + help + "\n";
+    for (size_t i = 0; i < Histogram::bounds.size(); ++i)
+    {
+        out += family + "_bucket{le=\"" + toSeconds(Histogram::bounds[i]) +
+               "\"} " + std::to_string(histogram.cumulative(i)) + "\n";
+    }
+    out += family + "_bucket{le=\"+Inf\"} " +
+           std::to_string(histogram.count()) + "\n";
+    out += family + "_sum " + toSeconds(histogram.sum().count()) + "\n";
+    out += family + "_count " + std::to_string(histogram.count()) + "\n";
+}
+
+} // namespace
+
+void Histogram::observe(std::chrono::microseconds value)
+{
+    uint64_t usec = std::max<int64_t>(value.count(), 0);
+    auto bucket = std::ranges::lower_bound(bounds, usec) - bounds.begin();
+    ++buckets[bucket];
+    ++total;
+    sumUsec += usec;
+}
+
+uint64_t Histogram::cumulative(size_t i) const
+{
+    uint64_t count = 0;
+    for (size_t j = 0; j <= i && j < buckets.size(); ++j)
+    {
+        count += buckets[j];
+    }
+    return count;
+}
+
+Metrics& get()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+std::string render(const Metrics& metrics)
+{
+    std::string out;
+    renderHistogram(out, "elapsed_get", "Gets of Elapsed", metrics.elapsedGet);
+    renderHistogram(out, "elapsed_set", "Sets of Elapsed", metrics.elapsedSet);
+    renderHistogram(out, "set_ntp", "SetNTP calls to timedated",
+                    metrics.setNtp);
+    renderCounter(out, "set_ntp_failures", "Failed SetNTP calls",
+                  metrics.setNtpFailures);
+    renderCounter(out, "mode_changes", "Changes of the time mode",
+                  metrics.modeChanges);
+    renderCounter(out, "jumps", "Jumps of the clock", metrics.jumps);
+    renderCounter(out, "mapper_calls", "Calls to the mapper",
+                  metrics.mapperCalls);
+    return out;
+}
+
+} // namespace metrics
+} // namespace time
+} // namespace phosphor
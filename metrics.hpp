@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace phosphor
+{
+namespace time
+{
+namespace metrics
+{
+
+/** @class Histogram
+ *  @brief A latency histogram with fixed buckets.
+ *  @details An observation is an increment of a bucket, a count and a
+ *  sum, so the histograms can be kept on the paths they measure.
+ */
+class Histogram
+{
+  public:
+    /** @brief The upper bounds of the buckets, in microseconds */
+    static constexpr std::array<uint64_t, 10> bounds{
+        10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 1000000};
+
+    /** @brief Add an observation
+     *
+     * @param[in] value - The latency observed
+     */
+    void observe(std::chrono::microseconds value);
+
+    /** @brief Get the observations up to the bound of a bucket
+     *
+     * @param[in] i - The bucket, bounds.size() for +Inf
+     */
+    uint64_t cumulative(size_t i) const;
+
+    /** @brief Get the number of observations */
+    uint64_t count() const
+    {
+        return total;
+    }
+
+    /** @brief Get the sum of the observations */
+    std::chrono::microseconds sum() const
+    {
+        return std::chrono::microseconds(sumUsec);
+    }
+
+  private:
+    /** @brief The observations of each bucket, the last one is +Inf */
+    std::array<uint64_t, bounds.size() + 1> buckets{};
+
+    /** @brief The number of observations */
+    uint64_t total = 0;
+
+    /** @brief The sum of the observations in microseconds */
+    uint64_t sumUsec = 0;
+};
+
+/** @class Latency
+ *  @brief Observe the time until it goes out of scope, also by an
+ *         exception.
+ */
+class Latency
+{
+  public:
+    explicit Latency(Histogram& histogram) :
+        histogram(histogram), start(std::chrono::steady_clock::now())
+    {}
+
+    ~Latency()
+    {
+        histogram.observe(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start));
+    }
+
+    Latency(const Latency&) = delete;
+    Latency(Latency&&) = delete;
+    Latency& operator=(const Latency&) = delete;
+    Latency& operator=(Latency&&) = delete;
+
+  private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+/** @brief The counters and histograms of the time manager */
+struct Metrics
+{
+    /** @brief The Gets of Elapsed */
+    Histogram elapsedGet;
+
+    /** @brief The Sets of Elapsed, also the rejected and failed ones */
+    Histogram elapsedSet;
+
+    /** @brief The SetNTP calls to systemd time service */
+    Histogram setNtp;
+
+    /** @brief The SetNTP calls that failed */
+    uint64_t setNtpFailures = 0;
+
+    /** @brief The changes of the time mode */
+    uint64_t modeChanges = 0;
+
+    /** @brief The jumps of the clock */
+    uint64_t jumps = 0;
+
+    /** @brief The calls to the mapper */
+    uint64_t mapperCalls = 0;
+
+    /** @brief Get a number that moves whenever any metric does */
+    uint64_t generation() const
+    {
+        return elapsedGet.count() + elapsedSet.count() + setNtp.count() +
+               setNtpFailures + modeChanges + jumps + mapperCalls;
+    }
+};
+
+/** @brief Get the metrics of the process */
+Metrics& get();
+
+/** @brief Render the metrics in the Prometheus text format, which the
+ *         textfile collector of node-exporter reads
+ *
+ * @param[in] metrics - The metrics to render
+ *
+ * @return The text
+ */
+std::string render(const Metrics& metrics);
+
+} // namespace metrics
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,82 @@
+#include "metrics_exporter.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <fstream>
+
+namespace phosphor
+{
+namespace time
+{
+
+PHOSPHOR_LOG2_USING;
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+MetricsExporter::MetricsExporter(sd_event* event, fs::path file,
+                                 const metrics::Metrics& metrics,
+                                 seconds interval) :
+    file(std::move(file)), metrics(metrics), interval(interval),
+    timer(
+        event, CLOCK_MONOTONIC,
+        [this]() {
+            write();
+            timer.armRelative(this->interval);
+        },
+        seconds(1))
+{
+    write();
+    timer.armRelative(interval);
+}
+
+bool MetricsExporter::write()
+{
+    auto generation = metrics.generation();
+    if (written == generation)
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(file.parent_path(), ec);
+
+    auto tmpPath = file;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        out << metrics::render(metrics);
+        if (!out.flush())
+        {
+            if (!failing)
+            {
+                error("Failed to write metrics file {PATH}", "PATH",
+                      tmpPath.string());
+            }
+            failing = true;
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tmpPath, file, ec);
+    if (ec)
+    {
+        if (!failing)
+        {
+            error("Failed to rename metrics file {PATH}: {ERROR}", "PATH",
+                  file.string(), "ERROR", ec.message());
+        }
+        failing = true;
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+
+    failing = false;
+    written = generation;
+    ++writeCount;
+    return true;
+}
+
+} // namespace time
+} // namespace phosphor
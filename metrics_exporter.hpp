@@ -0,0 +1,85 @@
+#pragma once
+
+#include "event_timer.hpp"
+#include "metrics.hpp"
+
+#include <systemd/sd-event.h>
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class MetricsExporter
+ *  @brief Write the metrics to a file for the textfile collector of
+ *         node-exporter.
+ *  @details The monitoring that cannot talk D-Bus scrapes the file. It is
+ *  written in the Prometheus text format from a timer every interval, to
+ *  a temporary file that is renamed over the target, so a scrape never
+ *  sees a partial file. When no metric moved since the last write the
+ *  write is skipped, so an idle daemon costs a timer wakeup per interval.
+ */
+class MetricsExporter
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param[in] event    - The event loop, may be nullptr
+     * @param[in] file     - The file to write
+     * @param[in] metrics  - The metrics to write
+     * @param[in] interval - The time between the writes
+     */
+    MetricsExporter(sd_event* event, std::filesystem::path file,
+                    const metrics::Metrics& metrics,
+                    std::chrono::seconds interval = defaultInterval);
+    ~MetricsExporter() = default;
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter(MetricsExporter&&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(MetricsExporter&&) = delete;
+
+    /** @brief Write the file if a metric moved since the last write
+     *
+     * @return true if the file is written
+     */
+    bool write();
+
+    /** @brief Get the number of writes of the file */
+    uint64_t writes() const
+    {
+        return writeCount;
+    }
+
+    /** @brief The time between the writes */
+    static constexpr std::chrono::seconds defaultInterval{30};
+
+  private:
+    /** @brief The file to write */
+    std::filesystem::path file;
+
+    /** @brief The metrics to write */
+    const metrics::Metrics& metrics;
+
+    /** @brief The time between the writes */
+    std::chrono::seconds interval;
+
+    /** @brief The generation of the metrics last written */
+    std::optional<uint64_t> written;
+
+    /** @brief Whether the last write failed, to only log the first */
+    bool failing = false;
+
+    /** @brief The number of writes of the file */
+    uint64_t writeCount = 0;
+
+    /** @brief The timer of the next write */
+    EventTimer timer;
+};
+
+} // namespace time
+} // namespace phosphor
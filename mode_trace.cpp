@@ -0,0 +1,270 @@
+#include "mode_trace.hpp"
+
+#include "utils.hpp"
+
+#include <algorithm>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto propertyTransitions = "Transitions";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+
+size_t index(ModeTrace::Stage stage)
+{
+    return static_cast<size_t>(stage);
+}
+
+bool reached(const std::optional<ModeTrace::Timestamp>& at)
+{
+    return at.has_value();
+}
+
+/** @brief The stage that completes a switch to the mode */
+ModeTrace::Stage lastStage(Mode mode)
+{
+    return (Mode::NTP == mode) ? ModeTrace::Stage::Synchronized
+                               : ModeTrace::Stage::TimedateNtp;
+}
+} // namespace
+
+using namespace std::chrono;
+
+std::optional<microseconds>
+    ModeTrace::Transition::duration(Stage stage) const
+{
+    auto i = index(stage);
+    if (!at[i])
+    {
+        return std::nullopt;
+    }
+    for (size_t j = i; j-- > 0;)
+    {
+        if (at[j])
+        {
+            return duration_cast<microseconds>(*at[i] - *at[j]);
+        }
+    }
+    return microseconds(0);
+}
+
+microseconds ModeTrace::Transition::total() const
+{
+    auto first = std::ranges::find_if(at, reached);
+    auto last = std::find_if(at.rbegin(), at.rend(), reached);
+    if (first == at.end())
+    {
+        return {};
+    }
+    return duration_cast<microseconds>(**last - **first);
+}
+
+ModeTrace::ModeTrace(sdbusplus::bus_t& bus, const char* objPath,
+                     const Clock& clock, size_t capacity) :
+    clock(clock), capacity(std::max<size_t>(capacity, 1)),
+    timer(bus.get_event(), CLOCK_MONOTONIC, [this]() { check(); },
+          milliseconds(100)),
+    interface(bus, objPath, modeTraceIntf, vtable, this)
+{}
+
+void ModeTrace::signal(Timestamp received)
+{
+    pendingSignal = received;
+}
+
+void ModeTrace::begin(Mode mode)
+{
+    if (open)
+    {
+        close();
+    }
+
+    Transition transition{mode};
+    transition.at[index(Stage::Signal)] = pendingSignal;
+    pendingSignal.reset();
+    ring.push_back(transition);
+    if (ring.size() > capacity)
+    {
+        ring.pop_front();
+    }
+    open = true;
+
+    armCheck();
+    interface.property_changed(propertyTransitions);
+}
+
+void ModeTrace::mark(Stage stage)
+{
+    if (!open)
+    {
+        return;
+    }
+    auto& transition = ring.back();
+    auto& at = transition.at[index(stage)];
+    if (at)
+    {
+        return;
+    }
+
+    at = steady_clock::now();
+    if (stage == lastStage(transition.mode))
+    {
+        transition.complete = true;
+        close();
+    }
+    interface.property_changed(propertyTransitions);
+
+    if (open && stage == Stage::TimedateNtp)
+    {
+        check();
+    }
+}
+
+void ModeTrace::onNtp(bool ntp)
+{
+    if (open && ntp == (Mode::NTP == ring.back().mode))
+    {
+        mark(Stage::TimedateNtp);
+    }
+}
+
+void ModeTrace::onSynchronized(bool synchronized)
+{
+    if (synchronized && open && Mode::NTP == ring.back().mode)
+    {
+        mark(Stage::Synchronized);
+    }
+}
+
+void ModeTrace::check()
+{
+    if (!open)
+    {
+        return;
+    }
+
+    const auto& transition = ring.back();
+    auto first = std::ranges::find_if(transition.at, reached);
+    if (first != transition.at.end() &&
+        steady_clock::now() - **first >= settleTimeout)
+    {
+        close();
+        interface.property_changed(propertyTransitions);
+        return;
+    }
+
+    // The sync is only looked for once the NTP daemon is started
+    if (Mode::NTP == transition.mode &&
+        transition.at[index(Stage::TimedateNtp)])
+    {
+        auto discipline = clock.discipline();
+        if (discipline && discipline->synchronized)
+        {
+            mark(Stage::Synchronized);
+            return;
+        }
+    }
+
+    armCheck();
+}
+
+const char* ModeTrace::toString(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::Signal:
+            return "signal";
+        case Stage::NtpIssued:
+            return "ntp-issued";
+        case Stage::NtpReturned:
+            return "ntp-returned";
+        case Stage::TimedateNtp:
+            return "timedate-ntp";
+        default:
+            return "synchronized";
+    }
+}
+
+void ModeTrace::armCheck()
+{
+    // A switch to Manual mode only waits for the timeout
+    if (Mode::NTP == ring.back().mode)
+    {
+        timer.armRelative(checkInterval);
+    }
+    else
+    {
+        timer.armRelative(settleTimeout);
+    }
+}
+
+void ModeTrace::close()
+{
+    open = false;
+    timer.disarm();
+}
+
+const sdbusplus::vtable_t ModeTrace::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyTransitions, "a(sba(st))",
+                                getTransitions, emitsChange),
+    sdbusplus::vtable::end(),
+};
+
+int ModeTrace::getTransitions(sd_bus* /* bus */, const char* /* path */,
+                              const char* /* intf */,
+                              const char* /* property */,
+                              sd_bus_message* reply, void* userdata,
+                              sd_bus_error* /* error */)
+{
+    const auto* trace = static_cast<const ModeTrace*>(userdata);
+
+    auto r = sd_bus_message_open_container(reply, 'a', "(sba(st))");
+    for (const auto& transition : trace->transitions())
+    {
+        if (r >= 0)
+        {
+            r = sd_bus_message_open_container(reply, 'r', "sba(st)");
+        }
+        if (r >= 0)
+        {
+            auto mode = utils::modeToStr(transition.mode);
+            int complete = transition.complete ? 1 : 0;
+            r = sd_bus_message_append(reply, "sb", mode.c_str(), complete);
+        }
+        if (r >= 0)
+        {
+            r = sd_bus_message_open_container(reply, 'a', "(st)");
+        }
+        for (size_t i = 0; i < stageCount && r >= 0; ++i)
+        {
+            auto stage = static_cast<Stage>(i);
+            auto duration = transition.duration(stage);
+            if (duration)
+            {
+                uint64_t usec = std::max<int64_t>(duration->count(), 0);
+                r = sd_bus_message_append(reply, "(st)", toString(stage),
+                                          usec);
+            }
+        }
+        if (r >= 0)
+        {
+            r = sd_bus_message_close_container(reply);
+        }
+        if (r >= 0)
+        {
+            r = sd_bus_message_close_container(reply);
+        }
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    return sd_bus_message_close_container(reply);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "clock.hpp"
+#include "event_timer.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <optional>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class ModeTrace
+ *  @brief Time the switches of the time mode end to end.
+ *  @details A switch made through the settings passes through stages in
+ *  the daemon, in systemd time service and in the NTP daemon, each of which
+ *  is timestamped on CLOCK_MONOTONIC, so a step of the clock by the sync
+ *  does not skew the durations:
+ *  - signal: the settings signal with the new mode is received
+ *  - ntp-issued: SetNTP is called on systemd time service
+ *  - ntp-returned: SetNTP returned
+ *  - timedate-ntp: systemd time service signals the new NTP property
+ *  - synchronized: in NTP mode only, systemd time service signals
+ *    NTPSynchronized, or the kernel no longer flags the clock unsynchronized
+ *
+ *  A switch is complete once its last stage is reached. It is closed
+ *  incomplete by the next switch, or after settleTimeout without a sync.
+ *  The kernel flag is checked every checkInterval once a switch to NTP
+ *  reached timedate-ntp. As the kernel may still take the clock as
+ *  synchronized from an earlier NTP mode, the sync can be reached together
+ *  with timedate-ntp.
+ *
+ *  The last switches are kept in a ring, published as
+ *  xyz.openbmc_project.Time.Manager.ModeTrace:
+ *  - Transitions a(sba(st)): oldest first, the new mode, whether the
+ *    switch is complete, and its stages with the time since the previous
+ *    stage in microseconds
+ */
+class ModeTrace
+{
+  public:
+    /** @brief The time of a stage */
+    using Timestamp = std::chrono::steady_clock::time_point;
+
+    /** @brief The stages of a switch, in their order */
+    enum class Stage
+    {
+        Signal,
+        NtpIssued,
+        NtpReturned,
+        TimedateNtp,
+        Synchronized,
+    };
+
+    /** @brief The number of stages */
+    static constexpr size_t stageCount = 5;
+
+    /** @brief A switch of the time mode */
+    struct Transition
+    {
+        /** @brief The new mode */
+        Mode mode;
+
+        /** @brief The time each stage is reached, if it is */
+        std::array<std::optional<Timestamp>, stageCount> at{};
+
+        /** @brief Whether the last stage is reached */
+        bool complete = false;
+
+        /** @brief Get the time since the previous stage reached
+         *
+         * @param[in] stage - The stage
+         *
+         * @return The duration, 0 for the first stage, std::nullopt if the
+         *         stage is not reached
+         */
+        std::optional<std::chrono::microseconds> duration(Stage stage) const;
+
+        /** @brief Get the time from the first to the last stage reached */
+        std::chrono::microseconds total() const;
+    };
+
+    /** @brief Constructor
+     *
+     * @param[in] bus      - The Dbus bus object
+     * @param[in] objPath  - The object to add the interface to
+     * @param[in] clock    - The clock whose kernel flag is checked
+     * @param[in] capacity - The number of switches kept
+     */
+    ModeTrace(sdbusplus::bus_t& bus, const char* objPath, const Clock& clock,
+              size_t capacity = defaultCapacity);
+    ~ModeTrace() = default;
+
+    ModeTrace(const ModeTrace&) = delete;
+    ModeTrace(ModeTrace&&) = delete;
+    ModeTrace& operator=(const ModeTrace&) = delete;
+    ModeTrace& operator=(ModeTrace&&) = delete;
+
+    /** @brief Note a settings signal, the first stage of the next switch
+     *
+     * @param[in] received - When the signal is received
+     */
+    void signal(Timestamp received);
+
+    /** @brief Start a switch, closing an open one
+     *
+     * @param[in] mode - The new mode
+     */
+    void begin(Mode mode);
+
+    /** @brief Reach a stage of the open switch, unless it is reached */
+    void mark(Stage stage);
+
+    /** @brief Reach timedate-ntp if the NTP property is the new one */
+    void onNtp(bool ntp);
+
+    /** @brief Reach synchronized if NTPSynchronized turned true */
+    void onSynchronized(bool synchronized);
+
+    /** @brief Check the kernel flag and the timeout, called by the timer */
+    void check();
+
+    /** @brief Get the switches kept, oldest first */
+    const std::deque<Transition>& transitions() const
+    {
+        return ring;
+    }
+
+    /** @brief Get the name of a stage */
+    static const char* toString(Stage stage);
+
+    /** @brief The switches kept by default */
+    static constexpr size_t defaultCapacity = 16;
+
+    /** @brief The interval of the checks of the kernel flag */
+    static constexpr std::chrono::seconds checkInterval{1};
+
+    /** @brief The time after which a switch waiting for the sync is closed */
+    static constexpr std::chrono::minutes settleTimeout{15};
+
+  private:
+    /** @brief The clock whose kernel flag is checked */
+    const Clock& clock;
+
+    /** @brief The number of switches kept */
+    size_t capacity;
+
+    /** @brief The switches kept, the last one may be open */
+    std::deque<Transition> ring;
+
+    /** @brief Whether the last switch is open */
+    bool open = false;
+
+    /** @brief The settings signal not taken by a switch yet */
+    std::optional<Timestamp> pendingSignal;
+
+    /** @brief The timer of the checks of the kernel flag */
+    EventTimer timer;
+
+    /** @brief The ModeTrace interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the ModeTrace interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Schedule the next check of the open switch */
+    void armCheck();
+
+    /** @brief Close the open switch */
+    void close();
+
+    static int getTransitions(sd_bus* bus, const char* path, const char* intf,
+                              const char* property, sd_bus_message* reply,
+                              void* userdata, sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
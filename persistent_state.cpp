@@ -0,0 +1,109 @@
+#include "persistent_state.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+namespace phosphor
+{
+namespace time
+{
+namespace state
+{
+
+PHOSPHOR_LOG2_USING;
+
+namespace // anonymous
+{
+constexpr auto keyMode = "mode";
+constexpr auto keySettingsPath = "settingsPath";
+constexpr auto keySettingsService = "settingsService";
+constexpr auto keyNtp = "ntp";
+} // namespace
+
+std::optional<State> load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+
+    std::map<std::string, std::string> values;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        auto pos = line.find('=');
+        if (pos == std::string::npos)
+        {
+            continue;
+        }
+        values.emplace(line.substr(0, pos), line.substr(pos + 1));
+    }
+
+    for (const auto* key :
+         {keyMode, keySettingsPath, keySettingsService, keyNtp})
+    {
+        if (!values.contains(key) || values[key].empty())
+        {
+            error("Invalid state file {PATH}, missing {KEY}", "PATH", path,
+                  "KEY", key);
+            return std::nullopt;
+        }
+    }
+
+    State state;
+    try
+    {
+        state.mode = utils::strToMode(values[keyMode]);
+    }
+    catch (const sdbusplus::exception_t& ex)
+    {
+        error("Invalid mode in state file {PATH}: {ERROR}", "PATH", path,
+              "ERROR", ex);
+        return std::nullopt;
+    }
+    state.settingsPath = values[keySettingsPath];
+    state.settingsService = values[keySettingsService];
+    state.ntp = (values[keyNtp] == "1");
+    return state;
+}
+
+bool save(const std::string& path, const State& state)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    auto tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        file << keyMode << '=' << utils::modeToStr(state.mode) << '\n'
+             << keySettingsPath << '=' << state.settingsPath << '\n'
+             << keySettingsService << '=' << state.settingsService << '\n'
+             << keyNtp << '=' << (state.ntp ? 1 : 0) << '\n';
+        if (!file.flush())
+        {
+            error("Failed to write state file {PATH}", "PATH", tmpPath);
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        error("Failed to rename state file {PATH}: {ERROR}", "PATH", path,
+              "ERROR", ec.message());
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace state
+} // namespace time
+} // namespace phosphor
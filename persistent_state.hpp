@@ -0,0 +1,58 @@
+#pragma once
+
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <optional>
+#include <string>
+
+namespace phosphor
+{
+namespace time
+{
+namespace state
+{
+
+/** @brief The state kept across an idle exit
+ *
+ * Restoring it lets a D-Bus activated restart skip the mapper lookups and
+ * the forced NTP sync that a cold start does.
+ */
+struct State
+{
+    /** @brief The time mode when the daemon exited */
+    Mode mode = Mode::Manual;
+
+    /** @brief The resolved time sync method settings object path */
+    utils::Path settingsPath;
+
+    /** @brief The service that owned the settings object */
+    utils::Service settingsService;
+
+    /** @brief The last known NTP property of systemd time service */
+    bool ntp = false;
+};
+
+/** @brief Load the state from a file
+ *
+ * @param[in] path - The path of the state file
+ *
+ * @return The state, or std::nullopt if the file is missing or invalid
+ */
+std::optional<State> load(const std::string& path);
+
+/** @brief Save the state to a file atomically
+ *
+ * The state is written to a temporary file that is renamed over the
+ * target, so a reader never sees a partial file.
+ *
+ * @param[in] path  - The path of the state file
+ * @param[in] state - The state to save
+ *
+ * @return true if the state is saved
+ */
+bool save(const std::string& path, const State& state);
+
+} // namespace state
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "config.h"
+
+/** @brief Static USDT probes for bpftrace and perf
+ *
+ * With -Dusdt=enabled each TIME_PROBE() becomes a single nop in the
+ * instruction stream, plus a note in the ELF describing the location and
+ * the arguments. Tracers patch the nop when they attach, so an unused
+ * probe costs nothing. Without the option the probes are compiled out.
+ *
+ * The provider is phosphor_time_manager, e.g. in bpftrace:
+ *   usdt:/usr/bin/phosphor-time-manager:phosphor_time_manager:elapsed_get_entry
+ * and `bpftrace -l 'usdt:/usr/bin/phosphor-time-manager:*'` lists them all.
+ */
+#if HAVE_USDT
+#include <sys/sdt.h>
+#define TIME_PROBE(...) STAP_PROBEV(phosphor_time_manager, __VA_ARGS__)
+#else
+#define TIME_PROBE(...)                                                        \
+    do                                                                         \
+    {                                                                          \
+    } while (0)
+#endif
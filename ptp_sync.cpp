@@ -0,0 +1,593 @@
+#include "ptp_sync.hpp"
+
+#include "types.hpp"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <utility>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto propertyEnabled = "Enabled";
+constexpr auto propertySynchronized = "Synchronized";
+constexpr auto propertyOffset = "Offset";
+constexpr auto propertyPathDelay = "PathDelay";
+constexpr auto propertyStepsRemoved = "StepsRemoved";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+
+constexpr auto systemdService = "org.freedesktop.systemd1";
+constexpr auto systemdPath = "/org/freedesktop/systemd1";
+constexpr auto systemdInterface = "org.freedesktop.systemd1.Manager";
+constexpr auto systemdUnitInterface = "org.freedesktop.systemd1.Unit";
+
+// IEEE 1588 management messages, as sent by pmc
+constexpr uint8_t messageManagement = 0x0d;
+constexpr uint8_t versionPtp = 0x02;
+constexpr uint8_t controlManagement = 0x04;
+constexpr uint8_t actionGet = 0;
+constexpr uint8_t actionResponse = 2;
+constexpr uint16_t tlvManagement = 0x0001;
+constexpr uint16_t tlvManagementErrorStatus = 0x0002;
+constexpr uint16_t idCurrentDataSet = 0x2001;
+
+constexpr size_t offsetSequence = 30;
+constexpr size_t offsetAction = 46;
+constexpr size_t offsetTlv = 48;
+constexpr size_t offsetData = 54;
+
+uint16_t readU16(std::span<const uint8_t> m, size_t i)
+{
+    return static_cast<uint16_t>((m[i] << 8) | m[i + 1]);
+}
+
+int64_t readI64(std::span<const uint8_t> m, size_t i)
+{
+    uint64_t value = 0;
+    for (size_t j = 0; j < 8; ++j)
+    {
+        value = (value << 8) | m[i + j];
+    }
+    return static_cast<int64_t>(value);
+}
+
+void writeU16(std::span<uint8_t> m, size_t i, uint16_t value)
+{
+    m[i] = value >> 8;
+    m[i + 1] = value & 0xff;
+}
+
+utils::Error badMessage(std::string message)
+{
+    return utils::Error{-EBADMSG, "", std::move(message)};
+}
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+using namespace std::chrono;
+namespace common = sdbusplus::xyz::openbmc_project::Common::Error;
+
+PtpSync::PtpSync(sdbusplus::bus_t& bus, const char* objPath,
+                 TimeEvents& events, std::filesystem::path socket,
+                 Mode mode, SetManual setManual, Backend backend,
+                 Active active) :
+    eventLoop(bus.get_event()), events(events), socketPath(std::move(socket)),
+    setManual(std::move(setManual)), backend(std::move(backend)),
+    timer(eventLoop, CLOCK_MONOTONIC, [this]() { poll(); }, milliseconds(250)),
+    interface(bus, objPath, ptpIntf, vtable, this)
+{
+    events.subscribe(*this);
+
+    // linuxptp left running, e.g. by an idle exit, is taken over again.
+    // A socket file tells nothing, as a killed ptp4l leaves it behind, so
+    // systemd is asked. The ModeChanged of the startup was published
+    // before this subscribed, so the mode is reconciled here: in NTP mode
+    // the units are stopped, as the NTP daemon steers the clock.
+    auto running = active();
+    if (!running)
+    {
+        error("Failed to get the state of linuxptp: {ERROR}", "ERROR",
+              running.error().message);
+        return;
+    }
+    if (!*running)
+    {
+        return;
+    }
+
+    if (mode == Mode::Manual)
+    {
+        auto result = enable(true);
+        if (result)
+        {
+            return;
+        }
+        error("Failed to resume the time sync by PTP: {ERROR}", "ERROR",
+              result.error().message);
+    }
+
+    auto result = backend(false);
+    if (!result)
+    {
+        error("Failed to stop linuxptp: {ERROR}", "ERROR",
+              result.error().message);
+    }
+}
+
+PtpSync::~PtpSync()
+{
+    events.unsubscribe(*this);
+    close();
+}
+
+utils::Expected<void> PtpSync::enable(bool enable)
+{
+    if (enable == isEnabled)
+    {
+        return {};
+    }
+
+    if (enable)
+    {
+        auto manual = setManual();
+        if (!manual)
+        {
+            return manual;
+        }
+    }
+
+    auto result = backend(enable);
+    if (!result)
+    {
+        return result;
+    }
+
+    isEnabled = enable;
+    interface.property_changed(propertyEnabled);
+    info("Time sync by PTP: {ENABLED}", "ENABLED", enable);
+
+    awaiting = false;
+    missed = 0;
+    nextInterval = minInterval;
+    if (enable)
+    {
+        // ptp4l needs a moment to create its socket
+        timer.armRelative(minInterval);
+    }
+    else
+    {
+        timer.disarm();
+        close();
+        setSynchronized(false);
+    }
+    return {};
+}
+
+void PtpSync::poll()
+{
+    if (!isEnabled)
+    {
+        return;
+    }
+
+    if (awaiting && ++missed >= maxMissed)
+    {
+        if (missed == maxMissed)
+        {
+            warning("ptp4l does not answer on {PATH}", "PATH",
+                    socketPath.string());
+        }
+        setSynchronized(false);
+        nextInterval = minInterval;
+    }
+
+    auto opened = (fd >= 0) ? utils::Expected<void>{} : open();
+    if (opened)
+    {
+        auto request = makeRequest(++sequence);
+        if (send(fd, request.data(), request.size(),
+                 MSG_DONTWAIT | MSG_NOSIGNAL) < 0)
+        {
+            // ptp4l restarted or stopped, connected again on the next read
+            close();
+        }
+    }
+    awaiting = true;
+    timer.armRelative(nextInterval);
+}
+
+bool PtpSync::receive()
+{
+    bool received = false;
+    std::array<uint8_t, 128> message{};
+    while (fd >= 0)
+    {
+        auto n = recv(fd, message.data(), message.size(), MSG_DONTWAIT);
+        if (n < 0)
+        {
+            if (errno != EAGAIN && errno != EINTR)
+            {
+                close();
+            }
+            break;
+        }
+
+        auto dataSet = parseResponse(
+            std::span<const uint8_t>(message.data(), n), sequence);
+        if (!dataSet)
+        {
+            // A stale response to a request that was given up on
+            debug("Skipped a message of ptp4l: {ERROR}", "ERROR",
+                  dataSet.error().message);
+            continue;
+        }
+        update(*dataSet);
+        received = true;
+    }
+    return received;
+}
+
+void PtpSync::onEvent(const event::ModeChanged& event)
+{
+    if (event.mode != Mode::NTP || !isEnabled)
+    {
+        return;
+    }
+
+    auto result = enable(false);
+    if (!result)
+    {
+        error("Failed to stop the time sync by PTP: {ERROR}", "ERROR",
+              result.error().message);
+    }
+}
+
+std::array<uint8_t, PtpSync::requestSize> PtpSync::makeRequest(
+    uint16_t sequence)
+{
+    std::array<uint8_t, requestSize> m{};
+    m[0] = messageManagement;
+    m[1] = versionPtp;
+    writeU16(m, 2, requestSize);
+    // The source port identity is left zero, ptp4l answers to the socket
+    writeU16(m, offsetSequence, sequence);
+    m[32] = controlManagement;
+    m[33] = 0x7f; // logMessageInterval
+    // Any target port, and no boundary hops so only ptp4l itself answers
+    std::fill_n(m.begin() + 34, 10, 0xff);
+    m[offsetAction] = actionGet;
+    writeU16(m, offsetTlv, tlvManagement);
+    writeU16(m, offsetTlv + 2, 2); // the management id, no data
+    writeU16(m, offsetTlv + 4, idCurrentDataSet);
+    return m;
+}
+
+utils::Expected<PtpSync::DataSet> PtpSync::parseResponse(
+    std::span<const uint8_t> message, uint16_t sequence)
+{
+    if (message.size() < offsetData ||
+        (message[0] & 0x0f) != messageManagement)
+    {
+        return std::unexpected(badMessage("Not a management message"));
+    }
+    if (readU16(message, offsetSequence) != sequence)
+    {
+        return std::unexpected(badMessage("Unexpected sequence id"));
+    }
+    if ((message[offsetAction] & 0x0f) != actionResponse)
+    {
+        return std::unexpected(badMessage("Not a response"));
+    }
+
+    auto tlvType = readU16(message, offsetTlv);
+    auto id = readU16(message, offsetTlv + 4);
+    if (tlvType == tlvManagementErrorStatus)
+    {
+        // The error id sits where the management id of a response does
+        return std::unexpected(badMessage(
+            "Management error " + std::to_string(id) +
+            " for CURRENT_DATA_SET"));
+    }
+    if (tlvType != tlvManagement || id != idCurrentDataSet ||
+        readU16(message, offsetTlv + 2) < 20 || message.size() < responseSize)
+    {
+        return std::unexpected(badMessage("Not a CURRENT_DATA_SET"));
+    }
+
+    // The time intervals are in nanoseconds scaled by 2^16
+    DataSet dataSet;
+    dataSet.stepsRemoved = readU16(message, offsetData);
+    dataSet.offset = nanoseconds(readI64(message, offsetData + 2) / 65536);
+    dataSet.pathDelay = nanoseconds(readI64(message, offsetData + 10) / 65536);
+    return dataSet;
+}
+
+utils::Expected<void> PtpSync::controlUnits(
+    sdbusplus::bus_t& bus, const std::string& units, bool start)
+{
+    std::istringstream names(units);
+    std::string unit;
+    while (names >> unit)
+    {
+        auto method =
+            bus.new_method_call(systemdService, systemdPath, systemdInterface,
+                                start ? "StartUnit" : "StopUnit");
+        method.append(unit, "replace");
+        auto reply = utils::call(bus, method);
+        if (!reply)
+        {
+            return std::unexpected(std::move(reply.error()));
+        }
+    }
+    return {};
+}
+
+utils::Expected<bool> PtpSync::unitsActive(sdbusplus::bus_t& bus,
+                                           const std::string& units)
+{
+    std::istringstream names(units);
+    std::string unit;
+    while (names >> unit)
+    {
+        auto method = bus.new_method_call(systemdService, systemdPath,
+                                          systemdInterface, "GetUnit");
+        method.append(unit);
+        auto reply = utils::call(bus, method);
+        if (!reply)
+        {
+            // A unit that is not loaded is not running
+            if (reply.error().name == "org.freedesktop.systemd1.NoSuchUnit")
+            {
+                continue;
+            }
+            return std::unexpected(std::move(reply.error()));
+        }
+
+        sdbusplus::message::object_path path;
+        try
+        {
+            reply->read(path);
+        }
+        catch (const sdbusplus::exception_t& e)
+        {
+            return std::unexpected(
+                utils::Error{-EBADMSG, "", unit + ": " + e.what()});
+        }
+
+        auto state = utils::tryGetProperty<std::string>(
+            bus, systemdService, path.str.c_str(), systemdUnitInterface,
+            "ActiveState");
+        if (!state)
+        {
+            return std::unexpected(std::move(state.error()));
+        }
+        if (*state != "inactive" && *state != "failed")
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+utils::Expected<void> PtpSync::open()
+{
+    auto fail = [this](const char* what) {
+        auto e = errno;
+        close();
+        return std::unexpected(utils::Error{
+            -e, "", socketPath.string() + ": " + what + ": " +
+                        std::strerror(e)});
+    };
+
+    fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+    {
+        return fail("socket");
+    }
+
+    // An autobound abstract address, which ptp4l answers to and which
+    // leaves no file behind
+    sockaddr_un local{};
+    local.sun_family = AF_UNIX;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&local),
+             sizeof(local.sun_family)) < 0)
+    {
+        return fail("bind");
+    }
+
+    sockaddr_un remote{};
+    remote.sun_family = AF_UNIX;
+    if (socketPath.native().size() >= sizeof(remote.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return fail("connect");
+    }
+    std::strcpy(remote.sun_path, socketPath.c_str());
+    if (connect(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) < 0)
+    {
+        return fail("connect");
+    }
+
+    if (eventLoop != nullptr)
+    {
+        sd_event_source* es = nullptr;
+        auto r = sd_event_add_io(eventLoop, &es, fd, EPOLLIN, onReadable, this);
+        if (r < 0)
+        {
+            errno = -r;
+            return fail("sd_event_add_io");
+        }
+        ioSource.reset(es);
+    }
+    return {};
+}
+
+void PtpSync::close()
+{
+    ioSource.reset();
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void PtpSync::setSynchronized(bool value)
+{
+    if (value == isSynchronized)
+    {
+        return;
+    }
+    isSynchronized = value;
+    interface.property_changed(propertySynchronized);
+    info("The clock is synchronized by PTP: {SYNCHRONIZED}", "SYNCHRONIZED",
+         value);
+}
+
+void PtpSync::update(const DataSet& dataSet)
+{
+    awaiting = false;
+    missed = 0;
+
+    // The getters are called when the signal is built, so the data set is
+    // stored before the changes are emitted
+    auto previous = std::exchange(current, dataSet);
+    if (dataSet.offset != previous.offset)
+    {
+        interface.property_changed(propertyOffset);
+    }
+    if (dataSet.pathDelay != previous.pathDelay)
+    {
+        interface.property_changed(propertyPathDelay);
+    }
+    if (dataSet.stepsRemoved != previous.stepsRemoved)
+    {
+        interface.property_changed(propertyStepsRemoved);
+    }
+
+    bool locked =
+        dataSet.stepsRemoved > 0 && abs(dataSet.offset) <= lockThreshold;
+    setSynchronized(locked);
+    auto interval =
+        locked ? std::min(nextInterval * 2, maxInterval) : minInterval;
+    if (interval != nextInterval)
+    {
+        nextInterval = interval;
+        timer.armRelative(nextInterval);
+    }
+}
+
+int PtpSync::onReadable(sd_event_source* /* es */, int /* fd */,
+                        uint32_t /* revents */, void* userdata)
+{
+    static_cast<PtpSync*>(userdata)->receive();
+    return 0;
+}
+
+const sdbusplus::vtable_t PtpSync::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyEnabled, "b", getEnabled, writeEnabled,
+                                emitsChange),
+    sdbusplus::vtable::property(propertySynchronized, "b", getSynchronized,
+                                emitsChange),
+    sdbusplus::vtable::property(propertyOffset, "x", getOffset, emitsChange),
+    sdbusplus::vtable::property(propertyPathDelay, "x", getPathDelay,
+                                emitsChange),
+    sdbusplus::vtable::property(propertyStepsRemoved, "q", getStepsRemoved,
+                                emitsChange),
+    sdbusplus::vtable::end(),
+};
+
+int PtpSync::getEnabled(sd_bus* /* bus */, const char* /* path */,
+                        const char* /* intf */, const char* /* property */,
+                        sd_bus_message* reply, void* userdata,
+                        sd_bus_error* /* error */)
+{
+    const auto* ptp = static_cast<const PtpSync*>(userdata);
+    int enabled = ptp->enabled() ? 1 : 0;
+    return sd_bus_message_append(reply, "b", enabled);
+}
+
+int PtpSync::writeEnabled(sd_bus* /* bus */, const char* /* path */,
+                          const char* /* intf */, const char* /* property */,
+                          sd_bus_message* value, void* userdata,
+                          sd_bus_error* error)
+{
+    auto* ptp = static_cast<PtpSync*>(userdata);
+
+    int enabled = 0;
+    auto r = sd_bus_message_read(value, "b", &enabled);
+    if (r < 0)
+    {
+        return r;
+    }
+
+    auto result = ptp->enable(enabled != 0);
+    if (!result)
+    {
+        // An error that never left the bus has no name of its own
+        const auto& name = result.error().name;
+        return sd_bus_error_set(
+            error,
+            name.empty() ? common::InternalFailure().name() : name.c_str(),
+            result.error().message.c_str());
+    }
+    return 0;
+}
+
+int PtpSync::getSynchronized(sd_bus* /* bus */, const char* /* path */,
+                             const char* /* intf */,
+                             const char* /* property */, sd_bus_message* reply,
+                             void* userdata, sd_bus_error* /* error */)
+{
+    const auto* ptp = static_cast<const PtpSync*>(userdata);
+    int synchronized = ptp->synchronized() ? 1 : 0;
+    return sd_bus_message_append(reply, "b", synchronized);
+}
+
+int PtpSync::getOffset(sd_bus* /* bus */, const char* /* path */,
+                       const char* /* intf */, const char* /* property */,
+                       sd_bus_message* reply, void* userdata,
+                       sd_bus_error* /* error */)
+{
+    const auto* ptp = static_cast<const PtpSync*>(userdata);
+    int64_t offset = ptp->dataSet().offset.count();
+    return sd_bus_message_append(reply, "x", offset);
+}
+
+int PtpSync::getPathDelay(sd_bus* /* bus */, const char* /* path */,
+                          const char* /* intf */, const char* /* property */,
+                          sd_bus_message* reply, void* userdata,
+                          sd_bus_error* /* error */)
+{
+    const auto* ptp = static_cast<const PtpSync*>(userdata);
+    int64_t delay = ptp->dataSet().pathDelay.count();
+    return sd_bus_message_append(reply, "x", delay);
+}
+
+int PtpSync::getStepsRemoved(sd_bus* /* bus */, const char* /* path */,
+                             const char* /* intf */,
+                             const char* /* property */, sd_bus_message* reply,
+                             void* userdata, sd_bus_error* /* error */)
+{
+    const auto* ptp = static_cast<const PtpSync*>(userdata);
+    uint16_t steps = ptp->dataSet().stepsRemoved;
+    return sd_bus_message_append(reply, "q", steps);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "event_timer.hpp"
+#include "events.hpp"
+#include "utils.hpp"
+
+#include <systemd/sd-event.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class PtpSync
+ *  @brief Synchronize the clock by PTP through linuxptp.
+ *  @details The sync itself is done by ptp4l, and by phc2sys from the PTP
+ *  hardware clock to the system clock, which run as systemd units. PTP is
+ *  enabled on top of the Manual mode, as the NTP daemon and phc2sys must
+ *  not both steer the clock: enabling it switches to Manual mode and
+ *  disables NTP before the units are started, and switching to NTP mode
+ *  stops them.
+ *
+ *  While enabled, the CURRENT_DATA_SET of ptp4l is read from its UNIX
+ *  management socket, the transport of pmc, without blocking. The reads
+ *  back off from minInterval up to maxInterval while the offset stays
+ *  within lockThreshold, and start over at minInterval when it does not
+ *  or ptp4l stops answering.
+ *
+ *  The result is published as xyz.openbmc_project.Time.Manager.Ptp:
+ *  - Enabled b: whether the clock is synchronized by PTP, writable
+ *  - Synchronized b: whether ptp4l follows a master within lockThreshold
+ *  - Offset x: the offset from the master in nanoseconds
+ *  - PathDelay x: the mean path delay to the master in nanoseconds
+ *  - StepsRemoved q: the boundary clocks to the grandmaster, 0 when this
+ *    is the grandmaster or no master is found
+ */
+class PtpSync
+{
+  public:
+    /** @brief Switch to Manual mode and disable NTP */
+    using SetManual = std::function<utils::Expected<void>()>;
+
+    /** @brief Start or stop ptp4l and phc2sys */
+    using Backend = std::function<utils::Expected<void>(bool start)>;
+
+    /** @brief Get whether ptp4l or phc2sys is running */
+    using Active = std::function<utils::Expected<bool>()>;
+
+    /** @brief The CURRENT_DATA_SET of ptp4l */
+    struct DataSet
+    {
+        uint16_t stepsRemoved = 0;
+        std::chrono::nanoseconds offset{};
+        std::chrono::nanoseconds pathDelay{};
+    };
+
+    /** @brief The size of a GET of the CURRENT_DATA_SET */
+    static constexpr size_t requestSize = 54;
+
+    /** @brief The size of a response with the CURRENT_DATA_SET */
+    static constexpr size_t responseSize = 72;
+
+    /** @brief Constructor
+     *
+     * @param[in] bus       - The Dbus bus object
+     * @param[in] objPath   - The object to add the interface to
+     * @param[in] events    - The time events to subscribe to
+     * @param[in] socket    - The management socket of ptp4l
+     * @param[in] mode      - The time mode at startup
+     * @param[in] setManual - The function that switches to Manual mode
+     * @param[in] backend   - The function that starts or stops linuxptp
+     * @param[in] active    - The function that tells whether linuxptp runs
+     */
+    PtpSync(sdbusplus::bus_t& bus, const char* objPath, TimeEvents& events,
+            std::filesystem::path socket, Mode mode, SetManual setManual,
+            Backend backend, Active active);
+    ~PtpSync();
+
+    PtpSync(const PtpSync&) = delete;
+    PtpSync(PtpSync&&) = delete;
+    PtpSync& operator=(const PtpSync&) = delete;
+    PtpSync& operator=(PtpSync&&) = delete;
+
+    /** @brief Enable or disable the sync by PTP
+     *
+     * @param[in] enable - Whether to synchronize by PTP
+     *
+     * @return The error of switching to Manual mode or of the backend
+     */
+    utils::Expected<void> enable(bool enable);
+
+    /** @brief Send a GET of the CURRENT_DATA_SET to ptp4l and schedule the
+     *         next one, called by the timer */
+    void poll();
+
+    /** @brief Read the responses of ptp4l, called when the socket is
+     *         readable
+     *
+     * @return true if a data set is read
+     */
+    bool receive();
+
+    /** @brief Stop PTP when NTP mode is selected */
+    void onEvent(const event::ModeChanged& event);
+
+    /** @brief Get whether the clock is synchronized by PTP */
+    bool enabled() const
+    {
+        return isEnabled;
+    }
+
+    /** @brief Get whether ptp4l follows a master within lockThreshold */
+    bool synchronized() const
+    {
+        return isSynchronized;
+    }
+
+    /** @brief Get the data set last read */
+    const DataSet& dataSet() const
+    {
+        return current;
+    }
+
+    /** @brief Get the time until the next read */
+    std::chrono::seconds interval() const
+    {
+        return nextInterval;
+    }
+
+    /** @brief Build a GET of the CURRENT_DATA_SET
+     *
+     * @param[in] sequence - The sequence id of the message
+     */
+    static std::array<uint8_t, requestSize> makeRequest(uint16_t sequence);
+
+    /** @brief Parse a response with the CURRENT_DATA_SET
+     *
+     * @param[in] message  - The message received
+     * @param[in] sequence - The sequence id of the request
+     *
+     * @return The data set, or the error if the message is no response to
+     *         the request
+     */
+    static utils::Expected<DataSet> parseResponse(
+        std::span<const uint8_t> message, uint16_t sequence);
+
+    /** @brief Start or stop systemd units
+     *
+     * @param[in] bus   - The Dbus bus object
+     * @param[in] units - The unit names separated by spaces
+     * @param[in] start - Whether to start or stop them
+     */
+    static utils::Expected<void> controlUnits(
+        sdbusplus::bus_t& bus, const std::string& units, bool start);
+
+    /** @brief Get whether any of systemd units is active or activating
+     *
+     * @param[in] bus   - The Dbus bus object
+     * @param[in] units - The unit names separated by spaces
+     */
+    static utils::Expected<bool> unitsActive(sdbusplus::bus_t& bus,
+                                             const std::string& units);
+
+    /** @brief The largest offset of a synchronized clock */
+    static constexpr std::chrono::nanoseconds lockThreshold{1000};
+
+    /** @brief The first interval, and the one while not synchronized */
+    static constexpr std::chrono::seconds minInterval{2};
+
+    /** @brief The longest interval while synchronized */
+    static constexpr std::chrono::seconds maxInterval{64};
+
+    /** @brief The unanswered reads after which the sync is lost */
+    static constexpr unsigned maxMissed = 3;
+
+  private:
+    /** @brief The event loop, may be nullptr */
+    sd_event* eventLoop;
+
+    /** @brief The time events subscribed to */
+    TimeEvents& events;
+
+    /** @brief The management socket of ptp4l */
+    std::filesystem::path socketPath;
+
+    /** @brief The function that switches to Manual mode */
+    SetManual setManual;
+
+    /** @brief The function that starts or stops linuxptp */
+    Backend backend;
+
+    /** @brief Whether the clock is synchronized by PTP */
+    bool isEnabled = false;
+
+    /** @brief Whether ptp4l follows a master within lockThreshold */
+    bool isSynchronized = false;
+
+    /** @brief The data set last read */
+    DataSet current;
+
+    /** @brief The sequence id of the last request */
+    uint16_t sequence = 0;
+
+    /** @brief Whether the last request is not answered yet */
+    bool awaiting = false;
+
+    /** @brief The requests in a row that were not answered */
+    unsigned missed = 0;
+
+    /** @brief The time until the next read */
+    std::chrono::seconds nextInterval = minInterval;
+
+    /** @brief Our socket connected to ptp4l, -1 while closed */
+    int fd = -1;
+
+    std::function<void(sd_event_source*)> sdEventSourceDeleter =
+        [](sd_event_source* p) {
+            if (p != nullptr)
+            {
+                sd_event_source_unref(p);
+            }
+        };
+    using SdEventSource =
+        std::unique_ptr<sd_event_source, decltype(sdEventSourceDeleter)>;
+
+    /** @brief The event source of our socket */
+    SdEventSource ioSource{nullptr, sdEventSourceDeleter};
+
+    /** @brief The timer of the reads */
+    EventTimer timer;
+
+    /** @brief The Ptp interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the Ptp interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Connect our socket to ptp4l */
+    utils::Expected<void> open();
+
+    /** @brief Close our socket */
+    void close();
+
+    /** @brief Publish a new sync status and log the transition */
+    void setSynchronized(bool value);
+
+    /** @brief Publish the data set and back off the reads */
+    void update(const DataSet& dataSet);
+
+    static int onReadable(sd_event_source* es, int fd, uint32_t revents,
+                          void* userdata);
+
+    static int getEnabled(sd_bus* bus, const char* path, const char* intf,
+                          const char* property, sd_bus_message* reply,
+                          void* userdata, sd_bus_error* error);
+    static int writeEnabled(sd_bus* bus, const char* path, const char* intf,
+                            const char* property, sd_bus_message* value,
+                            void* userdata, sd_bus_error* error);
+    static int getSynchronized(sd_bus* bus, const char* path,
+                               const char* intf, const char* property,
+                               sd_bus_message* reply, void* userdata,
+                               sd_bus_error* error);
+    static int getOffset(sd_bus* bus, const char* path, const char* intf,
+                         const char* property, sd_bus_message* reply,
+                         void* userdata, sd_bus_error* error);
+    static int getPathDelay(sd_bus* bus, const char* path, const char* intf,
+                            const char* property, sd_bus_message* reply,
+                            void* userdata, sd_bus_error* error);
+    static int getStepsRemoved(sd_bus* bus, const char* path,
+                               const char* intf, const char* property,
+                               sd_bus_message* reply, void* userdata,
+                               sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,92 @@
+#include "rate_limiter.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+RateLimiter::RateLimiter(uint32_t ratePerMinute, uint32_t burst,
+                         size_t maxSenders) :
+    rate(ratePerMinute / 60.0), burst(std::max<uint32_t>(burst, 1)),
+    maxSenders(maxSenders), overflow{this->burst, {}, {}}
+{}
+
+bool RateLimiter::admit(std::string_view sender, Clock::time_point now)
+{
+    if (rate == 0)
+    {
+        return true;
+    }
+
+    auto it = buckets.find(sender);
+    if (it == buckets.end() &&
+        (buckets.size() < maxSenders || evictIdle(now)))
+    {
+        it = buckets.emplace(std::string(sender), Bucket{burst, now, {}})
+                 .first;
+    }
+
+    auto& bucket = (it == buckets.end()) ? overflow : it->second;
+    refill(bucket, now);
+    if (bucket.tokens < 1)
+    {
+        ++bucket.counters.rejected;
+        ++rejected;
+        return false;
+    }
+
+    bucket.tokens -= 1;
+    ++bucket.counters.admitted;
+    return true;
+}
+
+RateLimiter::Counters RateLimiter::counters(std::string_view sender) const
+{
+    auto it = buckets.find(sender);
+    return it == buckets.end() ? overflow.counters : it->second.counters;
+}
+
+std::map<std::string, RateLimiter::Counters, std::less<>>
+    RateLimiter::counters() const
+{
+    std::map<std::string, Counters, std::less<>> result;
+    for (const auto& [sender, bucket] : buckets)
+    {
+        result.emplace(sender, bucket.counters);
+    }
+    if (overflow.counters.admitted > 0 || overflow.counters.rejected > 0)
+    {
+        result.emplace(overflowSender, overflow.counters);
+    }
+    return result;
+}
+
+void RateLimiter::refill(Bucket& bucket, Clock::time_point now) const
+{
+    auto elapsed = duration<double>(now - bucket.last).count();
+    if (elapsed > 0)
+    {
+        bucket.tokens = std::min(burst, bucket.tokens + elapsed * rate);
+        bucket.last = now;
+    }
+}
+
+bool RateLimiter::evictIdle(Clock::time_point now)
+{
+    for (auto it = buckets.begin(); it != buckets.end();)
+    {
+        refill(it->second, now);
+        it = (it->second.tokens >= burst) ? buckets.erase(it) : std::next(it);
+    }
+
+    // A busy sender is never dropped, its bucket would start over full
+    return buckets.size() < maxSenders;
+}
+
+} // namespace time
+} // namespace phosphor
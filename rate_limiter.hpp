@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class RateLimiter
+ *  @brief Token bucket admission control keyed by the D-Bus sender.
+ *  @details Every sender gets its own bucket that holds up to burst tokens
+ *  and refills at rate tokens per second, so one client exhausting its
+ *  bucket does not delay the requests of the others. Admitting or rejecting
+ *  a known sender is a map lookup and does not allocate.
+ *
+ *  At most maxSenders buckets are kept. A new sender takes the slot of a
+ *  bucket that is full again, i.e. of an idle sender. While every tracked
+ *  sender is busy, the new senders share one more bucket, reported as
+ *  overflowSender. So a client cannot reset its bucket or push out a busy
+ *  one by connecting under ever new unique names, and a client holding all
+ *  slots throttles the new senders rather than locking them out.
+ */
+class RateLimiter
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief The admission counters of a sender */
+    struct Counters
+    {
+        uint64_t admitted = 0;
+        uint64_t rejected = 0;
+    };
+
+    /** @brief The name the counters of the shared bucket are reported as,
+     *         which is no valid bus name */
+    static constexpr std::string_view overflowSender = "(overflow)";
+
+    /** @brief Constructor
+     *
+     * @param[in] ratePerMinute - The sustained requests per minute per
+     *                            sender, 0 to admit every request
+     * @param[in] burst         - The requests a sender may issue at once
+     * @param[in] maxSenders    - The number of senders to track, the new
+     *                            senders share a bucket while all are busy
+     */
+    RateLimiter(uint32_t ratePerMinute, uint32_t burst, size_t maxSenders);
+
+    /** @brief Check if a request of the sender is admitted
+     *
+     * @param[in] sender - The unique bus name of the sender
+     * @param[in] now    - The current time
+     *
+     * @return true if the request is admitted, false if it is rejected
+     */
+    bool admit(std::string_view sender, Clock::time_point now = Clock::now());
+
+    /** @brief Get the counters of a sender
+     *
+     * @param[in] sender - The unique bus name of the sender
+     *
+     * @return The counters, those of the shared bucket if the sender is
+     *         not tracked
+     */
+    Counters counters(std::string_view sender) const;
+
+    /** @brief Get the counters of the tracked senders, and of the shared
+     *         bucket as overflowSender once it is used */
+    std::map<std::string, Counters, std::less<>> counters() const;
+
+    /** @brief Get the number of rejected requests of all senders */
+    uint64_t totalRejected() const
+    {
+        return rejected;
+    }
+
+  private:
+    /** @brief The token bucket of a sender */
+    struct Bucket
+    {
+        double tokens = 0;
+        Clock::time_point last;
+        Counters counters;
+    };
+
+    /** @brief The refill rate in tokens per second */
+    double rate;
+
+    /** @brief The capacity of a bucket */
+    double burst;
+
+    /** @brief The number of senders to track */
+    size_t maxSenders;
+
+    /** @brief The number of rejected requests of all senders */
+    uint64_t rejected = 0;
+
+    /** @brief The buckets of the tracked senders */
+    std::map<std::string, Bucket, std::less<>> buckets;
+
+    /** @brief The bucket shared by the senders without a slot */
+    Bucket overflow;
+
+    /** @brief Refill a bucket up to the given time */
+    void refill(Bucket& bucket, Clock::time_point now) const;
+
+    /** @brief Drop the buckets that are full again, i.e. of idle senders
+     *
+     * @return Whether a slot is free for a new sender
+     */
+    bool evictIdle(Clock::time_point now);
+};
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,208 @@
+#include "rtc_monitor.hpp"
+
+#include "types.hpp"
+
+#include <fcntl.h>
+#include <linux/rtc.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstring>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto propertyDrift = "Drift";
+constexpr auto propertyHealth = "Health";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+
+const char* toString(RtcMonitor::Health health)
+{
+    switch (health)
+    {
+        case RtcMonitor::Health::OK:
+            return "OK";
+        case RtcMonitor::Health::Drifted:
+            return "Drifted";
+        case RtcMonitor::Health::Failed:
+            return "Failed";
+        default:
+            return "Unknown";
+    }
+}
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+using namespace std::chrono;
+
+RtcMonitor::RtcMonitor(sdbusplus::bus_t& bus, const char* objPath,
+                       const Clock& clock, TimeEvents& events, Mode mode,
+                       std::filesystem::path device) :
+    clock(clock), events(events), device(std::move(device)),
+    ntpMode(mode == Mode::NTP),
+    timer(bus.get_event(), CLOCK_BOOTTIME, [this]() { check(); }, seconds(1)),
+    interface(bus, objPath, rtcIntf, vtable, this)
+{
+    events.subscribe(*this);
+    timer.armRelative(settleDelay);
+}
+
+RtcMonitor::~RtcMonitor()
+{
+    events.unsubscribe(*this);
+}
+
+utils::Expected<seconds> RtcMonitor::readRtc(const std::filesystem::path& device)
+{
+    auto fail = [&](const char* what) {
+        auto e = errno;
+        return std::unexpected(utils::Error{
+            -e, "", device.string() + ": " + what + ": " + std::strerror(e)});
+    };
+
+    int fd = open(device.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return fail("open");
+    }
+    rtc_time rtc{};
+    auto r = ioctl(fd, RTC_RD_TIME, &rtc);
+    auto e = errno;
+    close(fd);
+    if (r < 0)
+    {
+        errno = e;
+        return fail("RTC_RD_TIME");
+    }
+
+    // The RTC keeps UTC, as timedated does unless LocalRTC is set
+    tm tm{};
+    tm.tm_sec = rtc.tm_sec;
+    tm.tm_min = rtc.tm_min;
+    tm.tm_hour = rtc.tm_hour;
+    tm.tm_mday = rtc.tm_mday;
+    tm.tm_mon = rtc.tm_mon;
+    tm.tm_year = rtc.tm_year;
+    return seconds(timegm(&tm));
+}
+
+void RtcMonitor::check()
+{
+    auto rtc = readRtc(device);
+    if (!rtc)
+    {
+        // Busy while hwclock or timedated use it, which is no failure
+        if (rtc.error().errnum != -EBUSY)
+        {
+            if (status != Health::Failed)
+            {
+                error("Failed to read the RTC: {ERROR}", "ERROR",
+                      rtc.error().message);
+            }
+            setHealth(Health::Failed);
+        }
+        nextInterval = minInterval;
+        timer.armRelative(nextInterval);
+        return;
+    }
+
+    auto drift = *rtc - duration_cast<seconds>(clock.now());
+    if (drift != lastDrift)
+    {
+        lastDrift = drift;
+        interface.property_changed(propertyDrift);
+    }
+
+    if (abs(drift) <= tolerance)
+    {
+        driftSince.reset();
+        setHealth(Health::OK);
+        nextInterval = std::min(nextInterval * 2, maxInterval);
+        timer.armRelative(nextInterval);
+        return;
+    }
+
+    nextInterval = minInterval;
+    timer.armRelative(nextInterval);
+    if (!driftSince)
+    {
+        driftSince = clock.monotonic();
+    }
+    // In NTP mode the RTC may lag a jump until the next sync of the kernel
+    if (ntpMode && clock.monotonic() - *driftSince < kernelSyncDelay)
+    {
+        return;
+    }
+
+    if (status != Health::Drifted)
+    {
+        warning("The RTC is {DRIFT}s off the system clock", "DRIFT",
+                drift.count());
+    }
+    setHealth(Health::Drifted);
+}
+
+void RtcMonitor::onEvent(const event::Jump& event)
+{
+    // timedated writes the RTC on SetTime, while a step of anyone else is
+    // left to the kernel, if to anyone
+    driftSince.reset();
+    nextInterval = minInterval;
+    timer.armRelative(event.own ? microseconds(settleDelay)
+                                : microseconds(minInterval));
+}
+
+void RtcMonitor::onEvent(const event::ModeChanged& event)
+{
+    ntpMode = Mode::NTP == event.mode;
+}
+
+void RtcMonitor::setHealth(Health value)
+{
+    if (status == value)
+    {
+        return;
+    }
+    if (value == Health::OK && status != Health::Unknown)
+    {
+        info("The RTC agrees with the system clock again");
+    }
+    status = value;
+    interface.property_changed(propertyHealth);
+}
+
+const sdbusplus::vtable_t RtcMonitor::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyDrift, "x", getDrift, emitsChange),
+    sdbusplus::vtable::property(propertyHealth, "s", getHealth, emitsChange),
+    sdbusplus::vtable::end(),
+};
+
+int RtcMonitor::getDrift(sd_bus* /* bus */, const char* /* path */,
+                         const char* /* intf */, const char* /* property */,
+                         sd_bus_message* reply, void* userdata,
+                         sd_bus_error* /* error */)
+{
+    const auto* monitor = static_cast<const RtcMonitor*>(userdata);
+    int64_t drift = monitor->drift().count();
+    return sd_bus_message_append(reply, "x", drift);
+}
+
+int RtcMonitor::getHealth(sd_bus* /* bus */, const char* /* path */,
+                          const char* /* intf */, const char* /* property */,
+                          sd_bus_message* reply, void* userdata,
+                          sd_bus_error* /* error */)
+{
+    const auto* monitor = static_cast<const RtcMonitor*>(userdata);
+    return sd_bus_message_append(reply, "s", toString(monitor->health()));
+}
+
+} // namespace time
+} // namespace phosphor
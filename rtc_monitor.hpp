@@ -0,0 +1,177 @@
+#pragma once
+
+#include "clock.hpp"
+#include "event_timer.hpp"
+#include "events.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class RtcMonitor
+ *  @brief Check the hardware RTC against the system clock.
+ *  @details The RTC is read with the RTC_RD_TIME ioctl on a timer. The
+ *  interval doubles up to maxInterval while the two clocks agree within
+ *  the tolerance, and starts over at minInterval when they do not or the
+ *  RTC cannot be read. A step made through SetTime, e.g. by a set of
+ *  Elapsed, is checked settleDelay later, once timedated has written the
+ *  RTC. A jump made by anyone else is checked after minInterval.
+ *
+ *  In NTP mode the kernel writes the system time to the RTC every 11
+ *  minutes, so the RTC may lag a jump of the NTP daemon for that long. A
+ *  drift is only reported as Drifted once it lasted kernelSyncDelay.
+ *
+ *  The device is opened for each read only, as an RTC device can be
+ *  opened once at a time and hwclock or timedated must not find it busy.
+ *
+ *  The result is published as xyz.openbmc_project.Time.Manager.Rtc:
+ *  - Drift: the RTC minus the system clock, in seconds, the resolution of
+ *    the RTC
+ *  - Health: "Unknown" until the first check, "OK" if the clocks agree,
+ *    "Drifted" if they do not and "Failed" if the RTC cannot be read, e.g.
+ *    as it lost its time with its battery
+ */
+class RtcMonitor
+{
+  public:
+    /** @brief The result of the last check */
+    enum class Health
+    {
+        Unknown,
+        OK,
+        Drifted,
+        Failed,
+    };
+
+    /** @brief Constructor
+     *
+     * @param[in] bus     - The Dbus bus object
+     * @param[in] objPath - The object to add the interface to
+     * @param[in] clock   - The system clock to check against
+     * @param[in] events  - The time events to subscribe to
+     * @param[in] mode    - The time mode at startup
+     * @param[in] device  - The RTC device, e.g. /dev/rtc0
+     */
+    RtcMonitor(sdbusplus::bus_t& bus, const char* objPath, const Clock& clock,
+               TimeEvents& events, Mode mode, std::filesystem::path device);
+    ~RtcMonitor();
+
+    RtcMonitor(const RtcMonitor&) = delete;
+    RtcMonitor(RtcMonitor&&) = delete;
+    RtcMonitor& operator=(const RtcMonitor&) = delete;
+    RtcMonitor& operator=(RtcMonitor&&) = delete;
+
+    /** @brief Read the RTC, publish the result and schedule the next
+     *         check, called by the timer */
+    void check();
+
+    /** @brief Check again after the clock is stepped, soon if it was
+     *         stepped by this daemon */
+    void onEvent(const event::Jump& event);
+
+    /** @brief Allow for the RTC sync of the kernel in NTP mode */
+    void onEvent(const event::ModeChanged& event);
+
+    /** @brief Get the RTC minus the system clock at the last check */
+    std::chrono::seconds drift() const
+    {
+        return lastDrift;
+    }
+
+    /** @brief Get the result of the last check */
+    Health health() const
+    {
+        return status;
+    }
+
+    /** @brief Get the time until the next check */
+    std::chrono::seconds interval() const
+    {
+        return nextInterval;
+    }
+
+    /** @brief Read the RTC
+     *
+     * @param[in] device - The RTC device
+     *
+     * @return The time of the RTC or the error of reading it
+     */
+    static utils::Expected<std::chrono::seconds>
+        readRtc(const std::filesystem::path& device);
+
+    /** @brief The drift at which the clocks no longer agree, more than the
+     *         second the RTC resolves */
+    static constexpr std::chrono::seconds tolerance{2};
+
+    /** @brief The first interval, and the one while the clocks disagree */
+    static constexpr std::chrono::seconds minInterval{64};
+
+    /** @brief The longest interval while the clocks agree */
+    static constexpr std::chrono::seconds maxInterval{4096};
+
+    /** @brief The delay of the check after a step through SetTime */
+    static constexpr std::chrono::seconds settleDelay{1};
+
+    /** @brief The time a drift may last in NTP mode before it is reported,
+     *         the period the kernel writes the system time to the RTC */
+    static constexpr std::chrono::minutes kernelSyncDelay{11};
+
+  private:
+    /** @brief The system clock to check against */
+    const Clock& clock;
+
+    /** @brief The time events subscribed to */
+    TimeEvents& events;
+
+    /** @brief The RTC device */
+    std::filesystem::path device;
+
+    /** @brief Whether the time mode is NTP */
+    bool ntpMode;
+
+    /** @brief The monotonic time the clocks are found apart since, unset
+     *         while they agree or after a jump */
+    std::optional<std::chrono::microseconds> driftSince;
+
+    /** @brief The drift at the last check */
+    std::chrono::seconds lastDrift{};
+
+    /** @brief The result of the last check */
+    Health status = Health::Unknown;
+
+    /** @brief The time until the next check */
+    std::chrono::seconds nextInterval = minInterval;
+
+    /** @brief The timer of the checks */
+    EventTimer timer;
+
+    /** @brief The Rtc interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the Rtc interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Publish a new health and log the transition */
+    void setHealth(Health value);
+
+    static int getDrift(sd_bus* bus, const char* path, const char* intf,
+                        const char* property, sd_bus_message* reply,
+                        void* userdata, sd_bus_error* error);
+    static int getHealth(sd_bus* bus, const char* path, const char* intf,
+                         const char* property, sd_bus_message* reply,
+                         void* userdata, sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
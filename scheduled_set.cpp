@@ -0,0 +1,227 @@
+#include "scheduled_set.hpp"
+
+#include "types.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <algorithm>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto methodNameSchedule = "Schedule";
+constexpr auto methodNameCancel = "Cancel";
+constexpr auto propertyPending = "Pending";
+constexpr auto propertyLastJitter = "LastJitter";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+namespace common = sdbusplus::xyz::openbmc_project::Common::Error;
+using namespace std::chrono;
+
+ScheduledSet::ScheduledSet(sdbusplus::bus_t& bus, const char* objPath,
+                           const Clock& clock, Step step, Admit admit) :
+    clock(clock), step(std::move(step)), admit(std::move(admit)),
+    timer(bus.get_event(), CLOCK_BOOTTIME, [this]() { apply(); },
+          microseconds(1)),
+    interface(bus, objPath, scheduledSetIntf, vtable, this)
+{}
+
+utils::Expected<uint64_t> ScheduledSet::schedule(microseconds time,
+                                                 microseconds deadline,
+                                                 const char* sender)
+{
+    // Checked before queueing, the set is applied without a sender
+    if (sender && admit)
+    {
+        auto admitted = admit(sender);
+        if (!admitted)
+        {
+            return std::unexpected(std::move(admitted.error()));
+        }
+    }
+    if (deadline <= clock.monotonic())
+    {
+        return std::unexpected(utils::Error{-EINVAL,
+                                            common::InvalidArgument().name(),
+                                            "The deadline has passed"});
+    }
+    if (entries.size() >= maxPending)
+    {
+        return std::unexpected(
+            utils::Error{-ENOSPC, common::TooManyResources().name(),
+                         "Too many scheduled sets are pending"});
+    }
+
+    Entry entry{nextId++, time, deadline};
+    auto pos = std::upper_bound(
+        entries.begin(), entries.end(), entry,
+        [](const Entry& a, const Entry& b) { return a.deadline < b.deadline; });
+    entries.insert(pos, entry);
+    interface.property_changed(propertyPending);
+    rearm();
+
+    info("Scheduled set {ID} of {ELAPSED}us at {DEADLINE}us of boot time",
+         "ID", entry.id, "ELAPSED", time.count(), "DEADLINE", deadline.count());
+    return entry.id;
+}
+
+bool ScheduledSet::cancel(uint64_t id)
+{
+    auto it = std::ranges::find(entries, id, &Entry::id);
+    if (it == entries.end())
+    {
+        return false;
+    }
+
+    entries.erase(it);
+    interface.property_changed(propertyPending);
+    rearm();
+    info("Cancelled scheduled set {ID}", "ID", id);
+    return true;
+}
+
+void ScheduledSet::apply()
+{
+    auto due = std::ranges::find_if(entries, [now = clock.monotonic()](
+                                                 const Entry& entry) {
+        return entry.deadline > now;
+    });
+    std::vector<Entry> sets(entries.begin(), due);
+    entries.erase(entries.begin(), due);
+
+    for (const auto& entry : sets)
+    {
+        // The clock reads as if it was stepped at the deadline: the step
+        // is relative, so the time it takes to reach the clock does not
+        // hold it back, and the lateness so far is added to it
+        auto late = clock.monotonic() - entry.deadline;
+        auto result = step(entry.time + late - clock.now());
+        if (!result)
+        {
+            error("Failed to apply scheduled set {ID}: {ERROR}", "ID",
+                  entry.id, "ERROR", result.error().message);
+            continue;
+        }
+        late = clock.monotonic() - entry.deadline;
+        jitter = late;
+        interface.property_changed(propertyLastJitter);
+        info("Applied scheduled set {ID} {JITTER}us late", "ID", entry.id,
+             "JITTER", late.count());
+    }
+
+    if (!sets.empty())
+    {
+        interface.property_changed(propertyPending);
+    }
+    rearm();
+}
+
+void ScheduledSet::rearm()
+{
+    if (entries.empty())
+    {
+        timer.disarm();
+        return;
+    }
+    timer.armAbsolute(entries.front().deadline);
+}
+
+const sdbusplus::vtable_t ScheduledSet::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method(methodNameSchedule, "tt", "t", methodSchedule),
+    sdbusplus::vtable::method(methodNameCancel, "t", "", methodCancel),
+    sdbusplus::vtable::property(propertyPending, "a(ttt)", getPending,
+                                emitsChange),
+    sdbusplus::vtable::property(propertyLastJitter, "x", getLastJitter,
+                                emitsChange),
+    sdbusplus::vtable::end(),
+};
+
+int ScheduledSet::methodSchedule(sd_bus_message* msg, void* userdata,
+                                 sd_bus_error* error)
+{
+    auto* scheduled = static_cast<ScheduledSet*>(userdata);
+
+    uint64_t time = 0;
+    uint64_t deadline = 0;
+    auto r = sd_bus_message_read(msg, "tt", &time, &deadline);
+    if (r < 0)
+    {
+        return r;
+    }
+
+    auto id = scheduled->schedule(microseconds(time), microseconds(deadline),
+                                  sd_bus_message_get_sender(msg));
+    if (!id)
+    {
+        return sd_bus_error_set(error, id.error().name.c_str(),
+                                id.error().message.c_str());
+    }
+    return sd_bus_reply_method_return(msg, "t", *id);
+}
+
+int ScheduledSet::methodCancel(sd_bus_message* msg, void* userdata,
+                               sd_bus_error* error)
+{
+    auto* scheduled = static_cast<ScheduledSet*>(userdata);
+
+    uint64_t id = 0;
+    auto r = sd_bus_message_read(msg, "t", &id);
+    if (r < 0)
+    {
+        return r;
+    }
+
+    if (!scheduled->cancel(id))
+    {
+        return sd_bus_error_set(error, common::ResourceNotFound().name(),
+                                "No such scheduled set is pending");
+    }
+    return sd_bus_reply_method_return(msg, "");
+}
+
+int ScheduledSet::getPending(sd_bus* /* bus */, const char* /* path */,
+                             const char* /* intf */, const char* /* property */,
+                             sd_bus_message* reply, void* userdata,
+                             sd_bus_error* /* error */)
+{
+    const auto* scheduled = static_cast<const ScheduledSet*>(userdata);
+
+    auto r = sd_bus_message_open_container(reply, 'a', "(ttt)");
+    for (const auto& entry : scheduled->pending())
+    {
+        if (r < 0)
+        {
+            return r;
+        }
+        uint64_t time = entry.time.count();
+        uint64_t deadline = entry.deadline.count();
+        r = sd_bus_message_append(reply, "(ttt)", entry.id, time, deadline);
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    return sd_bus_message_close_container(reply);
+}
+
+int ScheduledSet::getLastJitter(sd_bus* /* bus */, const char* /* path */,
+                                const char* /* intf */,
+                                const char* /* property */,
+                                sd_bus_message* reply, void* userdata,
+                                sd_bus_error* /* error */)
+{
+    const auto* scheduled = static_cast<const ScheduledSet*>(userdata);
+    int64_t jitter = scheduled->lastJitter().value_or(microseconds(0)).count();
+    return sd_bus_message_append(reply, "x", jitter);
+}
+
+} // namespace time
+} // namespace phosphor
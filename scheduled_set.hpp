@@ -0,0 +1,163 @@
+#pragma once
+
+#include "clock.hpp"
+#include "event_timer.hpp"
+#include "utils.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class ScheduledSet
+ *  @brief Set the time at a given instant of CLOCK_BOOTTIME.
+ *  @details A fleet of BMCs given the same time and the same deadline,
+ *  e.g. derived from a common reference, steps their clocks together
+ *  rather than whenever each Set arrives. The timer is an absolute one on
+ *  CLOCK_BOOTTIME with an accuracy of a microsecond, so sd_event does not
+ *  coalesce it. A set that is applied late is advanced by the lateness,
+ *  so the clock reads as if it was stepped on time. The step is relative
+ *  to the clock when it is applied, so the time the step takes to get
+ *  there is made up for as well.
+ *
+ *  The sets are managed through xyz.openbmc_project.Time.Manager.ScheduledSet:
+ *  - Schedule(t elapsed, t deadline) -> t id: step the clock to elapsed,
+ *    in microseconds since UTC, when CLOCK_BOOTTIME reaches deadline, in
+ *    microseconds. Fails with InvalidArgument if the deadline has passed
+ *    and with TooManyResources if maxPending sets are pending.
+ *  - Cancel(t id): drop a pending set, fails with ResourceNotFound if it
+ *    is not pending.
+ *  - Pending a(ttt): the id, the elapsed and the deadline of the pending
+ *    sets, the earliest first
+ *  - LastJitter x: the lateness of the last set applied, in microseconds,
+ *    measured once the step returned
+ */
+class ScheduledSet
+{
+  public:
+    /** @brief Step the clock by the given delta */
+    using Step =
+        std::function<utils::Expected<void>(std::chrono::microseconds delta)>;
+
+    /** @brief Admit a set requested by a D-Bus sender */
+    using Admit = std::function<utils::Expected<void>(const char* sender)>;
+
+    /** @brief A pending set */
+    struct Entry
+    {
+        uint64_t id;
+        std::chrono::microseconds time;
+        std::chrono::microseconds deadline;
+    };
+
+    /** @brief Constructor
+     *
+     * @param[in] bus     - The Dbus bus object
+     * @param[in] objPath - The object to add the interface to
+     * @param[in] clock   - The clock whose monotonic time the deadlines
+     *                      are on
+     * @param[in] step    - The function that steps the clock
+     * @param[in] admit   - The admission control of the senders, all are
+     *                      admitted if empty
+     */
+    ScheduledSet(sdbusplus::bus_t& bus, const char* objPath,
+                 const Clock& clock, Step step, Admit admit = {});
+    ~ScheduledSet() = default;
+
+    ScheduledSet(const ScheduledSet&) = delete;
+    ScheduledSet(ScheduledSet&&) = delete;
+    ScheduledSet& operator=(const ScheduledSet&) = delete;
+    ScheduledSet& operator=(ScheduledSet&&) = delete;
+
+    /** @brief Schedule a set
+     *
+     * @param[in] time     - The time to set, microseconds since UTC
+     * @param[in] deadline - The CLOCK_BOOTTIME to set it at
+     * @param[in] sender   - The D-Bus sender requesting it, if any
+     *
+     * @return The id of the set or the error
+     */
+    utils::Expected<uint64_t> schedule(std::chrono::microseconds time,
+                                       std::chrono::microseconds deadline,
+                                       const char* sender = nullptr);
+
+    /** @brief Cancel a pending set
+     *
+     * @param[in] id - The id of the set
+     *
+     * @return true if the set was pending
+     */
+    bool cancel(uint64_t id);
+
+    /** @brief Apply the sets that are due, called by the timer */
+    void apply();
+
+    /** @brief Get the pending sets, the earliest first */
+    const std::vector<Entry>& pending() const
+    {
+        return entries;
+    }
+
+    /** @brief Get the lateness of the last set applied, if any */
+    std::optional<std::chrono::microseconds> lastJitter() const
+    {
+        return jitter;
+    }
+
+    /** @brief The sets that may be pending at once */
+    static constexpr size_t maxPending = 16;
+
+  private:
+    /** @brief The clock whose monotonic time the deadlines are on */
+    const Clock& clock;
+
+    /** @brief The function that steps the clock */
+    Step step;
+
+    /** @brief The admission control of the senders */
+    Admit admit;
+
+    /** @brief The pending sets, sorted by deadline */
+    std::vector<Entry> entries;
+
+    /** @brief The id of the next set */
+    uint64_t nextId = 1;
+
+    /** @brief The lateness of the last set applied */
+    std::optional<std::chrono::microseconds> jitter;
+
+    /** @brief The timer of the earliest pending set */
+    EventTimer timer;
+
+    /** @brief The ScheduledSet interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the ScheduledSet interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Arm the timer for the earliest pending set, if any */
+    void rearm();
+
+    static int methodSchedule(sd_bus_message* msg, void* userdata,
+                              sd_bus_error* error);
+    static int methodCancel(sd_bus_message* msg, void* userdata,
+                            sd_bus_error* error);
+    static int getPending(sd_bus* bus, const char* path, const char* intf,
+                          const char* property, sd_bus_message* reply,
+                          void* userdata, sd_bus_error* error);
+    static int getLastJitter(sd_bus* bus, const char* path, const char* intf,
+                             const char* property, sd_bus_message* reply,
+                             void* userdata, sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,233 @@
+#include "scheduling.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+
+namespace phosphor
+{
+namespace time
+{
+
+PHOSPHOR_LOG2_USING;
+
+namespace // anonymous
+{
+constexpr auto propertiesIntf = "org.freedesktop.DBus.Properties";
+constexpr auto objectManagerIntf = "org.freedesktop.DBus.ObjectManager";
+constexpr auto introspectableIntf = "org.freedesktop.DBus.Introspectable";
+
+/** @brief The unique name of the sender, empty on a direct connection */
+std::string senderOf(sd_bus_message* msg)
+{
+    const auto* sender = sd_bus_message_get_sender(msg);
+    return sender ? sender : "";
+}
+} // namespace
+
+std::optional<sdbusplus::bus_t> openSignalBus(sd_event* event)
+{
+    try
+    {
+        auto signalBus = sdbusplus::bus::new_bus();
+        auto r = sd_bus_attach_event(signalBus.get(), event, priority::high);
+        if (r < 0)
+        {
+            error("Failed to attach the signal bus: {ERRNO}", "ERRNO", -r);
+            return std::nullopt;
+        }
+        return signalBus;
+    }
+    catch (const sdbusplus::exception_t& ex)
+    {
+        error("Failed to open the signal bus: {ERROR}", "ERROR", ex);
+        return std::nullopt;
+    }
+}
+
+ReadQueue::ReadQueue(sdbusplus::bus_t& bus, size_t budget, size_t maxQueued) :
+    bus(bus.get()), budget(std::max<size_t>(budget, 1)),
+    maxQueued(std::max<size_t>(maxQueued, 1))
+{
+    auto* event = bus.get_event();
+    if (!event)
+    {
+        return;
+    }
+
+    sd_event_source* es = nullptr;
+    auto r = sd_event_add_defer(event, &es, onDefer, this);
+    if (r < 0)
+    {
+        error("Failed to add the read queue: {ERRNO}", "ERRNO", -r);
+        return;
+    }
+    deferSource.reset(es);
+    sd_event_source_set_priority(es, priority::low);
+    sd_event_source_set_enabled(es, SD_EVENT_OFF);
+
+    sd_bus_slot* slot = nullptr;
+    r = sd_bus_add_filter(this->bus, &slot, onMessage, this);
+    if (r < 0)
+    {
+        error("Failed to add bus filter: {ERRNO}", "ERRNO", -r);
+        deferSource.reset();
+        return;
+    }
+    filterSlot.reset(slot);
+}
+
+ReadQueue::~ReadQueue()
+{
+    // Whatever is queued is served in order once the filter is gone
+    filterSlot.reset();
+    while (!queue.empty())
+    {
+        putBackOldest();
+    }
+    for (auto* msg : putBack)
+    {
+        sd_bus_message_unref(msg);
+    }
+}
+
+bool ReadQueue::isRead(uint8_t type, std::string_view interface,
+                       std::string_view member)
+{
+    if (type != SD_BUS_MESSAGE_METHOD_CALL)
+    {
+        return false;
+    }
+    if (interface == propertiesIntf)
+    {
+        return member == "Get" || member == "GetAll";
+    }
+    if (interface == objectManagerIntf)
+    {
+        return member == "GetManagedObjects";
+    }
+    return interface == introspectableIntf && member == "Introspect";
+}
+
+size_t ReadQueue::release()
+{
+    size_t n = 0;
+    for (; n < budget && !queue.empty(); ++n)
+    {
+        putBackOldest();
+    }
+    if (queue.empty() && deferSource)
+    {
+        sd_event_source_set_enabled(deferSource.get(), SD_EVENT_OFF);
+    }
+    return n;
+}
+
+void ReadQueue::putBackOldest()
+{
+    auto* msg = queue.front();
+    queue.pop_front();
+    enqueue(msg);
+}
+
+void ReadQueue::putBackSender(const std::string& sender)
+{
+    for (auto it = queue.begin(); it != queue.end();)
+    {
+        if (senderOf(*it) != sender)
+        {
+            ++it;
+            continue;
+        }
+        auto* msg = *it;
+        it = queue.erase(it);
+        enqueue(msg);
+    }
+    if (queue.empty() && deferSource)
+    {
+        sd_event_source_set_enabled(deferSource.get(), SD_EVENT_OFF);
+    }
+}
+
+void ReadQueue::enqueue(sd_bus_message* msg)
+{
+    // The read queue of the connection takes a reference of its own, ours
+    // is dropped when the filter sees the message again
+    auto r = sd_bus_enqueue_for_read(bus, msg);
+    if (r < 0)
+    {
+        // The connection is closing, the client gets no reply anyway
+        forget(msg);
+        sd_bus_message_unref(msg);
+        return;
+    }
+    putBack.insert(msg);
+}
+
+void ReadQueue::forget(sd_bus_message* msg)
+{
+    auto it = heldBySender.find(senderOf(msg));
+    if (it != heldBySender.end() && --it->second == 0)
+    {
+        heldBySender.erase(it);
+    }
+}
+
+int ReadQueue::onMessage(sd_bus_message* msg, void* userData,
+                         sd_bus_error* /* retError */)
+{
+    auto* self = static_cast<ReadQueue*>(userData);
+
+    if (auto it = self->putBack.find(msg); it != self->putBack.end())
+    {
+        self->putBack.erase(it);
+        self->forget(msg);
+        sd_bus_message_unref(msg);
+        return 0;
+    }
+
+    uint8_t type = 0;
+    sd_bus_message_get_type(msg, &type);
+    if (type != SD_BUS_MESSAGE_METHOD_CALL)
+    {
+        return 0;
+    }
+
+    const auto* interface = sd_bus_message_get_interface(msg);
+    const auto* member = sd_bus_message_get_member(msg);
+    auto sender = senderOf(msg);
+    if (!interface || !member || !isRead(type, interface, member))
+    {
+        if (!self->heldBySender.contains(sender))
+        {
+            return 0;
+        }
+
+        // The call waits for the earlier calls of its sender, held or put
+        // back, and is put back right after them
+        self->putBackSender(sender);
+        ++self->heldBySender[sender];
+        self->enqueue(sd_bus_message_ref(msg));
+        return 1;
+    }
+
+    if (self->queue.size() >= self->maxQueued)
+    {
+        self->putBackOldest();
+    }
+    self->queue.push_back(sd_bus_message_ref(msg));
+    ++self->heldBySender[sender];
+    sd_event_source_set_enabled(self->deferSource.get(), SD_EVENT_ON);
+
+    // Taken off the dispatch, there is no reply until it is put back
+    return 1;
+}
+
+int ReadQueue::onDefer(sd_event_source* /* source */, void* userData)
+{
+    static_cast<ReadQueue*>(userData)->release();
+    return 0;
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @brief The scheduling classes of the event loop
+ *  @details sd-event dispatches the pending source of the highest class
+ *  first, one source per iteration, so a source of a higher class waits
+ *  for at most the one dispatch in progress.
+ */
+namespace priority
+{
+/** @brief The clock jumps and the signals the mode sync follows */
+constexpr int high = SD_EVENT_PRIORITY_IMPORTANT;
+
+/** @brief The calls of the clients but reads, and the timers */
+constexpr int medium = SD_EVENT_PRIORITY_NORMAL;
+
+/** @brief The reads of the clients */
+constexpr int low = SD_EVENT_PRIORITY_IDLE;
+} // namespace priority
+
+/** @brief Open the connection of the signals the mode sync follows
+ *  @details A connection of its own to the bus of the default one, as the
+ *  default connection of the thread is cached and shared, attached to the
+ *  event loop in the high class.
+ *
+ * @param[in] event - The event loop
+ *
+ * @return The connection or nothing if it cannot be opened or attached, the
+ *         signals then arrive on the default connection
+ */
+std::optional<sdbusplus::bus_t> openSignalBus(sd_event* event);
+
+/** @class ReadQueue
+ *  @brief Dispatch the reads of the clients in the low class.
+ *  @details The calls of the clients all arrive on the one connection that
+ *  owns the bus name, in its medium class, and sd-bus dispatches them in
+ *  order. A bus filter takes the reads, i.e. Get, GetAll, GetManagedObjects
+ *  and Introspect, out of that order into a queue, which costs no more than
+ *  a reference. A defer source in the low class puts back up to budget of
+ *  them on the connection per iteration of the event loop, where they are
+ *  dispatched next. So a read waits while anything else is pending, and a
+ *  write or a signal arriving behind a flood of reads waits for at most
+ *  budget of them.
+ *
+ *  The calls of a client are still served in the order it sent them: any
+ *  other call of a sender with reads queued or put back is taken off as
+ *  well and put back right after them, so a Get sent before a Set never
+ *  sees the value of the Set.
+ *
+ *  At most maxQueued reads are kept, beyond that the oldest is put back for
+ *  each new one. Then the reads are served in order with the writes as
+ *  without the queue, so a sustained overload neither grows the memory nor
+ *  starves a read.
+ */
+class ReadQueue
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param[in] bus       - The Dbus bus object, without an event loop the
+     *                        reads are dispatched in order
+     * @param[in] budget    - The reads put back per iteration
+     * @param[in] maxQueued - The reads kept at most
+     */
+    explicit ReadQueue(sdbusplus::bus_t& bus, size_t budget = defaultBudget,
+                       size_t maxQueued = defaultMaxQueued);
+    ~ReadQueue();
+
+    ReadQueue(const ReadQueue&) = delete;
+    ReadQueue(ReadQueue&&) = delete;
+    ReadQueue& operator=(const ReadQueue&) = delete;
+    ReadQueue& operator=(ReadQueue&&) = delete;
+
+    /** @brief Whether a message is a read of a client
+     *
+     * @param[in] type      - The type of the message
+     * @param[in] interface - The interface of the message
+     * @param[in] member    - The member of the message
+     */
+    static bool isRead(uint8_t type, std::string_view interface,
+                       std::string_view member);
+
+    /** @brief Get the number of reads queued */
+    size_t queued() const
+    {
+        return queue.size();
+    }
+
+    /** @brief Whether a message was put back and is seen a second time
+     *
+     * @param[in] msg - The incoming message
+     */
+    bool isPutBack(sd_bus_message* msg) const
+    {
+        return putBack.contains(msg);
+    }
+
+    /** @brief Put back up to budget reads, called by the defer source
+     *
+     * @return The number of reads put back
+     */
+    size_t release();
+
+    /** @brief The reads put back per iteration by default */
+    static constexpr size_t defaultBudget = 8;
+
+    /** @brief The reads kept at most by default */
+    static constexpr size_t defaultMaxQueued = 256;
+
+  private:
+    /** @brief The connection the reads arrive on */
+    sd_bus* bus;
+
+    /** @brief The reads put back per iteration */
+    size_t budget;
+
+    /** @brief The reads kept at most */
+    size_t maxQueued;
+
+    /** @brief The reads queued, oldest first, each holding a reference */
+    std::deque<sd_bus_message*> queue;
+
+    /** @brief The number of messages of each sender queued or put back and
+     *         not dispatched yet */
+    std::unordered_map<std::string, size_t> heldBySender;
+
+    /** @brief The messages put back and not dispatched yet, each holding a
+     *         reference so that the address stays theirs */
+    std::unordered_set<sd_bus_message*> putBack;
+
+    /** @brief The deleter of sd_bus_slot */
+    std::function<void(sd_bus_slot*)> sdBusSlotDeleter = [](sd_bus_slot* p) {
+        if (p)
+        {
+            sd_bus_slot_unref(p);
+        }
+    };
+    using SdBusSlot = std::unique_ptr<sd_bus_slot, decltype(sdBusSlotDeleter)>;
+
+    /** @brief The slot of the bus filter */
+    SdBusSlot filterSlot{nullptr, sdBusSlotDeleter};
+
+    /** @brief The deleter of sd_event_source */
+    std::function<void(sd_event_source*)> sdEventSourceDeleter =
+        [](sd_event_source* p) {
+            if (p)
+            {
+                sd_event_source_unref(p);
+            }
+        };
+    using SdEventSource =
+        std::unique_ptr<sd_event_source, decltype(sdEventSourceDeleter)>;
+
+    /** @brief The defer source putting back the reads */
+    SdEventSource deferSource{nullptr, sdEventSourceDeleter};
+
+    /** @brief Put back the oldest read on the connection */
+    void putBackOldest();
+
+    /** @brief Put back the queued reads of a sender, oldest first
+     *
+     * @param[in] sender - The unique name of the sender
+     */
+    void putBackSender(const std::string& sender);
+
+    /** @brief Put back a message on the connection
+     *
+     * @param[in] msg - The message, its reference is taken over
+     */
+    void enqueue(sd_bus_message* msg);
+
+    /** @brief Take a held message off the count of its sender */
+    void forget(sd_bus_message* msg);
+
+    /** @brief The bus filter called for every incoming message
+     *
+     * @param[in] msg      - The incoming message
+     * @param[in] userData - Pointer to this object instance
+     * @param[out] retError - Not used but required with filter API
+     */
+    static int onMessage(sd_bus_message* msg, void* userData,
+                         sd_bus_error* retError);
+
+    /** @brief Called by the defer source in the low class */
+    static int onDefer(sd_event_source* source, void* userData);
+};
+
+} // namespace time
+} // namespace phosphor
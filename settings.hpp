@@ -28,6 +28,14 @@ struct Objects
      * @param[in] bus - The D-bus bus object
      */
     explicit Objects(sdbusplus::bus_t& /*bus*/);
+
+    /** @brief Constructor - use an already resolved settings object
+     *
+     * @param[in] timeSyncMethod - The time sync method settings object path
+     */
+    explicit Objects(phosphor::time::utils::Path timeSyncMethod) :
+        timeSyncMethod(std::move(timeSyncMethod))
+    {}
     Objects() = delete;
     Objects(const Objects&) = delete;
     Objects& operator=(const Objects&) = delete;
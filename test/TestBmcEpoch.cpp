@@ -1,11 +1,16 @@
 #include "config.h"
 
 #include "bmc_epoch.hpp"
+#include "clock.hpp"
 #include "manager.hpp"
 #include "types.hpp"
 
 #include <sdbusplus/bus.hpp>
 
+#include <array>
+#include <ctime>
+#include <regex>
+
 #include <gtest/gtest.h>
 
 namespace phosphor
@@ -17,38 +22,22 @@ class TestBmcEpoch : public testing::Test
 {
   public:
     sdbusplus::bus_t bus;
+    SimulatedClock clock;
     Manager manager;
-    sd_event* event = nullptr;
     std::unique_ptr<BmcEpoch> bmcEpoch;
 
-    TestBmcEpoch() : bus(sdbusplus::bus::new_default()), manager(bus)
+    TestBmcEpoch() : bus(sdbusplus::bus::new_default()), manager(bus, clock)
     {
-        // BmcEpoch requires sd_event to init
-        sd_event_default(&event);
-        bus.attach_event(event, SD_EVENT_PRIORITY_NORMAL);
-        bmcEpoch = std::make_unique<BmcEpoch>(bus, objpathBmc, manager);
+        bmcEpoch = std::make_unique<BmcEpoch>(bus, objpathBmc, manager, clock);
     }
 
-    ~TestBmcEpoch() override
-    {
-        bus.detach_event();
-        sd_event_unref(event);
-    }
+    ~TestBmcEpoch() override = default;
     TestBmcEpoch(const TestBmcEpoch&) = delete;
     TestBmcEpoch(TestBmcEpoch&&) = delete;
     TestBmcEpoch& operator=(const TestBmcEpoch&) = delete;
     TestBmcEpoch& operator=(TestBmcEpoch&&) = delete;
 };
 
-TEST_F(TestBmcEpoch, onModeChange)
-{
-    bmcEpoch->onModeChanged(Mode::NTP);
-    EXPECT_EQ(Mode::NTP, manager.getTimeMode());
-
-    bmcEpoch->onModeChanged(Mode::Manual);
-    EXPECT_EQ(Mode::Manual, manager.getTimeMode());
-}
-
 TEST_F(TestBmcEpoch, empty)
 {
     // Default mode is MANUAL
@@ -59,15 +48,56 @@ TEST_F(TestBmcEpoch, getElapsed)
 {
     auto t1 = bmcEpoch->elapsed();
     EXPECT_NE(0, t1);
+    clock.advance(std::chrono::seconds(1));
     auto t2 = bmcEpoch->elapsed();
-    EXPECT_GE(t2, t1);
+    EXPECT_EQ(t2, t1 + 1000000);
+}
+
+TEST_F(TestBmcEpoch, getDateTime)
+{
+    auto render = [](uint64_t usec) {
+        time_t t = static_cast<time_t>(usec / 1000000);
+        tm tm{};
+        gmtime_r(&t, &tm);
+        std::array<char, 32> buf{};
+        strftime(buf.data(), buf.size(), "%Y-%m-%dT%H:%M:%S+00:00", &tm);
+        return std::string(buf.data());
+    };
+
+    auto before = bmcEpoch->elapsed();
+    std::string t = bmcEpoch->dateTime();
+    auto after = bmcEpoch->elapsed();
+
+    EXPECT_TRUE(std::regex_match(
+        t, std::regex(R"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\+00:00)")));
+    EXPECT_TRUE(t == render(before) || t == render(after));
 }
 
 TEST_F(TestBmcEpoch, setElapsedOK)
 {
-    // TODO: setting time will call sd-bus functions and it will fail on host
-    // if we have gmock for sdbusplus::bus, we can test setElapsed.
-    // But for now we can not test it
+    constexpr uint64_t value = 1704067200000000; // 2024-01-01T00:00:00Z
+    EXPECT_EQ(value, bmcEpoch->elapsed(value));
+    EXPECT_EQ(value, bmcEpoch->elapsed());
+    EXPECT_EQ(1U, clock.steps());
+    EXPECT_EQ("2024-01-01T00:00:00+00:00", bmcEpoch->dateTime());
+}
+
+TEST_F(TestBmcEpoch, setElapsedFails)
+{
+    clock.failSteps(utils::Error{-EIO, "", "SetTime failed"});
+    auto before = bmcEpoch->elapsed();
+    EXPECT_ANY_THROW(bmcEpoch->elapsed(1704067200000000));
+    EXPECT_EQ(before, bmcEpoch->elapsed());
+    EXPECT_EQ(0U, clock.steps());
+}
+
+TEST_F(TestBmcEpoch, jumpRefreshesDateTime)
+{
+    // Within the same second the cached string is only dropped on a jump
+    clock.step(std::chrono::seconds(1704067200));
+    EXPECT_EQ("2024-01-01T00:00:00+00:00", bmcEpoch->dateTime());
+    clock.jump(std::chrono::hours(24));
+    EXPECT_EQ("2024-01-02T00:00:00+00:00", bmcEpoch->dateTime());
 }
 
 } // namespace time
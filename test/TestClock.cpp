@@ -0,0 +1,75 @@
+#include "clock.hpp"
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+TEST(TestClock, stepNotifiesDelta)
+{
+    SimulatedClock clock(seconds(100));
+    std::vector<std::pair<microseconds, bool>> jumps;
+    clock.onJump(
+        [&](microseconds delta, bool own) { jumps.emplace_back(delta, own); });
+
+    EXPECT_TRUE(clock.step(seconds(40)));
+    EXPECT_EQ(seconds(40), clock.now());
+    clock.jump(seconds(5));
+    EXPECT_EQ(seconds(45), clock.now());
+
+    ASSERT_EQ(2U, jumps.size());
+    EXPECT_EQ(std::pair(microseconds(seconds(-60)), true), jumps[0]);
+    EXPECT_EQ(std::pair(microseconds(seconds(5)), false), jumps[1]);
+    EXPECT_EQ(1U, clock.steps());
+}
+
+TEST(TestClock, advanceIsNotAJump)
+{
+    SimulatedClock clock(seconds(100));
+    bool jumped = false;
+    clock.onJump([&](microseconds, bool) { jumped = true; });
+
+    clock.advance(hours(24 * 365));
+    EXPECT_EQ(seconds(100) + hours(24 * 365), clock.now());
+    EXPECT_FALSE(jumped);
+}
+
+TEST(TestClock, drift)
+{
+    SimulatedClock clock(microseconds(0));
+    clock.setDrift(-20);
+
+    // 20ppm slow loses 72ms an hour, also in steps of a fraction of a
+    // microsecond of drift
+    for (int i = 0; i < 3600 * 1000; ++i)
+    {
+        clock.advance(milliseconds(1));
+    }
+    EXPECT_EQ(seconds(3600) - milliseconds(72), clock.now());
+}
+
+TEST(TestClock, failedStep)
+{
+    SimulatedClock clock(seconds(100));
+    clock.failSteps(utils::Error{-EIO, "", "injected"});
+
+    auto result = clock.step(seconds(200));
+    ASSERT_FALSE(result);
+    EXPECT_EQ("injected", result.error().message);
+    EXPECT_EQ(seconds(100), clock.now());
+    EXPECT_EQ(0U, clock.steps());
+
+    clock.failSteps(std::nullopt);
+    EXPECT_TRUE(clock.step(seconds(200)));
+    EXPECT_EQ(seconds(200), clock.now());
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,99 @@
+#include "clock_source.hpp"
+#include "events.hpp"
+#include "types.hpp"
+
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+class TestClockSource : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    fs::path dir;
+    TimeEvents events;
+    microseconds coarse{1704067200000000};
+    std::unique_ptr<ClockSource> source;
+
+    TestClockSource() : bus(sdbusplus::bus::new_default())
+    {
+        char tmpl[] = "/tmp/TestClockSource.XXXXXX";
+        dir = mkdtemp(tmpl);
+        fs::create_directory(dir / "clocksource0");
+        setName("arch_sys_counter");
+        source = std::make_unique<ClockSource>(
+            bus, objpathBmc, events, dir,
+            [this]() { return coarse; });
+    }
+
+    ~TestClockSource() override
+    {
+        source.reset();
+        fs::remove_all(dir);
+    }
+
+    TestClockSource(const TestClockSource&) = delete;
+    TestClockSource(TestClockSource&&) = delete;
+    TestClockSource& operator=(const TestClockSource&) = delete;
+    TestClockSource& operator=(TestClockSource&&) = delete;
+
+    void setName(const std::string& name)
+    {
+        std::ofstream(dir / "clocksource0" / "current_clocksource")
+            << name << '\n';
+    }
+};
+
+TEST_F(TestClockSource, measuredAtStartup)
+{
+    EXPECT_EQ("arch_sys_counter", source->name());
+    EXPECT_GT(source->readCost(), nanoseconds(0));
+    EXPECT_LT(source->readCost(), milliseconds(1));
+}
+
+TEST_F(TestClockSource, measuredAfterJump)
+{
+    setName("jiffies");
+    EXPECT_EQ("arch_sys_counter", source->name());
+
+    events.publish(event::Jump{seconds(60)});
+    EXPECT_EQ("jiffies", source->name());
+}
+
+TEST_F(TestClockSource, missingClockSource)
+{
+    fs::remove_all(dir / "clocksource0");
+    source->refresh();
+    EXPECT_EQ("", source->name());
+    EXPECT_EQ("", ClockSource::readName(dir / "none"));
+}
+
+TEST_F(TestClockSource, coarseElapsed)
+{
+    // Read at each Get, nothing is cached
+    EXPECT_EQ(coarse, source->coarseElapsed());
+    coarse += milliseconds(4);
+    EXPECT_EQ(coarse, source->coarseElapsed());
+}
+
+TEST_F(TestClockSource, coarseClockIsCheap)
+{
+    EXPECT_LE(ClockSource::measure(CLOCK_REALTIME_COARSE),
+              ClockSource::slowReadCost);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,103 @@
+#include "events.hpp"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+/** @brief A listener of the jumps only */
+struct JumpRecorder
+{
+    std::vector<std::string>& log;
+
+    void onEvent(const event::Jump& event)
+    {
+        log.emplace_back("jump " + std::to_string(event.delta.count()));
+    }
+};
+
+/** @brief A listener of the jumps and the mode */
+struct ModeRecorder
+{
+    std::vector<std::string>& log;
+
+    void onEvent(const event::Jump& /* event */)
+    {
+        log.emplace_back("mode recorder jump");
+    }
+
+    void onEvent(const event::ModeChanged& event)
+    {
+        log.emplace_back(Mode::NTP == event.mode ? "ntp" : "manual");
+    }
+};
+
+using Bus = EventBus<JumpRecorder, ModeRecorder>;
+
+TEST(TestEvents, deliversToHandlingListeners)
+{
+    std::vector<std::string> log;
+    JumpRecorder jumps{log};
+    ModeRecorder modes{log};
+    Bus bus;
+    bus.subscribe(jumps);
+    bus.subscribe(modes);
+
+    bus.publish(event::Jump{seconds(1)});
+    bus.publish(event::ModeChanged{Mode::NTP});
+    bus.publish(event::SyncStatus{true});
+
+    std::vector<std::string> expected{"jump 1000000", "mode recorder jump",
+                                      "ntp"};
+    EXPECT_EQ(expected, log);
+}
+
+TEST(TestEvents, unsubscribedListenerIsSkipped)
+{
+    std::vector<std::string> log;
+    JumpRecorder jumps{log};
+    ModeRecorder modes{log};
+    Bus bus;
+
+    // Nothing is subscribed yet
+    bus.publish(event::Jump{seconds(1)});
+    EXPECT_TRUE(log.empty());
+
+    bus.subscribe(jumps);
+    bus.subscribe(modes);
+    bus.unsubscribe(modes);
+    bus.publish(event::ModeChanged{Mode::Manual});
+    bus.publish(event::Jump{seconds(2)});
+
+    std::vector<std::string> expected{"jump 2000000"};
+    EXPECT_EQ(expected, log);
+}
+
+TEST(TestEvents, unsubscribeKeepsOtherObject)
+{
+    std::vector<std::string> log;
+    std::vector<std::string> otherLog;
+    JumpRecorder jumps{log};
+    JumpRecorder other{otherLog};
+    Bus bus;
+
+    // A replaced listener unsubscribing does not remove its replacement
+    bus.subscribe(jumps);
+    bus.subscribe(other);
+    bus.unsubscribe(jumps);
+    bus.publish(event::Jump{seconds(3)});
+
+    EXPECT_TRUE(log.empty());
+    std::vector<std::string> expected{"jump 3000000"};
+    EXPECT_EQ(expected, otherLog);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,457 @@
+#include "config.h"
+
+#include "bmc_epoch.hpp"
+#include "clock.hpp"
+#include "harness.hpp"
+#include "manager.hpp"
+#include "scheduling.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/manager.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/* The footprint of the daemon against the budgets in footprint-budgets.txt:
+ * - the steady state RSS of the phosphor-time-manager executable
+ * - the heap allocations per Elapsed Get and Set, per settings signal and
+ *   per timedated signal, counted in process on the thread of the daemon
+ * - the size of the phosphor-time-manager executable once stripped
+ * The executable, its stripped copy and the budgets are given by the
+ * FOOTPRINT_DAEMON, FOOTPRINT_STRIPPED and FOOTPRINT_BUDGETS environment
+ * variables. With FOOTPRINT_RECORD set the metrics are printed as lines of
+ * the budgets instead of checked.
+ */
+
+// The interposer forwards to the __libc_* entry points of glibc, and a
+// sanitizer brings an allocator of its own
+#if !defined(__GLIBC__) || defined(__SANITIZE_ADDRESS__)
+#define FOOTPRINT_COUNT_ALLOCATIONS 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define FOOTPRINT_COUNT_ALLOCATIONS 0
+#endif
+#endif
+#ifndef FOOTPRINT_COUNT_ALLOCATIONS
+#define FOOTPRINT_COUNT_ALLOCATIONS 1
+#endif
+
+namespace
+{
+std::atomic<uint64_t> allocations = 0;
+thread_local bool countAllocations = false;
+
+void countAllocation()
+{
+    if (countAllocations)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+} // namespace
+
+#if FOOTPRINT_COUNT_ALLOCATIONS
+// Count the allocations of the C library, which also serves operator new,
+// so the allocations of sd-bus are counted as well. The aligned ones serve
+// the aligned operator new.
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    if (alignment == 0 || alignment % sizeof(void*) != 0 ||
+        (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    countAllocation();
+    auto* p = __libc_memalign(alignment, size);
+    if (!p)
+    {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+}
+#endif
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+using namespace phosphor::time::bench;
+
+namespace // anonymous
+{
+constexpr auto propertiesIntf = "org.freedesktop.DBus.Properties";
+constexpr auto epochIntf = "xyz.openbmc_project.Time.EpochTime";
+constexpr auto settingsPath = "/xyz/openbmc_project/time/sync_method";
+constexpr auto settingsIntf = "xyz.openbmc_project.Time.Synchronization";
+constexpr auto timedatePath = "/org/freedesktop/timedate1";
+constexpr auto timedateIntf = "org.freedesktop.timedate1";
+constexpr auto ntpSync = "xyz.openbmc_project.Time.Synchronization.Method.NTP";
+constexpr auto manualSync =
+    "xyz.openbmc_project.Time.Synchronization.Method.Manual";
+
+/** @brief Read the budgets, "<metric> = <value>" per line */
+std::map<std::string, double> loadBudgets(const char* path)
+{
+    std::map<std::string, double> budgets;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key;
+        std::string eq;
+        double value = 0;
+        if (fields >> key >> eq >> value && eq == "=")
+        {
+            budgets[key] = value;
+        }
+    }
+    return budgets;
+}
+
+/** @brief Get a "<field>: <value> kB" field of /proc/<pid>/status */
+uint64_t statusKb(pid_t pid, const std::string& field)
+{
+    std::ifstream file("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.starts_with(field + ":"))
+        {
+            return std::stoull(line.substr(field.size() + 1));
+        }
+    }
+    return 0;
+}
+
+/** @class InProcessDaemon
+ *  @brief The objects of the daemon on their own connection and thread,
+ *  the only thread whose allocations are counted. The signals are on a
+ *  connection opened as the daemon does, so the environment of the private
+ *  bus is to be exported first.
+ */
+class InProcessDaemon
+{
+  public:
+    explicit InProcessDaemon(const std::string& address) :
+        thread([this, address]() { run(address); })
+    {
+        while (!ready)
+        {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    }
+
+    ~InProcessDaemon()
+    {
+        stop = true;
+        thread.join();
+    }
+
+    InProcessDaemon(const InProcessDaemon&) = delete;
+    InProcessDaemon(InProcessDaemon&&) = delete;
+    InProcessDaemon& operator=(const InProcessDaemon&) = delete;
+    InProcessDaemon& operator=(InProcessDaemon&&) = delete;
+
+  private:
+    std::atomic<bool> ready = false;
+    std::atomic<bool> stop = false;
+    std::thread thread;
+
+    void run(const std::string& address)
+    {
+        auto bus = connect(address);
+        sd_event* event = nullptr;
+        sd_event_new(&event);
+        bus.attach_event(event, priority::medium);
+        auto signalBus = openSignalBus(event);
+        {
+            sdbusplus::server::manager_t objManager(bus, objmgrpath);
+            SystemClock clock(bus);
+            Manager manager(bus, clock, {},
+                            signalBus ? &*signalBus : nullptr);
+            BmcEpoch bmcEpoch(bus, objpathBmc, manager, clock);
+            ReadQueue readQueue(bus);
+            bus.request_name(busname);
+
+            countAllocations = true;
+            ready = true;
+            while (!stop)
+            {
+                sd_event_run(event, 10'000);
+            }
+            countAllocations = false;
+        }
+        bus.detach_event();
+        if (signalBus)
+        {
+            signalBus->detach_event();
+        }
+        sd_event_unref(event);
+    }
+};
+} // namespace
+
+class TestFootprint : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        const char* path = std::getenv("FOOTPRINT_BUDGETS");
+        daemon = std::getenv("FOOTPRINT_DAEMON");
+        if (!path || !daemon)
+        {
+            GTEST_SKIP() << "FOOTPRINT_BUDGETS or FOOTPRINT_DAEMON not set";
+        }
+        budgets = loadBudgets(path);
+        ASSERT_FALSE(budgets.empty()) << "No budgets in " << path;
+        margin = 1 + budgets["margin_percent"] / 100;
+        record = std::getenv("FOOTPRINT_RECORD") != nullptr;
+    }
+
+    /** @brief Check a metric against its measured value and the margin, and
+     *         report it */
+    void expectWithin(const std::string& metric, double value)
+    {
+        if (record)
+        {
+            std::printf("%s = %.0f\n", metric.c_str(), value);
+            return;
+        }
+        auto it = budgets.find(metric);
+        ASSERT_NE(it, budgets.end()) << "No budget for " << metric;
+        auto budget = it->second * margin;
+        std::printf("%-28s %12.1f measured %12.1f budget %12.1f\n",
+                    metric.c_str(), value, it->second, budget);
+        EXPECT_LE(value, budget) << metric << " is over budget";
+    }
+
+    std::map<std::string, double> budgets;
+    double margin = 1;
+    bool record = false;
+    const char* daemon = nullptr;
+};
+
+/** @brief A private bus with the stand-ins and a client connection */
+struct Environment
+{
+    PrivateBus privateBus;
+    StandinPeers peers{privateBus.address()};
+    sdbusplus::bus_t client = connect(privateBus.address());
+
+    /** @brief Get Elapsed */
+    void get()
+    {
+        auto m = client.new_method_call(busname, objpathBmc, propertiesIntf,
+                                        "Get");
+        m.append(epochIntf, "Elapsed");
+        client.call(m);
+    }
+
+    /** @brief Set Elapsed to the current time */
+    void set()
+    {
+        auto m = client.new_method_call(busname, objpathBmc, propertiesIntf,
+                                        "Set");
+        uint64_t now =
+            duration_cast<microseconds>(system_clock::now().time_since_epoch())
+                .count();
+        m.append(epochIntf, "Elapsed", std::variant<uint64_t>(now));
+        client.call(m);
+    }
+
+    /** @brief Wait until the daemon has handled everything sent so far */
+    void ping()
+    {
+        auto m = client.new_method_call(busname, objpathBmc,
+                                        "org.freedesktop.DBus.Peer", "Ping");
+        client.call(m);
+    }
+
+    /** @brief Emit a PropertiesChanged signal */
+    template <typename T>
+    void propertiesChanged(const char* path, const char* intf,
+                           const char* property, const T& value)
+    {
+        auto m = client.new_signal(path, propertiesIntf, "PropertiesChanged");
+        std::map<std::string, std::variant<T>> changed{{property, value}};
+        m.append(intf, changed, std::vector<std::string>{});
+        m.signal_send();
+    }
+};
+
+/** @brief The allocations on the thread of the daemon per call of fn,
+ *         less the allocations of the Ping that follows it */
+double allocationsPer(Environment& env, size_t n,
+                      const std::function<void(size_t)>& fn, double perPing)
+{
+    // Warm up the caches of sd-bus and of the daemon, with the value of an
+    // odd call so that the first call below changes it
+    fn(n - 1);
+    env.ping();
+    std::this_thread::sleep_for(milliseconds(50));
+    env.ping();
+
+    auto start = allocations.load();
+    for (size_t i = 0; i < n; ++i)
+    {
+        fn(i);
+        env.ping();
+    }
+    // Let the echoes, e.g. timedated's NTP signal after a SetNTP, arrive
+    std::this_thread::sleep_for(milliseconds(50));
+    env.ping();
+
+    auto total = static_cast<double>(allocations.load() - start);
+    return std::max(0.0, total / n - perPing * (n + 1) / n);
+}
+
+TEST_F(TestFootprint, allocationsPerOperation)
+{
+    if (!FOOTPRINT_COUNT_ALLOCATIONS)
+    {
+        GTEST_SKIP() << "Allocations are only counted with glibc and "
+                        "without sanitizers";
+    }
+
+    Environment env;
+    env.privateBus.exportEnvironment();
+    InProcessDaemon daemon(env.privateBus.address());
+
+    constexpr size_t n = 100;
+    auto perPing = allocationsPer(env, n, [](size_t) {}, 0);
+
+    expectWithin("elapsed_get_allocations",
+                 allocationsPer(env, n, [&](size_t) { env.get(); }, perPing));
+
+    // Stay within the burst of the rate limit, a rejected Set is cheaper
+    constexpr size_t sets = ELAPSED_SET_BURST / 2;
+    expectWithin("elapsed_set_allocations",
+                 allocationsPer(env, sets, [&](size_t) { env.set(); },
+                                perPing));
+
+    // Every signal flips the mode, so it includes the SetNTP call and the
+    // NTP signal of timedated it causes.
+    expectWithin("settings_signal_allocations",
+                 allocationsPer(
+                     env, n,
+                     [&](size_t i) {
+                         env.propertiesChanged(settingsPath, settingsIntf,
+                                               "TimeSyncMethod",
+                                               std::string(i % 2 ? manualSync
+                                                                 : ntpSync));
+                     },
+                     perPing));
+
+    // The mode is Manual after an even number of flips, an NTP signal that
+    // agrees with it is the common echo of a SetNTP.
+    expectWithin("timedate_signal_allocations",
+                 allocationsPer(
+                     env, n,
+                     [&](size_t) {
+                         env.propertiesChanged(timedatePath, timedateIntf,
+                                               "NTP", false);
+                     },
+                     perPing));
+}
+
+TEST_F(TestFootprint, steadyStateRss)
+{
+    Environment env;
+    env.privateBus.exportEnvironment();
+    DaemonProcess process(daemon, env.client);
+
+    uint64_t rss = 0;
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            env.get();
+        }
+        env.propertiesChanged(settingsPath, settingsIntf, "TimeSyncMethod",
+                              std::string(round % 2 ? manualSync : ntpSync));
+        env.ping();
+
+        // The first rounds grow the heap, only the later ones are steady
+        if (round >= 5)
+        {
+            rss = std::max(rss, statusKb(process.getPid(), "VmRSS"));
+        }
+    }
+
+    expectWithin("rss_kb", static_cast<double>(rss));
+}
+
+TEST_F(TestFootprint, strippedSize)
+{
+    const char* stripped = std::getenv("FOOTPRINT_STRIPPED");
+    if (!stripped || !*stripped)
+    {
+        GTEST_SKIP() << "FOOTPRINT_STRIPPED not set, strip was not found";
+    }
+
+    std::error_code ec;
+    auto size = std::filesystem::file_size(stripped, ec);
+    ASSERT_FALSE(ec) << "Failed to read " << stripped;
+    expectWithin("stripped_size_kb", static_cast<double>(size) / 1024);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,160 @@
+#include "clock.hpp"
+#include "events.hpp"
+#include "holdover.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+/** @brief A stand-in NTP daemon that steers the simulated clock while its
+ *         servers are reachable, with a little noise on the frequency */
+class StandinNtp
+{
+  public:
+    StandinNtp(SimulatedClock& clock, double drift) : clock(clock), drift(drift)
+    {}
+
+    bool reachable = true;
+
+    void poll()
+    {
+        if (reachable)
+        {
+            // Deterministic noise of +-0.05ppm
+            seed = seed * 1103515245 + 12345;
+            auto noise = (static_cast<double>(seed % 1001) - 500) / 10000;
+            clock.setFrequency(-drift + noise);
+            clock.setSynchronized(true, milliseconds(1));
+        }
+        else if (clock.discipline()->synchronized)
+        {
+            // The daemon gives up and the kernel free-runs
+            clock.setFrequency(0);
+            clock.setSynchronized(false, milliseconds(16));
+        }
+    }
+
+  private:
+    SimulatedClock& clock;
+    double drift;
+    uint32_t seed = 1;
+};
+
+class TestHoldover : public testing::Test
+{
+  public:
+    static constexpr double drift = 15;
+
+    sdbusplus::bus_t bus;
+    SimulatedClock clock;
+    StandinNtp ntp;
+    TimeEvents events;
+    Holdover holdover;
+
+    TestHoldover() :
+        bus(sdbusplus::bus::new_default()), ntp(clock, drift),
+        holdover(bus, objpathBmc, clock, events, hours(24))
+    {
+        clock.setDrift(drift);
+    }
+
+    /** @brief Run the samples for the given time */
+    void run(seconds duration)
+    {
+        for (auto t = seconds(0); t < duration; t += Holdover::sampleInterval)
+        {
+            ntp.poll();
+            clock.advance(Holdover::sampleInterval);
+            holdover.sample();
+        }
+    }
+
+    /** @brief The offset of the clock to the time actually passed */
+    microseconds offset() const
+    {
+        return clock.now() - clock.monotonic();
+    }
+};
+
+TEST_F(TestHoldover, manualModeDoesNotLearn)
+{
+    run(hours(1));
+    EXPECT_EQ(0U, holdover.samples());
+    EXPECT_FALSE(holdover.isActive());
+    EXPECT_FALSE(holdover.isSampling());
+}
+
+TEST_F(TestHoldover, holdsLearnedFrequency)
+{
+    holdover.setNtpMode(true);
+    run(hours(6));
+    EXPECT_GE(holdover.samples(), Holdover::minSamples);
+    EXPECT_NEAR(-drift, holdover.frequency(), 0.05);
+    EXPECT_FALSE(holdover.isActive());
+
+    ntp.reachable = false;
+    auto before = offset();
+    run(hours(12));
+    EXPECT_TRUE(holdover.isActive());
+
+    // Free-running 15ppm fast would be 648ms off after 12 hours
+    auto error = abs(offset() - before);
+    EXPECT_LT(error, milliseconds(5));
+    EXPECT_GT(holdover.estimatedError(), error);
+    EXPECT_LT(holdover.estimatedError(), milliseconds(50));
+}
+
+TEST_F(TestHoldover, syncEndsHoldover)
+{
+    holdover.setNtpMode(true);
+    run(hours(1));
+    ntp.reachable = false;
+    run(hours(1));
+    EXPECT_TRUE(holdover.isActive());
+
+    ntp.reachable = true;
+    run(Holdover::sampleInterval);
+    EXPECT_FALSE(holdover.isActive());
+    EXPECT_EQ(milliseconds(1), holdover.estimatedError());
+}
+
+TEST_F(TestHoldover, holdoverExpires)
+{
+    holdover.setNtpMode(true);
+    run(hours(1));
+    ntp.reachable = false;
+    run(hours(23));
+    EXPECT_TRUE(holdover.isActive());
+
+    run(hours(2));
+    EXPECT_FALSE(holdover.isActive());
+    EXPECT_EQ(0U, holdover.samples());
+}
+
+TEST_F(TestHoldover, leavingNtpModeEndsHoldover)
+{
+    holdover.setNtpMode(true);
+    run(hours(1));
+    ntp.reachable = false;
+    run(hours(1));
+    EXPECT_TRUE(holdover.isActive());
+
+    EXPECT_TRUE(holdover.isSampling());
+
+    events.publish(event::ModeChanged{Mode::Manual});
+    EXPECT_FALSE(holdover.isActive());
+    EXPECT_FALSE(holdover.isSampling());
+}
+
+} // namespace time
+} // namespace phosphor
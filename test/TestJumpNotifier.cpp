@@ -0,0 +1,182 @@
+#include "events.hpp"
+#include "jump_notifier.hpp"
+#include "types.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+class TestJumpNotifier : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    TimeEvents events;
+    JumpNotifier notifier;
+
+    TestJumpNotifier() :
+        bus(sdbusplus::bus::new_default()), notifier(bus, objpathBmc, events)
+    {}
+
+    /** @brief Read a record without blocking */
+    static std::optional<JumpNotifier::Record> read(int fd)
+    {
+        JumpNotifier::Record record{};
+        auto n = recv(fd, &record, sizeof(record), MSG_DONTWAIT);
+        if (n != sizeof(record))
+        {
+            return std::nullopt;
+        }
+        return record;
+    }
+};
+
+TEST_F(TestJumpNotifier, jumpIsSent)
+{
+    auto fd = notifier.subscribe();
+    ASSERT_TRUE(fd);
+    EXPECT_FALSE(read(*fd));
+
+    events.publish(event::Jump{seconds(-5)});
+    events.publish(event::Jump{milliseconds(1500)});
+
+    auto first = read(*fd);
+    ASSERT_TRUE(first);
+    EXPECT_EQ(-5000000, first->delta);
+    EXPECT_EQ(1U, first->sequence);
+
+    auto second = read(*fd);
+    ASSERT_TRUE(second);
+    EXPECT_EQ(1500000, second->delta);
+    EXPECT_EQ(2U, second->sequence);
+
+    EXPECT_FALSE(read(*fd));
+    close(*fd);
+}
+
+TEST_F(TestJumpNotifier, eachClientIsSent)
+{
+    auto a = notifier.subscribe();
+    auto b = notifier.subscribe();
+    ASSERT_TRUE(a && b);
+
+    events.publish(event::Jump{seconds(60)});
+    EXPECT_TRUE(read(*a));
+    EXPECT_TRUE(read(*b));
+    close(*a);
+    close(*b);
+}
+
+TEST_F(TestJumpNotifier, fdIsReadable)
+{
+    auto fd = notifier.subscribe();
+    ASSERT_TRUE(fd);
+
+    pollfd p{*fd, POLLIN, 0};
+    EXPECT_EQ(0, poll(&p, 1, 0));
+    events.publish(event::Jump{seconds(60)});
+    EXPECT_EQ(1, poll(&p, 1, 0));
+    EXPECT_TRUE(p.revents & POLLIN);
+    close(*fd);
+}
+
+TEST_F(TestJumpNotifier, closedClientIsDropped)
+{
+    auto fd = notifier.subscribe();
+    ASSERT_TRUE(fd);
+    ASSERT_EQ(1U, notifier.clients());
+
+    close(*fd);
+    events.publish(event::Jump{seconds(60)});
+    EXPECT_EQ(0U, notifier.clients());
+}
+
+TEST_F(TestJumpNotifier, clientOfALeftOwnerIsDropped)
+{
+    auto a = notifier.subscribe(":1.42");
+    auto b = notifier.subscribe(":1.43");
+    ASSERT_TRUE(a);
+    ASSERT_TRUE(b);
+
+    notifier.release(":1.42");
+    EXPECT_EQ(1U, notifier.clients());
+
+    // The client that left sees its socket hung up
+    pollfd p{*a, POLLIN, 0};
+    EXPECT_EQ(1, poll(&p, 1, 0));
+    EXPECT_TRUE(p.revents & POLLHUP);
+
+    close(*a);
+    close(*b);
+}
+
+TEST_F(TestJumpNotifier, rejectsTooManyClients)
+{
+    std::vector<int> fds;
+    for (size_t i = 0; i < JumpNotifier::maxClients; ++i)
+    {
+        auto fd = notifier.subscribe();
+        ASSERT_TRUE(fd);
+        fds.push_back(*fd);
+    }
+
+    auto fd = notifier.subscribe();
+    ASSERT_FALSE(fd);
+    EXPECT_EQ(-EMFILE, fd.error().errnum);
+
+    // The slot of a closed client is reused
+    close(fds.back());
+    fds.pop_back();
+    fd = notifier.subscribe();
+    ASSERT_TRUE(fd);
+    fds.push_back(*fd);
+
+    for (auto f : fds)
+    {
+        close(f);
+    }
+}
+
+TEST_F(TestJumpNotifier, rejectsTooManyClientsOfOneOwner)
+{
+    std::vector<int> fds;
+    for (size_t i = 0; i < JumpNotifier::maxClientsPerOwner; ++i)
+    {
+        auto fd = notifier.subscribe(":1.42");
+        ASSERT_TRUE(fd);
+        fds.push_back(*fd);
+    }
+
+    auto fd = notifier.subscribe(":1.42");
+    ASSERT_FALSE(fd);
+    EXPECT_EQ(-EMFILE, fd.error().errnum);
+
+    // Another client still gets a slot
+    fd = notifier.subscribe(":1.43");
+    ASSERT_TRUE(fd);
+    fds.push_back(*fd);
+
+    // The slots of a client are free again once it left the bus
+    notifier.release(":1.42");
+    fd = notifier.subscribe(":1.42");
+    ASSERT_TRUE(fd);
+    fds.push_back(*fd);
+
+    for (auto f : fds)
+    {
+        close(f);
+    }
+}
+
+} // namespace time
+} // namespace phosphor
@@ -1,9 +1,16 @@
+#include "clock.hpp"
 #include "manager.hpp"
-#include "mocked_property_change_listener.hpp"
+#include "metrics.hpp"
+#include "time_transaction.hpp"
 #include "types.hpp"
 
 #include <sdbusplus/bus.hpp>
 
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 namespace phosphor
@@ -15,14 +22,72 @@ class TestManager : public testing::Test
 {
   public:
     sdbusplus::bus_t bus;
+    SimulatedClock clock;
     Manager manager;
 
-    TestManager() : bus(sdbusplus::bus::new_default()), manager(bus) {}
+    TestManager() : bus(sdbusplus::bus::new_default()), manager(bus, clock) {}
 
     void notifyPropertyChanged(const std::string& key, const std::string& value)
     {
         manager.onPropertyChanged(key, value);
     }
+
+    /** @brief Send a PropertiesChanged of timedated to the manager */
+    void notifyTimedateChanged(const std::string& key, bool value)
+    {
+        auto m = bus.new_signal("/org/freedesktop/timedate1",
+                                "org.freedesktop.DBus.Properties",
+                                "PropertiesChanged");
+        m.append("org.freedesktop.timedate1",
+                 std::map<std::string, std::variant<bool>>{{key, value}},
+                 std::vector<std::string>{});
+        sd_bus_message_seal(m.get(), 1, 0);
+        manager.onTimedateChanged(m);
+    }
+
+    /** @brief Send a PropertiesChanged of the settings to the manager */
+    void notifySettingsChanged(const std::string& value)
+    {
+        auto m = bus.new_signal(manager.settings.timeSyncMethod.c_str(),
+                                "org.freedesktop.DBus.Properties",
+                                "PropertiesChanged");
+        m.append(settings::timeSyncIntf,
+                 std::map<std::string, std::variant<std::string>>{
+                     {"TimeSyncMethod", value}},
+                 std::vector<std::string>{});
+        sd_bus_message_seal(m.get(), 1, 0);
+        manager.onSettingsChanged(m);
+    }
+
+    /** @brief The operations of a transaction whose writes succeed without
+     *         reaching the settings and timedated */
+    TimeTransaction::Operations offlineOperations()
+    {
+        return {
+            [this]() { return manager.getTimeMode(); },
+            [this](Mode mode) -> utils::Expected<void> {
+                manager.wroteTimeMode(utils::modeToStr(mode));
+                return {};
+            },
+            [this](bool enable) -> utils::Expected<void> {
+                manager.wroteNtp(enable);
+                return {};
+            },
+            [](std::chrono::microseconds) -> utils::Expected<void> {
+                return {};
+            },
+        };
+    }
+
+    bool writeBackPending() const
+    {
+        return manager.settingsWriteBack.pending();
+    }
+
+    Holdover& holdover()
+    {
+        return manager.holdover;
+    }
 };
 
 TEST_F(TestManager, propertyChanged)
@@ -40,5 +105,70 @@ TEST_F(TestManager, propertyChanged)
     ASSERT_DEATH(notifyPropertyChanged("invalid property", "whatever"), "");
 }
 
+TEST_F(TestManager, modeChangeIsPublished)
+{
+    if (HOLDOVER_MAX_AGE_SEC == 0)
+    {
+        GTEST_SKIP() << "Holdover is disabled";
+    }
+
+    // The holdover only samples the synchronized clock in NTP mode
+    clock.setSynchronized(true, std::chrono::milliseconds(1));
+    manager.setTimeMode(Mode::Manual);
+    holdover().sample();
+    EXPECT_EQ(0U, holdover().samples());
+
+    manager.setTimeMode(Mode::NTP);
+    holdover().sample();
+    EXPECT_EQ(1U, holdover().samples());
+}
+
+TEST_F(TestManager, syncStatusIsPublished)
+{
+    if (HOLDOVER_MAX_AGE_SEC == 0)
+    {
+        GTEST_SKIP() << "Holdover is disabled";
+    }
+
+    // The holdover samples at once when the sync status changes
+    manager.setTimeMode(Mode::NTP);
+    clock.setSynchronized(true, std::chrono::milliseconds(1));
+    notifyTimedateChanged("NTPSynchronized", true);
+    EXPECT_EQ(1U, holdover().samples());
+
+    // An unchanged status is not published again
+    notifyTimedateChanged("NTPSynchronized", true);
+    notifyTimedateChanged("NTP", true);
+    EXPECT_EQ(1U, holdover().samples());
+}
+
+TEST_F(TestManager, transactionEchoesAreDropped)
+{
+    manager.setTimeMode(Mode::NTP);
+    notifyTimedateChanged("NTP", true);
+    TimeTransaction transaction(bus, objpathBmc, clock, offlineOperations());
+
+    ASSERT_TRUE(transaction.setManualTime(
+        std::chrono::microseconds(1'700'000'000'000'000), true));
+    EXPECT_EQ(Mode::NTP, manager.getTimeMode());
+    auto modeChanges = metrics::get().modeChanges;
+    auto setNtpCalls = metrics::get().setNtp.count();
+
+    // The signals of the stages come after the restore to NTP mode
+    notifySettingsChanged(settings::manualSync);
+    notifyTimedateChanged("NTP", false);
+    notifySettingsChanged(settings::ntpSync);
+    notifyTimedateChanged("NTP", true);
+
+    EXPECT_EQ(Mode::NTP, manager.getTimeMode());
+    EXPECT_EQ(modeChanges, metrics::get().modeChanges);
+    EXPECT_EQ(setNtpCalls, metrics::get().setNtp.count());
+    EXPECT_FALSE(writeBackPending());
+
+    // A change by someone else is taken again
+    notifySettingsChanged(settings::manualSync);
+    EXPECT_EQ(Mode::Manual, manager.getTimeMode());
+}
+
 } // namespace time
 } // namespace phosphor
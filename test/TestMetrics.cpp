@@ -0,0 +1,130 @@
+#include "metrics.hpp"
+#include "metrics_exporter.hpp"
+
+#include <stdlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+TEST(TestHistogram, buckets)
+{
+    metrics::Histogram histogram;
+    histogram.observe(microseconds(5));
+    histogram.observe(microseconds(10));
+    histogram.observe(microseconds(700));
+    histogram.observe(seconds(3));
+
+    EXPECT_EQ(2U, histogram.cumulative(0));   // <= 10us
+    EXPECT_EQ(2U, histogram.cumulative(2));   // <= 100us
+    EXPECT_EQ(3U, histogram.cumulative(4));   // <= 1ms
+    EXPECT_EQ(3U, histogram.cumulative(metrics::Histogram::bounds.size() - 1));
+    EXPECT_EQ(4U, histogram.cumulative(metrics::Histogram::bounds.size()));
+    EXPECT_EQ(4U, histogram.count());
+    EXPECT_EQ(microseconds(3000715), histogram.sum());
+}
+
+TEST(TestMetrics, render)
+{
+    metrics::Metrics m;
+    m.elapsedGet.observe(microseconds(50));
+    m.jumps = 3;
+
+    auto text = metrics::render(m);
+    EXPECT_NE(std::string::npos,
+              text.find("# TYPE phosphor_time_elapsed_get_seconds"
+                        " histogram\n"));
+    EXPECT_NE(std::string::npos,
+              text.find("phosphor_time_elapsed_get_seconds_bucket"
+                        "{le=\"0.000010\"} 0\n"));
+    EXPECT_NE(std::string::npos,
+              text.find("phosphor_time_elapsed_get_seconds_bucket"
+                        "{le=\"0.000050\"} 1\n"));
+    EXPECT_NE(std::string::npos,
+              text.find("phosphor_time_elapsed_get_seconds_sum 0.000050\n"));
+    EXPECT_NE(std::string::npos,
+              text.find("# TYPE phosphor_time_jumps_total counter\n"));
+    EXPECT_NE(std::string::npos, text.find("phosphor_time_jumps_total 3\n"));
+}
+
+class TestMetricsExporter : public testing::Test
+{
+  public:
+    fs::path dir;
+    metrics::Metrics m;
+
+    TestMetricsExporter()
+    {
+        char tmpl[] = "/tmp/TestMetricsExporter.XXXXXX";
+        dir = mkdtemp(tmpl);
+    }
+
+    ~TestMetricsExporter() override
+    {
+        fs::remove_all(dir);
+    }
+
+    TestMetricsExporter(const TestMetricsExporter&) = delete;
+    TestMetricsExporter(TestMetricsExporter&&) = delete;
+    TestMetricsExporter& operator=(const TestMetricsExporter&) = delete;
+    TestMetricsExporter& operator=(TestMetricsExporter&&) = delete;
+
+    static std::string read(const fs::path& path)
+    {
+        std::ifstream file(path);
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+};
+
+TEST_F(TestMetricsExporter, writtenAtStart)
+{
+    auto file = dir / "run" / "metrics.prom";
+    MetricsExporter exporter(nullptr, file, m);
+
+    EXPECT_EQ(1U, exporter.writes());
+    EXPECT_EQ(metrics::render(m), read(file));
+    EXPECT_FALSE(fs::exists(dir / "run" / "metrics.prom.tmp"));
+}
+
+TEST_F(TestMetricsExporter, skippedWhenUnchanged)
+{
+    auto file = dir / "metrics.prom";
+    MetricsExporter exporter(nullptr, file, m);
+
+    EXPECT_FALSE(exporter.write());
+    EXPECT_EQ(1U, exporter.writes());
+
+    ++m.modeChanges;
+    EXPECT_TRUE(exporter.write());
+    EXPECT_EQ(2U, exporter.writes());
+    EXPECT_NE(std::string::npos,
+              read(file).find("phosphor_time_mode_changes_total 1\n"));
+}
+
+TEST_F(TestMetricsExporter, failedWriteIsRetried)
+{
+    auto file = dir / "blocked" / "metrics.prom";
+    std::ofstream(dir / "blocked").put('x');
+
+    MetricsExporter exporter(nullptr, file, m);
+    EXPECT_EQ(0U, exporter.writes());
+
+    fs::remove(dir / "blocked");
+    EXPECT_TRUE(exporter.write());
+    EXPECT_EQ(metrics::render(m), read(file));
+}
+
+} // namespace time
+} // namespace phosphor
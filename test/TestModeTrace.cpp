@@ -0,0 +1,124 @@
+#include "clock.hpp"
+#include "mode_trace.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+using Stage = ModeTrace::Stage;
+
+class TestModeTrace : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    SimulatedClock clock;
+    ModeTrace trace;
+
+    TestModeTrace() :
+        bus(sdbusplus::bus::new_default()), trace(bus, objpathBmc, clock, 3)
+    {}
+
+    /** @brief Switch through the stages in the daemon */
+    void switchTo(Mode mode)
+    {
+        trace.signal(steady_clock::now() - milliseconds(5));
+        trace.begin(mode);
+        trace.mark(Stage::NtpIssued);
+        trace.mark(Stage::NtpReturned);
+    }
+};
+
+TEST_F(TestModeTrace, switchToManual)
+{
+    switchTo(Mode::Manual);
+    ASSERT_EQ(1U, trace.transitions().size());
+    const auto& t = trace.transitions().back();
+    EXPECT_FALSE(t.complete);
+
+    // NTP is not the new value of the property
+    trace.onNtp(true);
+    EXPECT_FALSE(t.complete);
+
+    trace.onNtp(false);
+    EXPECT_TRUE(t.complete);
+    EXPECT_EQ(microseconds(0), t.duration(Stage::Signal));
+    EXPECT_LE(milliseconds(5), *t.duration(Stage::NtpIssued));
+    EXPECT_TRUE(t.duration(Stage::TimedateNtp));
+    EXPECT_FALSE(t.duration(Stage::Synchronized));
+    EXPECT_LE(milliseconds(5), t.total());
+}
+
+TEST_F(TestModeTrace, switchToNtpUntilSynchronized)
+{
+    switchTo(Mode::NTP);
+    trace.onNtp(true);
+    const auto& t = trace.transitions().back();
+    EXPECT_FALSE(t.complete);
+
+    // A sync lost is no stage
+    trace.onSynchronized(false);
+    EXPECT_FALSE(t.complete);
+
+    trace.onSynchronized(true);
+    EXPECT_TRUE(t.complete);
+    EXPECT_TRUE(t.duration(Stage::Synchronized));
+}
+
+TEST_F(TestModeTrace, kernelFlagIsChecked)
+{
+    switchTo(Mode::NTP);
+    const auto& t = trace.transitions().back();
+
+    // Only once the NTP daemon is started
+    clock.setSynchronized(true);
+    trace.check();
+    EXPECT_FALSE(t.complete);
+
+    clock.setSynchronized(false);
+    trace.onNtp(true);
+    trace.check();
+    EXPECT_FALSE(t.complete);
+
+    clock.setSynchronized(true);
+    trace.check();
+    EXPECT_TRUE(t.complete);
+}
+
+TEST_F(TestModeTrace, nextSwitchClosesOpenOne)
+{
+    switchTo(Mode::NTP);
+    switchTo(Mode::Manual);
+    ASSERT_EQ(2U, trace.transitions().size());
+    EXPECT_FALSE(trace.transitions().front().complete);
+
+    // The closed one takes no more stages
+    trace.onNtp(false);
+    EXPECT_FALSE(trace.transitions().front().duration(Stage::TimedateNtp));
+    EXPECT_TRUE(trace.transitions().back().complete);
+}
+
+TEST_F(TestModeTrace, ringKeepsTheLast)
+{
+    for (auto mode : {Mode::NTP, Mode::Manual, Mode::NTP, Mode::Manual})
+    {
+        switchTo(mode);
+    }
+    ASSERT_EQ(3U, trace.transitions().size());
+    EXPECT_EQ(Mode::Manual, trace.transitions().front().mode);
+    EXPECT_EQ(Mode::Manual, trace.transitions().back().mode);
+
+    // Without a settings signal, e.g. at startup, the switch starts with
+    // the SetNTP call
+    trace.begin(Mode::NTP);
+    EXPECT_FALSE(trace.transitions().back().duration(Stage::Signal));
+}
+
+} // namespace time
+} // namespace phosphor
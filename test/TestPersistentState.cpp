@@ -0,0 +1,81 @@
+#include "persistent_state.hpp"
+#include "types.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+namespace state
+{
+
+class TestPersistentState : public testing::Test
+{
+  public:
+    std::filesystem::path dir;
+    std::string path;
+
+    TestPersistentState()
+    {
+        char tmpl[] = "/tmp/TestPersistentState.XXXXXX";
+        dir = mkdtemp(tmpl);
+        path = dir / "state";
+    }
+
+    ~TestPersistentState() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    TestPersistentState(const TestPersistentState&) = delete;
+    TestPersistentState(TestPersistentState&&) = delete;
+    TestPersistentState& operator=(const TestPersistentState&) = delete;
+    TestPersistentState& operator=(TestPersistentState&&) = delete;
+};
+
+TEST_F(TestPersistentState, saveAndLoad)
+{
+    State saved;
+    saved.mode = Mode::NTP;
+    saved.settingsPath = "/xyz/openbmc_project/time/sync_method";
+    saved.settingsService = "xyz.openbmc_project.Settings";
+    saved.ntp = true;
+
+    ASSERT_TRUE(save(path, saved));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    auto loaded = load(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(Mode::NTP, loaded->mode);
+    EXPECT_EQ(saved.settingsPath, loaded->settingsPath);
+    EXPECT_EQ(saved.settingsService, loaded->settingsService);
+    EXPECT_TRUE(loaded->ntp);
+}
+
+TEST_F(TestPersistentState, missingFile)
+{
+    EXPECT_FALSE(load(path));
+}
+
+TEST_F(TestPersistentState, invalidFile)
+{
+    {
+        std::ofstream file(path);
+        file << "mode=whatever\nsettingsPath=/a\nsettingsService=b\nntp=0\n";
+    }
+    EXPECT_FALSE(load(path));
+
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << "settingsPath=/a\n";
+    }
+    EXPECT_FALSE(load(path));
+}
+
+} // namespace state
+} // namespace time
+} // namespace phosphor
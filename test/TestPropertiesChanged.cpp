@@ -0,0 +1,286 @@
+#include "clock.hpp"
+#include "clock_source.hpp"
+#include "events.hpp"
+#include "harness.hpp"
+#include "holdover.hpp"
+#include "mode_trace.hpp"
+#include "ptp_standin.hpp"
+#include "ptp_sync.hpp"
+#include "rtc_monitor.hpp"
+#include "scheduled_set.hpp"
+#include "time_transaction.hpp"
+#include "time_zone.hpp"
+#include "types.hpp"
+#include "write_back.hpp"
+
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/* The PropertiesChanged signals of the interfaces of the daemon, received
+ * back on a private dbus-daemon. sd-bus refuses to emit the signal for a
+ * property registered without the emits_change flag, and property_changed
+ * does not report it, so only a subscriber sees whether it is sent. The
+ * values are read by the getters when the signal is built, so they are
+ * checked as well.
+ */
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+namespace rules = sdbusplus::bus::match::rules;
+
+/** @brief A value of a property of the interfaces */
+using Value = std::variant<
+    bool, uint16_t, int64_t, uint64_t, double, std::string,
+    std::vector<std::tuple<uint64_t, uint64_t, uint64_t>>,
+    std::vector<std::tuple<std::string, std::string, uint64_t>>,
+    std::vector<std::tuple<std::string, bool,
+                           std::vector<std::tuple<std::string, uint64_t>>>>>;
+
+class TestPropertiesChanged : public testing::Test
+{
+  public:
+    bench::PrivateBus privateBus;
+    sdbusplus::bus_t bus;
+    SimulatedClock clock;
+    TimeEvents events;
+    fs::path dir;
+
+    /** @brief The last value signaled of each property */
+    std::map<std::string, Value> changed;
+
+    std::optional<sdbusplus::bus::match_t> match;
+
+    TestPropertiesChanged() : bus(bench::connect(privateBus.address()))
+    {
+        char tmpl[] = "/tmp/TestPropertiesChanged.XXXXXX";
+        dir = mkdtemp(tmpl);
+    }
+
+    ~TestPropertiesChanged() override
+    {
+        fs::remove_all(dir);
+    }
+
+    TestPropertiesChanged(const TestPropertiesChanged&) = delete;
+    TestPropertiesChanged(TestPropertiesChanged&&) = delete;
+    TestPropertiesChanged& operator=(const TestPropertiesChanged&) = delete;
+    TestPropertiesChanged& operator=(TestPropertiesChanged&&) = delete;
+
+    /** @brief Record the PropertiesChanged of the interface from now on */
+    void watch(const char* intf)
+    {
+        match.emplace(bus, rules::propertiesChanged(objpathBmc, intf),
+                      [this](sdbusplus::message_t& m) {
+                          std::string name;
+                          std::map<std::string, Value> values;
+                          m.read(name, values);
+                          for (auto& [property, value] : values)
+                          {
+                              changed.insert_or_assign(property,
+                                                       std::move(value));
+                          }
+                      });
+    }
+
+    /** @brief Wait for the signal of a property
+     *
+     * @return The value it carried, if it came and has the type
+     */
+    template <typename T>
+    std::optional<T> received(const std::string& property)
+    {
+        bench::runUntil(
+            bus, [&]() { return changed.contains(property); }, seconds(5));
+        auto it = changed.find(property);
+        if (it == changed.end() || !std::holds_alternative<T>(it->second))
+        {
+            return std::nullopt;
+        }
+        return std::get<T>(it->second);
+    }
+};
+
+constexpr microseconds target = seconds(1704067200); // 2024-01-01
+
+TEST_F(TestPropertiesChanged, modeTraceTransitions)
+{
+    watch(modeTraceIntf);
+    ModeTrace trace(bus, objpathBmc, clock);
+
+    trace.begin(Mode::NTP);
+    using Transitions = std::vector<std::tuple<
+        std::string, bool, std::vector<std::tuple<std::string, uint64_t>>>>;
+    auto transitions = received<Transitions>("Transitions");
+    ASSERT_TRUE(transitions);
+    ASSERT_EQ(1U, transitions->size());
+    EXPECT_EQ(utils::modeToStr(Mode::NTP), std::get<0>(transitions->front()));
+    EXPECT_FALSE(std::get<1>(transitions->front()));
+}
+
+TEST_F(TestPropertiesChanged, timeZone)
+{
+    watch(timeZoneIntf);
+    fs::create_symlink("/usr/share/zoneinfo/Europe/Berlin", dir / "localtime");
+    TimeZone zone(bus, objpathBmc, clock, events, dir / "localtime");
+
+    EXPECT_EQ("Europe/Berlin", received<std::string>("Name"));
+}
+
+TEST_F(TestPropertiesChanged, rtc)
+{
+    watch(rtcIntf);
+    RtcMonitor monitor(bus, objpathBmc, clock, events, Mode::Manual,
+                       dir / "rtc0");
+
+    monitor.check();
+    EXPECT_EQ("Failed", received<std::string>("Health"));
+}
+
+TEST_F(TestPropertiesChanged, scheduledSet)
+{
+    watch(scheduledSetIntf);
+    ScheduledSet scheduled(bus, objpathBmc, clock,
+                           [this](microseconds delta) {
+                               return clock.stepBy(delta);
+                           });
+
+    auto deadline = clock.monotonic() + seconds(10);
+    auto id = scheduled.schedule(target, deadline);
+    ASSERT_TRUE(id);
+    using Pending = std::vector<std::tuple<uint64_t, uint64_t, uint64_t>>;
+    auto pending = received<Pending>("Pending");
+    ASSERT_TRUE(pending);
+    EXPECT_EQ((Pending{{*id, target.count(), deadline.count()}}), *pending);
+
+    changed.clear();
+    clock.advance(milliseconds(10003));
+    scheduled.apply();
+    EXPECT_EQ(3000, received<int64_t>("LastJitter"));
+    EXPECT_EQ(Pending{}, received<Pending>("Pending"));
+}
+
+TEST_F(TestPropertiesChanged, transaction)
+{
+    watch(transactionIntf);
+    TimeTransaction transaction(
+        bus, objpathBmc, clock,
+        {[]() { return Mode::Manual; },
+         [](Mode) -> utils::Expected<void> { return {}; },
+         [](bool) -> utils::Expected<void> { return {}; },
+         [this](microseconds t) { return clock.step(t); }});
+
+    ASSERT_TRUE(transaction.setManualTime(target, false));
+    using Stages = std::vector<std::tuple<std::string, std::string, uint64_t>>;
+    auto stages = received<Stages>("LastStages");
+    ASSERT_TRUE(stages);
+    EXPECT_EQ((Stages{{"mode", "Skipped", 0},
+                      {"ntp", "Skipped", 0},
+                      {"time", "Applied", 0},
+                      {"restore", "Skipped", 0}}),
+              *stages);
+}
+
+TEST_F(TestPropertiesChanged, clockSource)
+{
+    watch(clockSourceIntf);
+    fs::create_directory(dir / "clocksource0");
+    std::ofstream(dir / "clocksource0" / "current_clocksource") << "tsc\n";
+    ClockSource source(bus, objpathBmc, events, dir,
+                       [this]() { return clock.now(); });
+
+    EXPECT_EQ("tsc", received<std::string>("Name"));
+    auto cost = received<uint64_t>("ReadCost");
+    ASSERT_TRUE(cost);
+    EXPECT_EQ(static_cast<uint64_t>(source.readCost().count()), *cost);
+}
+
+TEST_F(TestPropertiesChanged, writeBack)
+{
+    watch(writeBackIntf);
+    WriteBack::Done done;
+    WriteBack writeBack(bus, objpathBmc,
+                        [&done](const std::string&, WriteBack::Done d)
+                            -> utils::Expected<void> {
+                            done = std::move(d);
+                            return {};
+                        });
+
+    writeBack.write("NTP");
+    EXPECT_EQ(true, received<bool>("Pending"));
+
+    changed.clear();
+    done(std::unexpected(utils::Error{-ETIMEDOUT, "", "Timed out"}));
+    EXPECT_EQ(1U, received<uint64_t>("Failures"));
+    EXPECT_EQ("Timed out", received<std::string>("LastError"));
+}
+
+TEST_F(TestPropertiesChanged, ptp)
+{
+    watch(ptpIntf);
+    std::unique_ptr<StandIn> standIn;
+    PtpSync ptp(
+        bus, objpathBmc, events, dir / "ptp4l", Mode::Manual,
+        []() -> utils::Expected<void> { return {}; },
+        [&](bool start) -> utils::Expected<void> {
+            if (start)
+            {
+                standIn = std::make_unique<StandIn>(dir / "ptp4l");
+            }
+            return {};
+        },
+        []() -> utils::Expected<bool> { return false; });
+
+    ASSERT_TRUE(ptp.enable(true));
+    EXPECT_EQ(true, received<bool>("Enabled"));
+
+    // The signals carry the data set just read, not the one before
+    ptp.poll();
+    ASSERT_EQ(1U, standIn->answer(1, 250, 15000));
+    ASSERT_TRUE(ptp.receive());
+    EXPECT_EQ(250, received<int64_t>("Offset"));
+    EXPECT_EQ(15000, received<int64_t>("PathDelay"));
+    EXPECT_EQ(1, received<uint16_t>("StepsRemoved"));
+    EXPECT_EQ(true, received<bool>("Synchronized"));
+}
+
+TEST_F(TestPropertiesChanged, holdover)
+{
+    watch(holdoverIntf);
+    Holdover holdover(bus, objpathBmc, clock, events, hours(24));
+
+    holdover.setNtpMode(true);
+    clock.setSynchronized(true, milliseconds(1));
+    for (uint64_t i = 0; i < Holdover::minSamples; ++i)
+    {
+        clock.advance(Holdover::sampleInterval);
+        holdover.sample();
+    }
+
+    clock.setSynchronized(false);
+    clock.advance(Holdover::sampleInterval);
+    holdover.sample();
+    EXPECT_EQ(true, received<bool>("Active"));
+}
+
+} // namespace time
+} // namespace phosphor
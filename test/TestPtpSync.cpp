@@ -0,0 +1,255 @@
+#include "events.hpp"
+#include "ptp_standin.hpp"
+#include "ptp_sync.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+class TestPtpSync : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    fs::path dir;
+    TimeEvents events;
+    std::vector<std::string> calls;
+    utils::Expected<void> manualResult;
+    Mode mode = Mode::Manual;
+    bool running = false;
+    std::unique_ptr<StandIn> standIn;
+    std::unique_ptr<PtpSync> ptp;
+
+    TestPtpSync() : bus(sdbusplus::bus::new_default())
+    {
+        char tmpl[] = "/tmp/TestPtpSync.XXXXXX";
+        dir = mkdtemp(tmpl);
+    }
+
+    ~TestPtpSync() override
+    {
+        ptp.reset();
+        standIn.reset();
+        fs::remove_all(dir);
+    }
+
+    TestPtpSync(const TestPtpSync&) = delete;
+    TestPtpSync(TestPtpSync&&) = delete;
+    TestPtpSync& operator=(const TestPtpSync&) = delete;
+    TestPtpSync& operator=(TestPtpSync&&) = delete;
+
+    void create()
+    {
+        ptp = std::make_unique<PtpSync>(
+            bus, objpathBmc, events, dir / "ptp4l", mode,
+            [this]() {
+                calls.emplace_back("manual");
+                return manualResult;
+            },
+            [this](bool start) -> utils::Expected<void> {
+                calls.emplace_back(start ? "start" : "stop");
+                // Started units create the socket
+                if (start)
+                {
+                    standIn = std::make_unique<StandIn>(dir / "ptp4l");
+                }
+                else
+                {
+                    standIn.reset();
+                    fs::remove(dir / "ptp4l");
+                }
+                running = start;
+                return {};
+            },
+            [this]() -> utils::Expected<bool> { return running; });
+    }
+};
+
+TEST(TestPtpMessage, request)
+{
+    auto m = PtpSync::makeRequest(0x1234);
+    EXPECT_EQ(0x0d, m[0]); // management
+    EXPECT_EQ(0x02, m[1]); // PTP v2
+    EXPECT_EQ(54, m[3]); // length
+    EXPECT_EQ(0x12, m[30]); // sequence id
+    EXPECT_EQ(0x34, m[31]);
+    EXPECT_EQ(0xff, m[34]); // any target port
+    EXPECT_EQ(0x00, m[46]); // GET
+    EXPECT_EQ(0x01, m[49]); // MANAGEMENT TLV
+    EXPECT_EQ(0x20, m[52]); // CURRENT_DATA_SET
+    EXPECT_EQ(0x01, m[53]);
+}
+
+TEST(TestPtpMessage, errorStatus)
+{
+    auto request = PtpSync::makeRequest(7);
+    std::vector<uint8_t> m(request.begin(), request.end());
+    m[46] = 2;    // RESPONSE
+    m[49] = 0x02; // MANAGEMENT_ERROR_STATUS
+    m[53] = 0x02; // NOT_SUPPORTED
+
+    auto result = PtpSync::parseResponse(m, 7);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(-EBADMSG, result.error().errnum);
+
+    // Nor is a response to another request taken
+    EXPECT_FALSE(PtpSync::parseResponse(request, 8));
+}
+
+TEST_F(TestPtpSync, enableAndTrack)
+{
+    create();
+    EXPECT_FALSE(ptp->enabled());
+    EXPECT_TRUE(calls.empty());
+
+    ASSERT_TRUE(ptp->enable(true));
+    EXPECT_TRUE(ptp->enabled());
+    EXPECT_EQ((std::vector<std::string>{"manual", "start"}), calls);
+
+    ptp->poll();
+    EXPECT_EQ(1U, standIn->answer(1, 250, 15000));
+    EXPECT_TRUE(ptp->receive());
+    EXPECT_TRUE(ptp->synchronized());
+    EXPECT_EQ(nanoseconds(250), ptp->dataSet().offset);
+    EXPECT_EQ(nanoseconds(15000), ptp->dataSet().pathDelay);
+    EXPECT_EQ(1, ptp->dataSet().stepsRemoved);
+    EXPECT_EQ(PtpSync::minInterval * 2, ptp->interval());
+
+    // A large offset reads at the shortest interval again
+    ptp->poll();
+    EXPECT_EQ(1U, standIn->answer(1, -40000, 15000));
+    EXPECT_TRUE(ptp->receive());
+    EXPECT_FALSE(ptp->synchronized());
+    EXPECT_EQ(nanoseconds(-40000), ptp->dataSet().offset);
+    EXPECT_EQ(PtpSync::minInterval, ptp->interval());
+}
+
+TEST_F(TestPtpSync, backsOffWhileLocked)
+{
+    create();
+    ASSERT_TRUE(ptp->enable(true));
+    for (int i = 0; i < 10; ++i)
+    {
+        ptp->poll();
+        standIn->answer(2, 30, 900);
+        ptp->receive();
+    }
+    EXPECT_TRUE(ptp->synchronized());
+    EXPECT_EQ(PtpSync::maxInterval, ptp->interval());
+}
+
+TEST_F(TestPtpSync, lostWhenNotAnswered)
+{
+    create();
+    ASSERT_TRUE(ptp->enable(true));
+    ptp->poll();
+    standIn->answer(1, 10, 900);
+    ptp->receive();
+    ptp->poll();
+    standIn->answer(1, 10, 900);
+    ptp->receive();
+    ASSERT_TRUE(ptp->synchronized());
+
+    for (unsigned i = 0; i < PtpSync::maxMissed; ++i)
+    {
+        ptp->poll();
+    }
+    EXPECT_TRUE(ptp->synchronized());
+    ptp->poll();
+    EXPECT_FALSE(ptp->synchronized());
+    EXPECT_EQ(PtpSync::minInterval, ptp->interval());
+
+    // The stale requests are skipped, the last one is answered
+    EXPECT_EQ(PtpSync::maxMissed + 1, standIn->answer(1, 10, 900));
+    EXPECT_TRUE(ptp->receive());
+    EXPECT_TRUE(ptp->synchronized());
+}
+
+TEST_F(TestPtpSync, stoppedByNtpMode)
+{
+    create();
+    ASSERT_TRUE(ptp->enable(true));
+    ptp->poll();
+    standIn->answer(1, 10, 900);
+    ptp->receive();
+
+    events.publish(event::ModeChanged{Mode::Manual});
+    EXPECT_TRUE(ptp->enabled());
+
+    events.publish(event::ModeChanged{Mode::NTP});
+    EXPECT_FALSE(ptp->enabled());
+    EXPECT_FALSE(ptp->synchronized());
+    EXPECT_EQ((std::vector<std::string>{"manual", "start", "stop"}), calls);
+}
+
+TEST_F(TestPtpSync, notStartedIfManualFails)
+{
+    manualResult = std::unexpected(utils::Error{-EIO, "", "settings"});
+    create();
+
+    EXPECT_FALSE(ptp->enable(true));
+    EXPECT_FALSE(ptp->enabled());
+    EXPECT_EQ((std::vector<std::string>{"manual"}), calls);
+}
+
+TEST_F(TestPtpSync, runningUnitsAreResumed)
+{
+    running = true;
+    standIn = std::make_unique<StandIn>(dir / "ptp4l");
+    create();
+
+    // Manual mode and NTP off are asserted again, starting the units that
+    // run already does nothing
+    EXPECT_TRUE(ptp->enabled());
+    EXPECT_EQ((std::vector<std::string>{"manual", "start"}), calls);
+    ptp->poll();
+    EXPECT_EQ(1U, standIn->answer(1, 10, 900));
+    EXPECT_TRUE(ptp->receive());
+}
+
+TEST_F(TestPtpSync, runningUnitsAreStoppedInNtpMode)
+{
+    running = true;
+    mode = Mode::NTP;
+    standIn = std::make_unique<StandIn>(dir / "ptp4l");
+    create();
+
+    EXPECT_FALSE(ptp->enabled());
+    EXPECT_EQ((std::vector<std::string>{"stop"}), calls);
+    EXPECT_FALSE(running);
+}
+
+TEST_F(TestPtpSync, staleSocketIsIgnored)
+{
+    // A killed ptp4l leaves its socket behind
+    standIn = std::make_unique<StandIn>(dir / "ptp4l");
+    create();
+
+    EXPECT_FALSE(ptp->enabled());
+    EXPECT_TRUE(calls.empty());
+}
+
+TEST_F(TestPtpSync, unitsStoppedWhenNotResumed)
+{
+    running = true;
+    manualResult = std::unexpected(utils::Error{-EIO, "", "timedated"});
+    create();
+
+    EXPECT_FALSE(ptp->enabled());
+    EXPECT_EQ((std::vector<std::string>{"manual", "stop"}), calls);
+}
+
+} // namespace time
+} // namespace phosphor
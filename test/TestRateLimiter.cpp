@@ -0,0 +1,127 @@
+#include "rate_limiter.hpp"
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+using Clock = RateLimiter::Clock;
+
+TEST(TestRateLimiter, disabled)
+{
+    RateLimiter limiter(0, 1, 4);
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(limiter.admit(":1.1"));
+    }
+    EXPECT_EQ(0, limiter.totalRejected());
+}
+
+TEST(TestRateLimiter, burstThenRefill)
+{
+    RateLimiter limiter(60, 3, 4);
+    auto now = Clock::now();
+
+    EXPECT_TRUE(limiter.admit(":1.1", now));
+    EXPECT_TRUE(limiter.admit(":1.1", now));
+    EXPECT_TRUE(limiter.admit(":1.1", now));
+    EXPECT_FALSE(limiter.admit(":1.1", now));
+
+    // One token per second
+    EXPECT_FALSE(limiter.admit(":1.1", now + milliseconds(500)));
+    EXPECT_TRUE(limiter.admit(":1.1", now + seconds(1)));
+    EXPECT_FALSE(limiter.admit(":1.1", now + seconds(1)));
+
+    auto counters = limiter.counters();
+    EXPECT_EQ(4, counters[":1.1"].admitted);
+    EXPECT_EQ(3, counters[":1.1"].rejected);
+    EXPECT_EQ(3, limiter.totalRejected());
+    EXPECT_EQ(3, limiter.counters(":1.1").rejected);
+    EXPECT_EQ(0, limiter.counters(":1.9").admitted);
+}
+
+TEST(TestRateLimiter, sendersAreIndependent)
+{
+    RateLimiter limiter(60, 1, 4);
+    auto now = Clock::now();
+
+    EXPECT_TRUE(limiter.admit(":1.1", now));
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_FALSE(limiter.admit(":1.1", now));
+    }
+
+    // A flooding sender does not starve the others
+    EXPECT_TRUE(limiter.admit(":1.2", now));
+    EXPECT_TRUE(limiter.admit(":1.3", now));
+}
+
+TEST(TestRateLimiter, boundedSenders)
+{
+    RateLimiter limiter(60, 1, 2);
+    auto now = Clock::now();
+
+    EXPECT_TRUE(limiter.admit(":1.1", now));
+    EXPECT_TRUE(limiter.admit(":1.2", now + seconds(1)));
+    EXPECT_TRUE(limiter.admit(":1.3", now + seconds(1)));
+
+    auto counters = limiter.counters();
+    EXPECT_EQ(2, counters.size());
+    EXPECT_FALSE(counters.contains(":1.1"));
+}
+
+TEST(TestRateLimiter, busySendersAreKept)
+{
+    RateLimiter limiter(60, 2, 2);
+    auto now = Clock::now();
+
+    EXPECT_TRUE(limiter.admit(":1.1", now));
+    EXPECT_TRUE(limiter.admit(":1.2", now));
+    EXPECT_TRUE(limiter.admit(":1.2", now));
+
+    // New names neither push out a busy sender nor get a slot of their
+    // own, they share one bucket
+    EXPECT_TRUE(limiter.admit(":1.3", now));
+    EXPECT_TRUE(limiter.admit(":1.4", now));
+    EXPECT_FALSE(limiter.admit(":1.5", now));
+    EXPECT_FALSE(limiter.admit(":1.3", now));
+    EXPECT_EQ(2U, limiter.totalRejected());
+    EXPECT_EQ(1U, limiter.counters(":1.1").admitted);
+    EXPECT_EQ(2U, limiter.counters(":1.5").rejected);
+
+    auto counters = limiter.counters();
+    EXPECT_EQ(3U, counters.size());
+    EXPECT_FALSE(counters.contains(":1.3"));
+    EXPECT_EQ(2U, counters[std::string(RateLimiter::overflowSender)].admitted);
+    EXPECT_EQ(2U, counters[std::string(RateLimiter::overflowSender)].rejected);
+
+    // Once a sender is idle its slot is taken, the busier one is kept
+    EXPECT_TRUE(limiter.admit(":1.3", now + seconds(1)));
+    counters = limiter.counters();
+    EXPECT_TRUE(counters.contains(":1.2"));
+    EXPECT_TRUE(counters.contains(":1.3"));
+    EXPECT_FALSE(counters.contains(":1.1"));
+}
+
+TEST(TestRateLimiter, slotsHeldByOneClient)
+{
+    RateLimiter limiter(60, 1, 4);
+    auto now = Clock::now();
+
+    // A client with a connection in every slot, all of them busy
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(limiter.admit(":1." + std::to_string(10 + i), now));
+    }
+
+    // Another client is throttled, not locked out
+    EXPECT_TRUE(limiter.admit(":1.99", now));
+    EXPECT_FALSE(limiter.admit(":1.99", now));
+    EXPECT_TRUE(limiter.admit(":1.99", now + seconds(1)));
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,245 @@
+#include "clock.hpp"
+#include "events.hpp"
+#include "rtc_monitor.hpp"
+#include "types.hpp"
+
+#include <linux/rtc.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+
+#include <cerrno>
+#include <cstdarg>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+/** @brief The time of the fake RTC in seconds since UTC */
+time_t fakeRtcTime = 0;
+
+/** @brief The errno RTC_RD_TIME of the fake RTC fails with, 0 to succeed */
+int fakeRtcErrno = 0;
+} // namespace
+
+// A regular file stands in for the RTC device, and RTC_RD_TIME on it is
+// answered from the fake time. Any other ioctl goes to the kernel.
+extern "C" int ioctl(int fd, unsigned long request, ...)
+{
+    va_list args;
+    va_start(args, request);
+    void* arg = va_arg(args, void*);
+    va_end(args);
+
+    struct stat st{};
+    if (request != RTC_RD_TIME || fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+    {
+        return static_cast<int>(syscall(SYS_ioctl, fd, request, arg));
+    }
+    if (fakeRtcErrno != 0)
+    {
+        errno = fakeRtcErrno;
+        return -1;
+    }
+
+    tm tm{};
+    gmtime_r(&fakeRtcTime, &tm);
+    auto* rtc = static_cast<rtc_time*>(arg);
+    *rtc = rtc_time{};
+    rtc->tm_sec = tm.tm_sec;
+    rtc->tm_min = tm.tm_min;
+    rtc->tm_hour = tm.tm_hour;
+    rtc->tm_mday = tm.tm_mday;
+    rtc->tm_mon = tm.tm_mon;
+    rtc->tm_year = tm.tm_year;
+    return 0;
+}
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+class TestRtcMonitor : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    fs::path device;
+    SimulatedClock clock;
+    TimeEvents events;
+    std::unique_ptr<RtcMonitor> monitor;
+
+    TestRtcMonitor() : bus(sdbusplus::bus::new_default())
+    {
+        char tmpl[] = "/tmp/TestRtcMonitor.XXXXXX";
+        device = fs::path(mkdtemp(tmpl)) / "rtc0";
+        std::ofstream(device).put('\0');
+        monitor = std::make_unique<RtcMonitor>(bus, objpathBmc, clock, events,
+                                               Mode::Manual, device);
+        setRtc(seconds(0));
+        fakeRtcErrno = 0;
+    }
+
+    ~TestRtcMonitor() override
+    {
+        monitor.reset();
+        fs::remove_all(device.parent_path());
+    }
+
+    TestRtcMonitor(const TestRtcMonitor&) = delete;
+    TestRtcMonitor(TestRtcMonitor&&) = delete;
+    TestRtcMonitor& operator=(const TestRtcMonitor&) = delete;
+    TestRtcMonitor& operator=(TestRtcMonitor&&) = delete;
+
+    /** @brief Set the fake RTC off the clock by the given drift */
+    void setRtc(seconds drift)
+    {
+        fakeRtcTime = (duration_cast<seconds>(clock.now()) + drift).count();
+    }
+};
+
+TEST_F(TestRtcMonitor, readsFakeRtc)
+{
+    setRtc(seconds(0));
+    auto rtc = RtcMonitor::readRtc(device);
+    ASSERT_TRUE(rtc);
+    EXPECT_EQ(duration_cast<seconds>(clock.now()), *rtc);
+}
+
+TEST_F(TestRtcMonitor, agreeingClocksBackOff)
+{
+    EXPECT_EQ(RtcMonitor::Health::Unknown, monitor->health());
+
+    setRtc(seconds(1));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+    EXPECT_EQ(seconds(1), monitor->drift());
+    EXPECT_EQ(RtcMonitor::minInterval * 2, monitor->interval());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        monitor->check();
+    }
+    EXPECT_EQ(RtcMonitor::maxInterval, monitor->interval());
+}
+
+TEST_F(TestRtcMonitor, driftIsDetected)
+{
+    monitor->check();
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+
+    setRtc(seconds(-30));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::Drifted, monitor->health());
+    EXPECT_EQ(seconds(-30), monitor->drift());
+    EXPECT_EQ(RtcMonitor::minInterval, monitor->interval());
+
+    setRtc(seconds(0));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+}
+
+TEST_F(TestRtcMonitor, jumpChecksAgain)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        monitor->check();
+    }
+    EXPECT_LT(RtcMonitor::minInterval, monitor->interval());
+
+    // Back to the shortest interval, the jump itself is checked after
+    // settleDelay on the timer
+    events.publish(event::Jump{seconds(90)});
+    EXPECT_EQ(RtcMonitor::minInterval, monitor->interval());
+}
+
+TEST_F(TestRtcMonitor, ntpModeAllowsForKernelSync)
+{
+    events.publish(event::ModeChanged{Mode::NTP});
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+
+    // The NTP daemon stepped the clock, and the kernel writes the RTC on
+    // its next sync only
+    clock.jump(seconds(30));
+    events.publish(event::Jump{seconds(30)});
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+    EXPECT_EQ(seconds(-30), monitor->drift());
+    EXPECT_EQ(RtcMonitor::minInterval, monitor->interval());
+
+    clock.advance(RtcMonitor::kernelSyncDelay - seconds(1));
+    setRtc(seconds(-30));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+
+    // A drift the kernel did not fix in time is reported
+    clock.advance(seconds(1));
+    setRtc(seconds(-30));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::Drifted, monitor->health());
+}
+
+TEST_F(TestRtcMonitor, ntpModeSyncedByKernel)
+{
+    events.publish(event::ModeChanged{Mode::NTP});
+    setRtc(seconds(-30));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::Unknown, monitor->health());
+
+    clock.advance(minutes(5));
+    setRtc(seconds(0));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+
+    // The grace starts over with the next drift
+    setRtc(seconds(-30));
+    monitor->check();
+    clock.advance(minutes(10));
+    setRtc(seconds(-30));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+}
+
+TEST_F(TestRtcMonitor, deadRtcFails)
+{
+    // The RTC lost its time, as with a flat battery
+    fakeRtcErrno = EINVAL;
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::Failed, monitor->health());
+    EXPECT_EQ(RtcMonitor::minInterval, monitor->interval());
+
+    fakeRtcErrno = 0;
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+}
+
+TEST_F(TestRtcMonitor, busyRtcKeepsHealth)
+{
+    monitor->check();
+    fakeRtcErrno = EBUSY;
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::OK, monitor->health());
+    EXPECT_EQ(RtcMonitor::minInterval, monitor->interval());
+}
+
+TEST_F(TestRtcMonitor, missingDeviceFails)
+{
+    fs::remove(device);
+    EXPECT_FALSE(RtcMonitor::readRtc(device));
+    monitor->check();
+    EXPECT_EQ(RtcMonitor::Health::Failed, monitor->health());
+}
+
+} // namespace time
+} // namespace phosphor
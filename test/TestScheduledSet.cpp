@@ -0,0 +1,173 @@
+#include "clock.hpp"
+#include "scheduled_set.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+class TestScheduledSet : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    SimulatedClock clock;
+    std::string rejected;
+    microseconds stepLatency{};
+    ScheduledSet scheduled;
+
+    TestScheduledSet() :
+        bus(sdbusplus::bus::new_default()),
+        scheduled(
+            bus, objpathBmc, clock,
+            [this](microseconds delta) {
+                // The time the step takes to reach the clock
+                clock.advance(stepLatency);
+                return clock.stepBy(delta);
+            },
+            [this](const char* sender) -> utils::Expected<void> {
+                if (rejected == sender)
+                {
+                    return std::unexpected(
+                        utils::Error{-EBUSY, "org.example.Busy", "busy"});
+                }
+                return {};
+            })
+    {}
+
+    /** @brief A deadline the given time from now */
+    microseconds in(microseconds duration) const
+    {
+        return clock.monotonic() + duration;
+    }
+};
+
+constexpr microseconds target = seconds(1704067200); // 2024-01-01
+
+TEST_F(TestScheduledSet, appliesAtDeadline)
+{
+    auto id = scheduled.schedule(target, in(seconds(10)));
+    ASSERT_TRUE(id);
+    ASSERT_EQ(1U, scheduled.pending().size());
+
+    // Nothing is due yet
+    clock.advance(seconds(9));
+    scheduled.apply();
+    EXPECT_EQ(0U, clock.steps());
+    EXPECT_EQ(1U, scheduled.pending().size());
+
+    clock.advance(seconds(1));
+    scheduled.apply();
+    EXPECT_EQ(1U, clock.steps());
+    EXPECT_EQ(target, clock.now());
+    EXPECT_EQ(microseconds(0), scheduled.lastJitter());
+    EXPECT_TRUE(scheduled.pending().empty());
+}
+
+TEST_F(TestScheduledSet, lateSetIsAdvanced)
+{
+    ASSERT_TRUE(scheduled.schedule(target, in(seconds(10))));
+    clock.advance(milliseconds(10003));
+    scheduled.apply();
+
+    // The clock reads as if it was set at the deadline
+    EXPECT_EQ(milliseconds(3), scheduled.lastJitter());
+    EXPECT_EQ(target + milliseconds(3), clock.now());
+}
+
+TEST_F(TestScheduledSet, stepLatencyIsMadeUp)
+{
+    stepLatency = milliseconds(2);
+    ASSERT_TRUE(scheduled.schedule(target, in(seconds(10))));
+    clock.advance(milliseconds(10003));
+    scheduled.apply();
+
+    // Neither the lateness nor the time of the step hold the clock back,
+    // and the jitter includes both
+    EXPECT_EQ(milliseconds(5), scheduled.lastJitter());
+    EXPECT_EQ(target + milliseconds(5), clock.now());
+}
+
+TEST_F(TestScheduledSet, pendingInDeadlineOrder)
+{
+    auto late = scheduled.schedule(target, in(seconds(20)));
+    auto early = scheduled.schedule(target + hours(1), in(seconds(10)));
+    ASSERT_TRUE(late && early);
+
+    const auto& pending = scheduled.pending();
+    ASSERT_EQ(2U, pending.size());
+    EXPECT_EQ(*early, pending[0].id);
+    EXPECT_EQ(*late, pending[1].id);
+
+    clock.advance(seconds(15));
+    scheduled.apply();
+    EXPECT_EQ(target + hours(1) + seconds(5), clock.now());
+    ASSERT_EQ(1U, scheduled.pending().size());
+    EXPECT_EQ(*late, scheduled.pending()[0].id);
+}
+
+TEST_F(TestScheduledSet, cancel)
+{
+    auto id = scheduled.schedule(target, in(seconds(10)));
+    ASSERT_TRUE(id);
+    EXPECT_TRUE(scheduled.cancel(*id));
+    EXPECT_FALSE(scheduled.cancel(*id));
+    EXPECT_TRUE(scheduled.pending().empty());
+
+    clock.advance(seconds(10));
+    scheduled.apply();
+    EXPECT_EQ(0U, clock.steps());
+}
+
+TEST_F(TestScheduledSet, rejectsPastDeadline)
+{
+    clock.advance(seconds(10));
+    auto id = scheduled.schedule(target, clock.monotonic());
+    ASSERT_FALSE(id);
+    EXPECT_EQ(-EINVAL, id.error().errnum);
+}
+
+TEST_F(TestScheduledSet, rejectsTooManyPending)
+{
+    for (size_t i = 0; i < ScheduledSet::maxPending; ++i)
+    {
+        ASSERT_TRUE(scheduled.schedule(target, in(seconds(10))));
+    }
+    auto id = scheduled.schedule(target, in(seconds(10)));
+    ASSERT_FALSE(id);
+    EXPECT_EQ(-ENOSPC, id.error().errnum);
+}
+
+TEST_F(TestScheduledSet, senderIsAdmitted)
+{
+    rejected = ":1.9";
+    ASSERT_TRUE(scheduled.schedule(target, in(seconds(10)), ":1.8"));
+
+    // A rejected sender queues nothing
+    auto id = scheduled.schedule(target, in(seconds(10)), ":1.9");
+    ASSERT_FALSE(id);
+    EXPECT_EQ(-EBUSY, id.error().errnum);
+    EXPECT_EQ(1U, scheduled.pending().size());
+}
+
+TEST_F(TestScheduledSet, failedStepKeepsJitter)
+{
+    ASSERT_TRUE(scheduled.schedule(target, in(seconds(10))));
+    clock.failSteps(utils::Error{-EIO, "", "SetTime failed"});
+    clock.advance(seconds(10));
+    scheduled.apply();
+
+    EXPECT_EQ(std::nullopt, scheduled.lastJitter());
+    EXPECT_TRUE(scheduled.pending().empty());
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,136 @@
+#include "harness.hpp"
+#include "scheduling.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+namespace
+{
+constexpr auto propertiesIntf = "org.freedesktop.DBus.Properties";
+constexpr uint8_t methodCall = SD_BUS_MESSAGE_METHOD_CALL;
+constexpr auto serverName = "org.example.Server";
+constexpr auto serverPath = "/org/example/server";
+
+/** @brief Record the members of the calls and reply to them */
+int onCall(sd_bus_message* msg, void* userData, sd_bus_error* /* error */)
+{
+    static_cast<std::vector<std::string>*>(userData)->emplace_back(
+        sd_bus_message_get_member(msg));
+    return sd_bus_reply_method_return(msg, nullptr);
+}
+
+/** @brief Send a call without waiting for its reply */
+void send(sdbusplus::bus_t& bus, const char* member)
+{
+    auto m = bus.new_method_call(serverName, serverPath, propertiesIntf,
+                                 member);
+    ASSERT_GE(sd_bus_send(bus.get(), m.get(), nullptr), 0);
+}
+} // namespace
+
+TEST(TestScheduling, classesAreOrdered)
+{
+    // sd-event dispatches the lower value first
+    EXPECT_LT(priority::high, priority::medium);
+    EXPECT_LT(priority::medium, priority::low);
+}
+
+TEST(TestScheduling, readsAreTheGetters)
+{
+    EXPECT_TRUE(ReadQueue::isRead(methodCall, propertiesIntf, "Get"));
+    EXPECT_TRUE(ReadQueue::isRead(methodCall, propertiesIntf, "GetAll"));
+    EXPECT_TRUE(ReadQueue::isRead(methodCall,
+                                  "org.freedesktop.DBus.ObjectManager",
+                                  "GetManagedObjects"));
+    EXPECT_TRUE(ReadQueue::isRead(methodCall,
+                                  "org.freedesktop.DBus.Introspectable",
+                                  "Introspect"));
+}
+
+TEST(TestScheduling, writesAreNoReads)
+{
+    EXPECT_FALSE(ReadQueue::isRead(methodCall, propertiesIntf, "Set"));
+    EXPECT_FALSE(ReadQueue::isRead(methodCall,
+                                   "xyz.openbmc_project.Time.Manager.DateTime",
+                                   "SetManualTime"));
+
+    // Nor are the signals the mode sync follows
+    EXPECT_FALSE(ReadQueue::isRead(SD_BUS_MESSAGE_SIGNAL, propertiesIntf,
+                                   "PropertiesChanged"));
+    EXPECT_FALSE(ReadQueue::isRead(SD_BUS_MESSAGE_METHOD_RETURN, "", ""));
+}
+
+TEST(TestScheduling, inertWithoutEventLoop)
+{
+    auto bus = sdbusplus::bus::new_default();
+    ReadQueue queue(bus, 0, 0);
+    EXPECT_EQ(0U, queue.queued());
+    EXPECT_EQ(0U, queue.release());
+}
+
+TEST(TestScheduling, signalBusIsAConnectionOfItsOwn)
+{
+    bench::PrivateBus privateBus;
+    privateBus.exportEnvironment();
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+
+    // The default connection of the thread is cached, the signals must not
+    // share it
+    auto bus = sdbusplus::bus::new_default();
+    auto signalBus = openSignalBus(event);
+    ASSERT_TRUE(signalBus);
+    EXPECT_NE(bus.get(), signalBus->get());
+    EXPECT_EQ(event, sd_bus_get_event(signalBus->get()));
+
+    signalBus->detach_event();
+    sd_event_unref(event);
+}
+
+TEST(TestScheduling, callsOfASenderKeepTheirOrder)
+{
+    bench::PrivateBus privateBus;
+    auto server = bench::connect(privateBus.address());
+    sd_event* event = nullptr;
+    ASSERT_GE(sd_event_new(&event), 0);
+    server.attach_event(event, priority::medium);
+    std::vector<std::string> calls;
+    ASSERT_GE(sd_bus_add_object(server.get(), nullptr, serverPath, onCall,
+                                &calls),
+              0);
+    server.request_name(serverName);
+
+    {
+        ReadQueue queue(server);
+        auto client = bench::connect(privateBus.address());
+        send(client, "Get");
+        send(client, "Set");
+        client.flush();
+
+        // The Get is queued, the Set of its sender waits for it
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::seconds(5);
+        while (calls.size() < 2 && std::chrono::steady_clock::now() < deadline)
+        {
+            sd_event_run(event, 100'000);
+        }
+        EXPECT_EQ((std::vector<std::string>{"Get", "Set"}), calls);
+        EXPECT_EQ(0U, queue.queued());
+    }
+
+    server.detach_event();
+    sd_event_unref(event);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,189 @@
+#include "clock.hpp"
+#include "time_transaction.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+class TestTimeTransaction : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    SimulatedClock clock;
+    Mode mode = Mode::NTP;
+    bool ntp = true;
+    std::vector<std::string> calls;
+    std::string failing;
+    std::string rejected;
+    TimeTransaction transaction;
+
+    TestTimeTransaction() :
+        bus(sdbusplus::bus::new_default()),
+        transaction(bus, objpathBmc, clock,
+                    {[this]() { return mode; },
+                     [this](Mode m) {
+                         return call(m == Mode::NTP ? "mode=NTP"
+                                                    : "mode=Manual",
+                                     [&]() { mode = m; });
+                     },
+                     [this](bool enable) {
+                         return call(enable ? "ntp=true" : "ntp=false",
+                                     [&]() { ntp = enable; });
+                     },
+                     [this](microseconds t) {
+                         // SetTime is refused by timedated while NTP is on
+                         if (ntp)
+                         {
+                             return call("step", []() {}, true);
+                         }
+                         clock.advance(milliseconds(2));
+                         return call("step", [&]() { clock.step(t); });
+                     }},
+                    [this](const char* sender) -> utils::Expected<void> {
+                        if (rejected == sender)
+                        {
+                            return std::unexpected(utils::Error{
+                                -EBUSY, "org.example.Busy", "Too many"});
+                        }
+                        return {};
+                    })
+    {}
+
+    /** @brief Record an operation and apply it unless it is made to fail */
+    template <typename F>
+    utils::Expected<void> call(const std::string& name, F apply,
+                               bool fail = false)
+    {
+        calls.push_back(name);
+        if (fail || name == failing)
+        {
+            return std::unexpected(
+                utils::Error{-EIO, "org.example.Failed", name + " failed"});
+        }
+        apply();
+        return {};
+    }
+
+    /** @brief The stages of the last transaction as name:result */
+    std::vector<std::string> stages() const
+    {
+        std::vector<std::string> result;
+        for (const auto& timing : transaction.lastStages())
+        {
+            result.push_back(timing.stage + ":" +
+                             TimeTransaction::toString(timing.result));
+        }
+        return result;
+    }
+};
+
+constexpr microseconds target = seconds(1704067200); // 2024-01-01
+
+TEST_F(TestTimeTransaction, setInNtpMode)
+{
+    ASSERT_TRUE(transaction.setManualTime(target, false));
+
+    EXPECT_EQ((std::vector<std::string>{"mode=Manual", "ntp=false", "step"}),
+              calls);
+    EXPECT_EQ((std::vector<std::string>{"mode:Applied", "ntp:Applied",
+                                        "time:Applied", "restore:Skipped"}),
+              stages());
+    EXPECT_EQ(Mode::Manual, mode);
+    EXPECT_FALSE(ntp);
+    EXPECT_EQ(target, clock.now());
+    EXPECT_EQ(milliseconds(2), transaction.lastStages()[2].duration);
+}
+
+TEST_F(TestTimeTransaction, restoresMode)
+{
+    ASSERT_TRUE(transaction.setManualTime(target, true));
+
+    EXPECT_EQ((std::vector<std::string>{"mode=Manual", "ntp=false", "step",
+                                        "mode=NTP", "ntp=true"}),
+              calls);
+    EXPECT_EQ("restore:Applied", stages().back());
+    EXPECT_EQ(Mode::NTP, mode);
+    EXPECT_TRUE(ntp);
+    EXPECT_EQ(target, clock.now());
+}
+
+TEST_F(TestTimeTransaction, manualModeOnlySteps)
+{
+    mode = Mode::Manual;
+    ntp = false;
+    ASSERT_TRUE(transaction.setManualTime(target, true));
+
+    EXPECT_EQ((std::vector<std::string>{"step"}), calls);
+    EXPECT_EQ((std::vector<std::string>{"mode:Skipped", "ntp:Skipped",
+                                        "time:Applied", "restore:Skipped"}),
+              stages());
+    EXPECT_EQ(Mode::Manual, mode);
+}
+
+TEST_F(TestTimeTransaction, failedNtpIsRolledBack)
+{
+    failing = "ntp=false";
+    auto result = transaction.setManualTime(target, true);
+    ASSERT_FALSE(result);
+    EXPECT_EQ("org.example.Failed", result.error().name);
+
+    EXPECT_EQ((std::vector<std::string>{"mode=Manual", "ntp=false",
+                                        "mode=NTP"}),
+              calls);
+    EXPECT_EQ((std::vector<std::string>{"mode:Applied", "ntp:Failed",
+                                        "mode:RolledBack"}),
+              stages());
+    EXPECT_EQ(Mode::NTP, mode);
+    EXPECT_EQ(0U, clock.steps());
+}
+
+TEST_F(TestTimeTransaction, failedRestoreStepsBack)
+{
+    auto start = clock.now();
+    failing = "ntp=true";
+    ASSERT_FALSE(transaction.setManualTime(target, true));
+
+    // The clock is where it would be without the transaction, the retried
+    // ntp stage fails again
+    EXPECT_EQ((std::vector<std::string>{"mode:Applied", "ntp:Applied",
+                                        "time:Applied", "restore:Failed",
+                                        "time:RolledBack",
+                                        "ntp:RollbackFailed",
+                                        "mode:RolledBack"}),
+              stages());
+    EXPECT_EQ(start + milliseconds(2), clock.now());
+    EXPECT_EQ(2U, clock.steps());
+    EXPECT_EQ(Mode::NTP, mode);
+}
+
+TEST_F(TestTimeTransaction, senderIsAdmitted)
+{
+    rejected = ":1.42";
+    auto result = transaction.setManualTime(target, true, ":1.42");
+    ASSERT_FALSE(result);
+    EXPECT_EQ("org.example.Busy", result.error().name);
+
+    // A rejected transaction runs no stage
+    EXPECT_TRUE(calls.empty());
+    EXPECT_TRUE(stages().empty());
+    EXPECT_EQ(Mode::NTP, mode);
+
+    // Another sender is admitted
+    EXPECT_TRUE(transaction.setManualTime(target, false, ":1.43"));
+    EXPECT_EQ((std::vector<std::string>{"mode=Manual", "ntp=false", "step"}),
+              calls);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,138 @@
+#include "clock.hpp"
+#include "events.hpp"
+#include "time_zone.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+namespace fs = std::filesystem;
+
+constexpr auto zoneinfo = "/usr/share/zoneinfo";
+
+class TestTimeZone : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    fs::path dir;
+    fs::path localtime;
+    SimulatedClock clock{seconds(1705320000)}; // 2024-01-15T12:00:00Z
+    TimeEvents events;
+    std::unique_ptr<TimeZone> timeZone;
+
+    TestTimeZone() : bus(sdbusplus::bus::new_default())
+    {
+        char tmpl[] = "/tmp/TestTimeZone.XXXXXX";
+        dir = mkdtemp(tmpl);
+        localtime = dir / "localtime";
+    }
+
+    ~TestTimeZone() override
+    {
+        timeZone.reset();
+        fs::remove_all(dir);
+    }
+
+    TestTimeZone(const TestTimeZone&) = delete;
+    TestTimeZone(TestTimeZone&&) = delete;
+    TestTimeZone& operator=(const TestTimeZone&) = delete;
+    TestTimeZone& operator=(TestTimeZone&&) = delete;
+
+    void SetUp() override
+    {
+        if (!fs::exists(fs::path(zoneinfo) / "Europe/Berlin") ||
+            !fs::exists(fs::path(zoneinfo) / "America/New_York"))
+        {
+            GTEST_SKIP() << "No zoneinfo database";
+        }
+    }
+
+    /** @brief Point the local time to a zone, as timedated does */
+    void link(const char* zone)
+    {
+        fs::remove(localtime);
+        fs::create_symlink(fs::path(zoneinfo) / zone, localtime);
+    }
+
+    void create()
+    {
+        timeZone = std::make_unique<TimeZone>(bus, objpathBmc, clock, events,
+                                              localtime);
+    }
+};
+
+TEST_F(TestTimeZone, readsLinkedZone)
+{
+    link("Europe/Berlin");
+    create();
+    EXPECT_EQ("Europe/Berlin", timeZone->name());
+    EXPECT_EQ(hours(1), timeZone->utcOffset());
+
+    // Daylight saving time starts 2024-03-31T01:00:00Z
+    EXPECT_EQ(seconds(1711846800), timeZone->nextChange());
+}
+
+TEST_F(TestTimeZone, jumpRefreshesOffset)
+{
+    link("Europe/Berlin");
+    create();
+
+    auto delta = hours(24 * 180);
+    clock.jump(delta);
+    events.publish(event::Jump{delta});
+    EXPECT_EQ(hours(2), timeZone->utcOffset());
+}
+
+TEST_F(TestTimeZone, refreshReadsReplacedFile)
+{
+    link("Europe/Berlin");
+    create();
+
+    // The cache is kept until it is refreshed
+    link("America/New_York");
+    EXPECT_EQ("Europe/Berlin", timeZone->name());
+    timeZone->refresh();
+    EXPECT_EQ("America/New_York", timeZone->name());
+    EXPECT_EQ(hours(-5), timeZone->utcOffset());
+}
+
+TEST_F(TestTimeZone, copiedFileUsesReportedName)
+{
+    fs::copy_file(fs::path(zoneinfo) / "America/New_York", localtime);
+    create();
+    EXPECT_EQ("", timeZone->name());
+    EXPECT_EQ(hours(-5), timeZone->utcOffset());
+
+    events.publish(event::Timezone{"America/New_York"});
+    EXPECT_EQ("America/New_York", timeZone->name());
+}
+
+TEST_F(TestTimeZone, missingFileIsUtc)
+{
+    create();
+    EXPECT_EQ("UTC", timeZone->name());
+    EXPECT_EQ(seconds(0), timeZone->utcOffset());
+    EXPECT_EQ(std::nullopt, timeZone->nextChange());
+}
+
+TEST_F(TestTimeZone, keepsTzOfProcess)
+{
+    setenv("TZ", "UTC0", 1);
+    link("Europe/Berlin");
+    create();
+    EXPECT_STREQ("UTC0", std::getenv("TZ"));
+    unsetenv("TZ");
+}
+
+} // namespace time
+} // namespace phosphor
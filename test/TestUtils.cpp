@@ -1,7 +1,12 @@
 #include "utils.hpp"
 
+#include <sdbusplus/bus.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <map>
+#include <variant>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 namespace phosphor
@@ -40,6 +45,59 @@ TEST(TestUtil, modeToStr)
     EXPECT_ANY_THROW(modeToStr(static_cast<Mode>(100)));
 }
 
+TEST(TestUtil, tryGetServiceFails)
+{
+    auto bus = sdbusplus::bus::new_default();
+    constexpr auto path = "/xyz/openbmc_project/time/test/missing";
+    constexpr auto intf = "xyz.openbmc_project.Time.Test.Missing";
+
+    // The failure is returned without throwing
+    auto service = tryGetService(bus, path, intf);
+    ASSERT_FALSE(service);
+    EXPECT_GT(0, service.error().errnum);
+    EXPECT_FALSE(service.error().message.empty());
+
+    // The compatibility wrapper still throws
+    EXPECT_THROW(getService(bus, path, intf), std::runtime_error);
+}
+
+TEST(TestUtil, getChangedProperty)
+{
+    auto bus = sdbusplus::bus::new_default();
+    using Value = std::variant<bool, std::string, uint64_t>;
+
+    // A PropertiesChanged as timedated sends it, sealed to be read back
+    auto signal = [&]() {
+        auto m = bus.new_signal("/org/freedesktop/timedate1",
+                                "org.freedesktop.DBus.Properties",
+                                "PropertiesChanged");
+        m.append("org.freedesktop.timedate1",
+                 std::map<std::string, Value>{
+                     {"NTP", true},
+                     {"TimeUSec", uint64_t(1704067200000000)},
+                     {"Timezone", std::string("UTC")}},
+                 std::vector<std::string>{});
+        sd_bus_message_seal(m.get(), 1, 0);
+        return m;
+    };
+
+    auto m = signal();
+    EXPECT_EQ(true, getChangedProperty<bool>(m, "NTP"));
+    m = signal();
+    EXPECT_EQ("UTC", getChangedProperty<std::string>(m, "Timezone"));
+
+    // Missing properties and properties of another type are not found
+    m = signal();
+    EXPECT_EQ(std::nullopt, getChangedProperty<bool>(m, "LocalRTC"));
+    m = signal();
+    EXPECT_EQ(std::nullopt, getChangedProperty<std::string>(m, "NTP"));
+
+    // The signal is rewound, so several properties are read from one signal
+    m = signal();
+    EXPECT_EQ("UTC", getChangedProperty<std::string>(m, "Timezone"));
+    EXPECT_EQ(true, getChangedProperty<bool>(m, "NTP"));
+}
+
 } // namespace utils
 } // namespace time
 } // namespace phosphor
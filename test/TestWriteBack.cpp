@@ -0,0 +1,159 @@
+#include "types.hpp"
+#include "write_back.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+using namespace std::chrono;
+
+class TestWriteBack : public testing::Test
+{
+  public:
+    sdbusplus::bus_t bus;
+    std::vector<std::string> sent;
+    WriteBack::Done done;
+    bool refuse = false;
+    WriteBack writeBack;
+
+    TestWriteBack() :
+        bus(sdbusplus::bus::new_default()),
+        writeBack(bus, objpathBmc,
+                  [this](const std::string& value,
+                         WriteBack::Done d) -> utils::Expected<void> {
+                      sent.push_back(value);
+                      if (refuse)
+                      {
+                          return std::unexpected(
+                              utils::Error{-ENOTCONN, "", "Not connected"});
+                      }
+                      done = std::move(d);
+                      return {};
+                  })
+    {}
+
+    /** @brief Complete the write on its way */
+    void complete(bool success = true)
+    {
+        auto d = std::move(done);
+        done = nullptr;
+        if (success)
+        {
+            d({});
+        }
+        else
+        {
+            d(std::unexpected(
+                utils::Error{-ETIMEDOUT, "", "Connection timed out"}));
+        }
+    }
+};
+
+TEST_F(TestWriteBack, written)
+{
+    writeBack.write("NTP");
+    EXPECT_TRUE(writeBack.pending());
+    EXPECT_EQ((std::vector<std::string>{"NTP"}), sent);
+
+    complete();
+    EXPECT_FALSE(writeBack.pending());
+    EXPECT_EQ(0U, writeBack.failures());
+}
+
+TEST_F(TestWriteBack, onlyLatestIsKept)
+{
+    writeBack.write("NTP");
+    writeBack.write("Manual");
+    writeBack.write("NTP2");
+
+    // The value on its way completes first, then only the latest is sent
+    complete();
+    EXPECT_TRUE(writeBack.pending());
+    EXPECT_EQ((std::vector<std::string>{"NTP", "NTP2"}), sent);
+
+    complete();
+    EXPECT_FALSE(writeBack.pending());
+}
+
+TEST_F(TestWriteBack, failureIsRetried)
+{
+    writeBack.write("NTP");
+    complete(false);
+    EXPECT_TRUE(writeBack.pending());
+    EXPECT_EQ(1U, writeBack.failures());
+    EXPECT_EQ("Connection timed out", writeBack.lastError());
+
+    writeBack.retry();
+    EXPECT_EQ((std::vector<std::string>{"NTP", "NTP"}), sent);
+    complete();
+    EXPECT_FALSE(writeBack.pending());
+    EXPECT_EQ(0U, writeBack.failures());
+    EXPECT_EQ("", writeBack.lastError());
+}
+
+TEST_F(TestWriteBack, backoffIsBounded)
+{
+    refuse = true;
+    writeBack.write("NTP");
+
+    std::vector<seconds> backoffs{writeBack.backoff()};
+    for (int i = 0; i < 8; ++i)
+    {
+        writeBack.retry();
+        backoffs.push_back(writeBack.backoff());
+    }
+    EXPECT_EQ((std::vector<seconds>{seconds(2), seconds(4), seconds(8),
+                                    seconds(16), seconds(32), seconds(64),
+                                    seconds(64), seconds(64), seconds(64)}),
+              backoffs);
+    EXPECT_EQ(9U, writeBack.failures());
+    EXPECT_EQ("Not connected", writeBack.lastError());
+
+    // A success starts the backoff over
+    refuse = false;
+    writeBack.retry();
+    complete();
+    EXPECT_EQ(WriteBack::minBackoff, writeBack.backoff());
+}
+
+TEST_F(TestWriteBack, superseded)
+{
+    refuse = true;
+    writeBack.write("NTP");
+    ASSERT_TRUE(writeBack.pending());
+
+    // The same value set by someone else keeps the write
+    writeBack.superseded("NTP");
+    EXPECT_TRUE(writeBack.pending());
+
+    writeBack.superseded("Manual");
+    EXPECT_FALSE(writeBack.pending());
+    writeBack.retry();
+    EXPECT_EQ(1U, sent.size());
+}
+
+TEST_F(TestWriteBack, echoOfWriteOnItsWay)
+{
+    writeBack.write("Manual");
+
+    // timedated flips NTP back before the Manual written signals
+    writeBack.write("NTP");
+    writeBack.superseded("Manual");
+    EXPECT_TRUE(writeBack.pending());
+
+    complete();
+    EXPECT_EQ((std::vector<std::string>{"Manual", "NTP"}), sent);
+    complete();
+    EXPECT_FALSE(writeBack.pending());
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ptp_sync.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @brief A ptp4l that answers the GETs of the CURRENT_DATA_SET on its
+ *         management socket, with the data set of a software timestamping
+ *         slave */
+class StandIn
+{
+  public:
+    explicit StandIn(const std::filesystem::path& path)
+    {
+        fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, path.c_str());
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+
+    ~StandIn()
+    {
+        close(fd);
+    }
+
+    StandIn(const StandIn&) = delete;
+    StandIn(StandIn&&) = delete;
+    StandIn& operator=(const StandIn&) = delete;
+    StandIn& operator=(StandIn&&) = delete;
+
+    /** @brief Answer the pending requests, return how many there were */
+    size_t answer(uint16_t steps, int64_t offsetNs, int64_t delayNs)
+    {
+        size_t answered = 0;
+        std::vector<uint8_t> m(128);
+        sockaddr_un from{};
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = 0;
+        while ((n = recvfrom(fd, m.data(), m.size(), 0,
+                             reinterpret_cast<sockaddr*>(&from), &fromLen)) >
+               0)
+        {
+            EXPECT_EQ(static_cast<ssize_t>(PtpSync::requestSize), n);
+            m.resize(PtpSync::responseSize);
+            m[2] = 0;
+            m[3] = PtpSync::responseSize;
+            m[46] = 2; // RESPONSE
+            m[50] = 0;
+            m[51] = 20;
+            put(m, 54, steps, 2);
+            put(m, 56, offsetNs * 65536, 8);
+            put(m, 64, delayNs * 65536, 8);
+            sendto(fd, m.data(), m.size(), 0,
+                   reinterpret_cast<sockaddr*>(&from), fromLen);
+            m.resize(128);
+            fromLen = sizeof(from);
+            ++answered;
+        }
+        return answered;
+    }
+
+  private:
+    int fd = -1;
+
+    static void put(std::vector<uint8_t>& m, size_t at, int64_t value,
+                    size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            m[at + size - 1 - i] = static_cast<uint64_t>(value) >> (8 * i);
+        }
+    }
+};
+
+} // namespace time
+} // namespace phosphor
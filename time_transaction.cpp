@@ -0,0 +1,243 @@
+#include "time_transaction.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto methodNameSetManualTime = "SetManualTime";
+constexpr auto propertyLastStages = "LastStages";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+namespace common = sdbusplus::xyz::openbmc_project::Common::Error;
+using namespace std::chrono;
+
+TimeTransaction::TimeTransaction(sdbusplus::bus_t& bus, const char* objPath,
+                                 const Clock& clock, Operations operations,
+                                 Admit admit) :
+    clock(clock), operations(std::move(operations)), admit(std::move(admit)),
+    interface(bus, objPath, transactionIntf, vtable, this)
+{}
+
+utils::Expected<void> TimeTransaction::setManualTime(microseconds time,
+                                                     bool restore,
+                                                     const char* sender)
+{
+    // A rejected transaction runs no stage and keeps the last ones
+    if (sender && admit)
+    {
+        auto admitted = admit(sender);
+        if (!admitted)
+        {
+            return admitted;
+        }
+    }
+
+    bool ntp = (Mode::NTP == operations.getMode());
+
+    // Where the clock would be without the transaction, for the rollback
+    microseconds from{};
+    microseconds at{};
+
+    std::vector<Stage> pipeline;
+    pipeline.push_back({"mode", nullptr, [this]() {
+                            return operations.setMode(Mode::NTP);
+                        }});
+    pipeline.push_back({"ntp", nullptr, [this]() {
+                            return operations.setNtp(true);
+                        }});
+    if (ntp)
+    {
+        pipeline[0].apply = [this]() {
+            return operations.setMode(Mode::Manual);
+        };
+        pipeline[1].apply = [this]() { return operations.setNtp(false); };
+    }
+    pipeline.push_back(
+        {"time",
+         [&]() {
+             from = clock.now();
+             at = clock.monotonic();
+             return operations.step(time);
+         },
+         [&]() { return operations.step(from + (clock.monotonic() - at)); }});
+    pipeline.push_back({"restore", nullptr, nullptr});
+    if (ntp && restore)
+    {
+        pipeline[3].apply = [this]() -> utils::Expected<void> {
+            auto result = operations.setMode(Mode::NTP);
+            if (!result)
+            {
+                return result;
+            }
+            return operations.setNtp(true);
+        };
+    }
+
+    auto result = run(pipeline);
+    if (result)
+    {
+        info("Set the time to {ELAPSED}us in a transaction", "ELAPSED",
+             time.count());
+    }
+    return result;
+}
+
+utils::Expected<void> TimeTransaction::run(const std::vector<Stage>& pipeline)
+{
+    stages.clear();
+    std::vector<const Stage*> applied;
+
+    for (const auto& stage : pipeline)
+    {
+        if (!stage.apply)
+        {
+            stages.push_back({stage.name, Result::Skipped, microseconds(0)});
+            continue;
+        }
+
+        auto start = clock.monotonic();
+        auto result = stage.apply();
+        auto duration = clock.monotonic() - start;
+        if (result)
+        {
+            stages.push_back({stage.name, Result::Applied, duration});
+            applied.push_back(&stage);
+            continue;
+        }
+
+        stages.push_back({stage.name, Result::Failed, duration});
+        error("Transaction stage {STAGE} failed: {ERROR}", "STAGE", stage.name,
+              "ERROR", result.error().message);
+
+        for (auto it = applied.rbegin(); it != applied.rend(); ++it)
+        {
+            start = clock.monotonic();
+            auto undone =
+                (*it)->undo ? (*it)->undo() : utils::Expected<void>{};
+            duration = clock.monotonic() - start;
+            if (!undone)
+            {
+                error("Failed to roll back transaction stage {STAGE}: {ERROR}",
+                      "STAGE", (*it)->name, "ERROR", undone.error().message);
+            }
+            stages.push_back({(*it)->name,
+                              undone ? Result::RolledBack
+                                     : Result::RollbackFailed,
+                              duration});
+        }
+        interface.property_changed(propertyLastStages);
+        return result;
+    }
+
+    interface.property_changed(propertyLastStages);
+    return {};
+}
+
+const char* TimeTransaction::toString(Result result)
+{
+    switch (result)
+    {
+        case Result::Applied:
+            return "Applied";
+        case Result::Skipped:
+            return "Skipped";
+        case Result::Failed:
+            return "Failed";
+        case Result::RolledBack:
+            return "RolledBack";
+        case Result::RollbackFailed:
+            return "RollbackFailed";
+    }
+    return "";
+}
+
+const sdbusplus::vtable_t TimeTransaction::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method(methodNameSetManualTime, "tb", "a(sst)",
+                              methodSetManualTime),
+    sdbusplus::vtable::property(propertyLastStages, "a(sst)", getLastStages,
+                                emitsChange),
+    sdbusplus::vtable::end(),
+};
+
+int TimeTransaction::appendStages(sd_bus_message* m,
+                                  const std::vector<Timing>& stages)
+{
+    auto r = sd_bus_message_open_container(m, 'a', "(sst)");
+    for (const auto& timing : stages)
+    {
+        if (r < 0)
+        {
+            return r;
+        }
+        uint64_t duration = timing.duration.count();
+        r = sd_bus_message_append(m, "(sst)", timing.stage.c_str(),
+                                  toString(timing.result), duration);
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    return sd_bus_message_close_container(m);
+}
+
+int TimeTransaction::methodSetManualTime(sd_bus_message* msg, void* userdata,
+                                         sd_bus_error* error)
+{
+    auto* transaction = static_cast<TimeTransaction*>(userdata);
+
+    uint64_t time = 0;
+    int restore = 0;
+    auto r = sd_bus_message_read(msg, "tb", &time, &restore);
+    if (r < 0)
+    {
+        return r;
+    }
+
+    auto result = transaction->setManualTime(microseconds(time), restore != 0,
+                                             sd_bus_message_get_sender(msg));
+    if (!result)
+    {
+        // An error that never left the bus has no name of its own
+        const auto& name = result.error().name;
+        return sd_bus_error_set(
+            error,
+            name.empty() ? common::InternalFailure().name() : name.c_str(),
+            result.error().message.c_str());
+    }
+
+    sd_bus_message* m = nullptr;
+    r = sd_bus_message_new_method_return(msg, &m);
+    if (r < 0)
+    {
+        return r;
+    }
+    r = appendStages(m, transaction->lastStages());
+    if (r >= 0)
+    {
+        r = sd_bus_send(nullptr, m, nullptr);
+    }
+    sd_bus_message_unref(m);
+    return r;
+}
+
+int TimeTransaction::getLastStages(sd_bus* /* bus */, const char* /* path */,
+                                   const char* /* intf */,
+                                   const char* /* property */,
+                                   sd_bus_message* reply, void* userdata,
+                                   sd_bus_error* /* error */)
+{
+    const auto* transaction = static_cast<const TimeTransaction*>(userdata);
+    return appendStages(reply, transaction->lastStages());
+}
+
+} // namespace time
+} // namespace phosphor
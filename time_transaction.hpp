@@ -0,0 +1,173 @@
+#pragma once
+
+#include "clock.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class TimeTransaction
+ *  @brief Set a manual time in NTP mode in one call.
+ *  @details Otherwise a client writes TimeSyncMethod, waits for the
+ *  settings signal to make the manager disable NTP, sets Elapsed and maybe
+ *  switches back, a round trip per step racing the signals. Here the
+ *  stages run back to back in the daemon:
+ *  - mode: write Manual to the settings and take it as the current mode
+ *  - ntp: disable NTP of systemd time service
+ *  - time: step the clock
+ *  - restore: if asked and the mode was NTP, switch back to it
+ *
+ *  The mode and ntp stages are skipped in Manual mode. When a stage fails
+ *  the applied ones are undone in reverse, the time by stepping back to
+ *  where the clock would be without the transaction. The duration and the
+ *  result of each stage are returned and kept in LastStages.
+ *
+ *  The transaction is xyz.openbmc_project.Time.Manager.Transaction:
+ *  - SetManualTime(t elapsed, b restore) -> a(sst): the stages, their
+ *    results and durations in microseconds. Fails with the error of the
+ *    stage that failed, after the rollback.
+ *  - LastStages a(sst): the stages of the last transaction, with the
+ *    rollback, also when it failed
+ */
+class TimeTransaction
+{
+  public:
+    /** @brief The operations the stages are made of */
+    struct Operations
+    {
+        /** @brief Get the current time mode */
+        std::function<Mode()> getMode;
+
+        /** @brief Write the time mode to the settings */
+        std::function<utils::Expected<void>(Mode)> setMode;
+
+        /** @brief Enable or disable NTP of systemd time service */
+        std::function<utils::Expected<void>(bool)> setNtp;
+
+        /** @brief Step the clock to the given time */
+        std::function<utils::Expected<void>(std::chrono::microseconds)> step;
+    };
+
+    /** @brief Admit a transaction requested by a D-Bus sender */
+    using Admit = std::function<utils::Expected<void>(const char* sender)>;
+
+    /** @brief What became of a stage */
+    enum class Result
+    {
+        Applied,
+        Skipped,
+        Failed,
+        RolledBack,
+        RollbackFailed,
+    };
+
+    /** @brief The timing of a stage */
+    struct Timing
+    {
+        std::string stage;
+        Result result;
+        std::chrono::microseconds duration;
+    };
+
+    /** @brief Constructor
+     *
+     * @param[in] bus        - The Dbus bus object
+     * @param[in] objPath    - The object to add the interface to
+     * @param[in] clock      - The clock the stages are timed and the
+     *                         rollback is stepped with
+     * @param[in] operations - The operations of the stages
+     * @param[in] admit      - The admission control of the senders, all
+     *                         are admitted if empty
+     */
+    TimeTransaction(sdbusplus::bus_t& bus, const char* objPath,
+                    const Clock& clock, Operations operations,
+                    Admit admit = {});
+    ~TimeTransaction() = default;
+
+    TimeTransaction(const TimeTransaction&) = delete;
+    TimeTransaction(TimeTransaction&&) = delete;
+    TimeTransaction& operator=(const TimeTransaction&) = delete;
+    TimeTransaction& operator=(TimeTransaction&&) = delete;
+
+    /** @brief Set a manual time, switching to Manual mode if needed
+     *
+     * @param[in] time    - The time to set, microseconds since UTC
+     * @param[in] restore - Whether to switch back to NTP mode afterwards
+     * @param[in] sender  - The D-Bus sender requesting it, if any
+     *
+     * @return Nothing or the error of the admission or of the stage that
+     *         failed
+     */
+    utils::Expected<void> setManualTime(std::chrono::microseconds time,
+                                        bool restore,
+                                        const char* sender = nullptr);
+
+    /** @brief Get the stages of the last transaction */
+    const std::vector<Timing>& lastStages() const
+    {
+        return stages;
+    }
+
+    /** @brief Get the name of a result as published on D-Bus */
+    static const char* toString(Result result);
+
+  private:
+    /** @brief A stage and how to undo it */
+    struct Stage
+    {
+        const char* name;
+        std::function<utils::Expected<void>()> apply;
+        std::function<utils::Expected<void>()> undo;
+    };
+
+    /** @brief The clock the stages are timed with */
+    const Clock& clock;
+
+    /** @brief The operations of the stages */
+    Operations operations;
+
+    /** @brief The admission control of the senders */
+    Admit admit;
+
+    /** @brief The stages of the last transaction */
+    std::vector<Timing> stages;
+
+    /** @brief The Transaction interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the Transaction interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Run the stages in order, undo the applied ones on a failure
+     *
+     * @param[in] pipeline - The stages, a stage without apply is skipped
+     *
+     * @return Nothing or the error of the stage that failed
+     */
+    utils::Expected<void> run(const std::vector<Stage>& pipeline);
+
+    /** @brief Append the stages to a reply or a property */
+    static int appendStages(sd_bus_message* m,
+                            const std::vector<Timing>& stages);
+
+    static int methodSetManualTime(sd_bus_message* msg, void* userdata,
+                                   sd_bus_error* error);
+    static int getLastStages(sd_bus* bus, const char* path, const char* intf,
+                             const char* property, sd_bus_message* reply,
+                             void* userdata, sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,262 @@
+#include "time_zone.hpp"
+
+#include "types.hpp"
+
+#include <sys/inotify.h>
+#include <time.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstdlib>
+#include <string_view>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto propertyName = "Name";
+constexpr auto propertyUtcOffset = "UtcOffset";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+
+using namespace std::chrono;
+
+/** @brief The offset to UTC now and the time it changes next */
+struct Offsets
+{
+    seconds offset{};
+    std::optional<seconds> next;
+};
+
+/** @brief Read the offsets of a zoneinfo file
+ *
+ * The file is read by the time functions of the C library, with TZ
+ * pointing to it until the offsets are known. The next change is looked
+ * for day by day within a year and then narrowed down to the second.
+ *
+ * @param[in] file - The zoneinfo file
+ * @param[in] now  - The time to get the offset at
+ *
+ * @return The offsets, UTC if the file cannot be read
+ */
+Offsets readOffsets(const std::filesystem::path& file, seconds now)
+{
+    std::optional<std::string> tz;
+    if (const char* env = std::getenv("TZ"))
+    {
+        tz = env;
+    }
+    setenv("TZ", (":" + file.string()).c_str(), 1);
+    tzset();
+
+    auto offsetAt = [](seconds t) {
+        time_t tt = t.count();
+        tm tm{};
+        localtime_r(&tt, &tm);
+        return seconds(tm.tm_gmtoff);
+    };
+
+    Offsets result{offsetAt(now), std::nullopt};
+    constexpr seconds day = hours(24);
+    for (auto t = now + day; t <= now + days(366); t += day)
+    {
+        if (offsetAt(t) == result.offset)
+        {
+            continue;
+        }
+        auto before = t - day;
+        auto after = t;
+        while (after - before > seconds(1))
+        {
+            auto middle = before + (after - before) / 2;
+            (offsetAt(middle) == result.offset ? before : after) = middle;
+        }
+        result.next = after;
+        break;
+    }
+
+    if (tz)
+    {
+        setenv("TZ", tz->c_str(), 1);
+    }
+    else
+    {
+        unsetenv("TZ");
+    }
+    tzset();
+    return result;
+}
+
+/** @brief Get the zone name from a symlink into the zoneinfo database
+ *
+ * @param[in] file - The zoneinfo file
+ *
+ * @return The zone name or std::nullopt if the file is no such symlink
+ */
+std::optional<std::string> linkedName(const std::filesystem::path& file)
+{
+    std::error_code ec;
+    auto target = std::filesystem::read_symlink(file, ec).string();
+    constexpr std::string_view database = "zoneinfo/";
+    auto pos = target.find(database);
+    if (ec || pos == std::string::npos)
+    {
+        return std::nullopt;
+    }
+    return target.substr(pos + database.size());
+}
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+TimeZone::TimeZone(sdbusplus::bus_t& bus, const char* objPath,
+                   const Clock& clock, TimeEvents& events,
+                   std::filesystem::path file) :
+    clock(clock), events(events), file(std::move(file)),
+    timer(bus.get_event(), CLOCK_REALTIME, [this]() { refresh(); },
+          seconds(1)),
+    interface(bus, objPath, timeZoneIntf, vtable, this)
+{
+    // The file is usually replaced rather than written, so its directory
+    // is watched and the events of other files are dropped.
+    if (auto* loop = bus.get_event())
+    {
+        sd_event_source* es = nullptr;
+        auto r = sd_event_add_inotify(
+            loop, &es, this->file.parent_path().c_str(),
+            IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                IN_CLOSE_WRITE | IN_ONLYDIR,
+            onFileChanged, this);
+        if (r < 0)
+        {
+            error("Failed to watch {PATH}: {ERRNO}", "PATH",
+                  this->file.parent_path().string(), "ERRNO", -r);
+        }
+        else
+        {
+            watch.reset(es);
+        }
+    }
+
+    events.subscribe(*this);
+    refresh();
+}
+
+TimeZone::~TimeZone()
+{
+    events.unsubscribe(*this);
+}
+
+void TimeZone::refresh()
+{
+    auto now = duration_cast<seconds>(clock.now());
+    auto offsets = readOffsets(file, now);
+
+    std::string name;
+    std::error_code ec;
+    if (auto linked = linkedName(file))
+    {
+        name = std::move(*linked);
+    }
+    else if (!reportedName.empty())
+    {
+        name = reportedName;
+    }
+    else if (!std::filesystem::exists(file, ec))
+    {
+        name = "UTC";
+    }
+
+    bool changed = false;
+    if (name != zoneName)
+    {
+        zoneName = std::move(name);
+        interface.property_changed(propertyName);
+        changed = true;
+    }
+    if (offsets.offset != offset)
+    {
+        offset = offsets.offset;
+        interface.property_changed(propertyUtcOffset);
+        changed = true;
+    }
+    if (changed)
+    {
+        info("Time zone is {NAME}, UTC offset {OFFSET}s", "NAME", zoneName,
+             "OFFSET", offset.count());
+    }
+
+    next = offsets.next;
+    if (next)
+    {
+        timer.armRelative(*next - now);
+    }
+    else
+    {
+        timer.disarm();
+    }
+}
+
+void TimeZone::onEvent(const event::Jump& /* event */)
+{
+    refresh();
+}
+
+void TimeZone::onEvent(const event::Timezone& event)
+{
+    if (event.name == reportedName)
+    {
+        return;
+    }
+    reportedName = event.name;
+
+    // timedated replaces the symlink too, which is picked up by inotify
+    // unless the file is no symlink.
+    if (event.name != zoneName)
+    {
+        refresh();
+    }
+}
+
+int TimeZone::onFileChanged(sd_event_source* /* es */,
+                            const inotify_event* event, void* userdata)
+{
+    auto* zone = static_cast<TimeZone*>(userdata);
+    if ((event->mask & IN_Q_OVERFLOW) ||
+        (event->len > 0 && zone->file.filename() == event->name))
+    {
+        zone->timer.armRelative(settleDelay);
+    }
+    return 0;
+}
+
+const sdbusplus::vtable_t TimeZone::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyName, "s", getName, emitsChange),
+    sdbusplus::vtable::property(propertyUtcOffset, "x", getUtcOffset,
+                                emitsChange),
+    sdbusplus::vtable::end(),
+};
+
+int TimeZone::getName(sd_bus* /* bus */, const char* /* path */,
+                      const char* /* intf */, const char* /* property */,
+                      sd_bus_message* reply, void* userdata,
+                      sd_bus_error* /* error */)
+{
+    const auto* zone = static_cast<const TimeZone*>(userdata);
+    return sd_bus_message_append(reply, "s", zone->name().c_str());
+}
+
+int TimeZone::getUtcOffset(sd_bus* /* bus */, const char* /* path */,
+                           const char* /* intf */, const char* /* property */,
+                           sd_bus_message* reply, void* userdata,
+                           sd_bus_error* /* error */)
+{
+    const auto* zone = static_cast<const TimeZone*>(userdata);
+    int64_t offset = zone->utcOffset().count();
+    return sd_bus_message_append(reply, "x", offset);
+}
+
+} // namespace time
+} // namespace phosphor
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "clock.hpp"
+#include "event_timer.hpp"
+#include "events.hpp"
+
+#include <systemd/sd-event.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class TimeZone
+ *  @brief Publish the local time zone from a cache.
+ *  @details The zone name and the UTC offset are read from the zoneinfo
+ *  file once per change and served from memory. The cache is refreshed
+ *  when the file is replaced or written, watched by inotify on its
+ *  directory, when timedated reports another Timezone, when the clock is
+ *  stepped, and at the next change of the offset, e.g. the start or end of
+ *  daylight saving time.
+ *
+ *  The zone is published as xyz.openbmc_project.Time.Manager.TimeZone:
+ *  - Name: the zone name, e.g. "Europe/Berlin", from the symlink into the
+ *    zoneinfo database, or as reported by timedated if the file is not a
+ *    symlink
+ *  - UtcOffset: the offset of the local time to UTC in seconds
+ */
+class TimeZone
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param[in] bus     - The Dbus bus object
+     * @param[in] objPath - The object to add the interface to
+     * @param[in] clock   - The clock to get the offset for
+     * @param[in] events  - The time events to subscribe to
+     * @param[in] file    - The zoneinfo file of the local time
+     */
+    TimeZone(sdbusplus::bus_t& bus, const char* objPath, const Clock& clock,
+             TimeEvents& events, std::filesystem::path file);
+    ~TimeZone();
+
+    TimeZone(const TimeZone&) = delete;
+    TimeZone(TimeZone&&) = delete;
+    TimeZone& operator=(const TimeZone&) = delete;
+    TimeZone& operator=(TimeZone&&) = delete;
+
+    /** @brief Read the zoneinfo file again and publish the changes */
+    void refresh();
+
+    /** @brief The offset may have changed with the time */
+    void onEvent(const event::Jump& event);
+
+    /** @brief timedated reports the zone, refresh if it is another one */
+    void onEvent(const event::Timezone& event);
+
+    /** @brief Get the zone name */
+    const std::string& name() const
+    {
+        return zoneName;
+    }
+
+    /** @brief Get the offset of the local time to UTC */
+    std::chrono::seconds utcOffset() const
+    {
+        return offset;
+    }
+
+    /** @brief Get the time of the next change of the offset, if there is
+     *         one within a year */
+    std::optional<std::chrono::seconds> nextChange() const
+    {
+        return next;
+    }
+
+    /** @brief The delay from a change of the file to the refresh, so a
+     *         replacement made of several steps is read once */
+    static constexpr std::chrono::milliseconds settleDelay{100};
+
+  private:
+    /** @brief The clock to get the offset for */
+    const Clock& clock;
+
+    /** @brief The time events subscribed to */
+    TimeEvents& events;
+
+    /** @brief The zoneinfo file of the local time */
+    std::filesystem::path file;
+
+    /** @brief The zone name last reported by timedated */
+    std::string reportedName;
+
+    /** @brief The cached zone name */
+    std::string zoneName;
+
+    /** @brief The cached offset to UTC */
+    std::chrono::seconds offset{};
+
+    /** @brief The time of the next change of the offset */
+    std::optional<std::chrono::seconds> next;
+
+    /** @brief The timer of the refreshes */
+    EventTimer timer;
+
+    /** @brief The TimeZone interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the TimeZone interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Called on a change in the directory of the file
+     *
+     * @param[in] es       - Source of the event
+     * @param[in] event    - The inotify event
+     * @param[in] userdata - User data pointer
+     */
+    static int onFileChanged(sd_event_source* es, const inotify_event* event,
+                             void* userdata);
+
+    /** @brief The deleter of sd_event_source */
+    std::function<void(sd_event_source*)> sdEventSourceDeleter =
+        [](sd_event_source* p) {
+            if (p)
+            {
+                sd_event_source_unref(p);
+            }
+        };
+    using SdEventSource =
+        std::unique_ptr<sd_event_source, decltype(sdEventSourceDeleter)>;
+
+    /** @brief The inotify event source of the directory of the file */
+    SdEventSource watch{nullptr, sdEventSourceDeleter};
+
+    static int getName(sd_bus* bus, const char* path, const char* intf,
+                       const char* property, sd_bus_message* reply,
+                       void* userdata, sd_bus_error* error);
+    static int getUtcOffset(sd_bus* bus, const char* path, const char* intf,
+                            const char* property, sd_bus_message* reply,
+                            void* userdata, sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor
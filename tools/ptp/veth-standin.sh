@@ -0,0 +1,40 @@
+#!/bin/bash
+#
+# Run a PTP master and slave with software timestamping on a veth pair, so
+# the time sync by PTP can be tried without PTP hardware. The master runs
+# in its own network namespace, the slave in the current one and answers
+# on the management socket given as the argument, /var/run/ptp4l by
+# default. Needs root and linuxptp; stop it with Ctrl-C.
+#
+#   tools/ptp/veth-standin.sh /tmp/ptp4l
+#   pmc -u -b 0 -s /tmp/ptp4l 'GET CURRENT_DATA_SET'
+
+set -euo pipefail
+
+socket="${1:-/var/run/ptp4l}"
+ns=ptp-standin
+
+cleanup()
+{
+    kill $(jobs -p) 2>/dev/null || true
+    ip netns del "$ns" 2>/dev/null || true
+    ip link del ptp-slave 2>/dev/null || true
+}
+trap cleanup EXIT
+
+ip netns add "$ns"
+ip link add ptp-slave type veth peer name ptp-master
+ip link set ptp-master netns "$ns"
+ip addr add 192.0.2.2/24 dev ptp-slave
+ip link set ptp-slave up
+ip netns exec "$ns" ip addr add 192.0.2.1/24 dev ptp-master
+ip netns exec "$ns" ip link set ptp-master up
+ip netns exec "$ns" ip link set lo up
+
+# The slave steps the system clock itself with software timestamping,
+# there is no PTP hardware clock for phc2sys to follow. The master keeps
+# its socket apart from the one of the slave.
+ip netns exec "$ns" ptp4l -S -m -i ptp-master --priority1 1 \
+    --uds_address "/run/ptp4l-$ns" &
+ptp4l -S -m -s -i ptp-slave --uds_address "$socket" &
+wait
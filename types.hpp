@@ -5,6 +5,28 @@
 static constexpr auto objmgrpath = "/xyz/openbmc_project/time";
 static constexpr auto objpathBmc = "/xyz/openbmc_project/time/bmc";
 static constexpr auto busname = "xyz.openbmc_project.Time.Manager";
+static constexpr auto clockSourceIntf =
+    "xyz.openbmc_project.Time.Manager.ClockSource";
+static constexpr auto dateTimeIntf = "xyz.openbmc_project.Time.Manager.DateTime";
+static constexpr auto rateLimitIntf =
+    "xyz.openbmc_project.Time.Manager.RateLimit";
+static constexpr auto holdoverIntf = "xyz.openbmc_project.Time.Manager.Holdover";
+static constexpr auto jumpNotifierIntf =
+    "xyz.openbmc_project.Time.Manager.JumpNotifier";
+static constexpr auto modeTraceIntf =
+    "xyz.openbmc_project.Time.Manager.ModeTrace";
+static constexpr auto ptpIntf = "xyz.openbmc_project.Time.Manager.Ptp";
+static constexpr auto rtcIntf = "xyz.openbmc_project.Time.Manager.Rtc";
+static constexpr auto scheduledSetIntf =
+    "xyz.openbmc_project.Time.Manager.ScheduledSet";
+static constexpr auto timeZoneIntf = "xyz.openbmc_project.Time.Manager.TimeZone";
+static constexpr auto transactionIntf =
+    "xyz.openbmc_project.Time.Manager.Transaction";
+static constexpr auto writeBackIntf =
+    "xyz.openbmc_project.Time.Manager.WriteBack";
+static constexpr auto stateFile = "/run/phosphor-time-manager/state";
+static constexpr auto localtimeFile = "/etc/localtime";
+static constexpr auto clockSourceDir = "/sys/devices/system/clocksource";
 
 namespace phosphor
 {
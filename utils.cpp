@@ -1,5 +1,10 @@
 #include "utils.hpp"
 
+#include "metrics.hpp"
+#include "probes.hpp"
+
+#include <cstring>
+
 namespace phosphor
 {
 namespace time
@@ -17,35 +22,146 @@ namespace utils
 
 PHOSPHOR_LOG2_USING;
 
-std::string getService(sdbusplus::bus_t& bus, const char* path,
-                       const char* interface)
+Expected<sdbusplus::message_t> call(sdbusplus::bus_t& bus,
+                                    sdbusplus::message_t& method)
 {
-    auto mapper = bus.new_method_call(mapperBusname, mapperPath,
-                                      mapperInterface, "GetObject");
+    sd_bus_error error = SD_BUS_ERROR_NULL;
+    sd_bus_message* reply = nullptr;
 
-    mapper.append(path, std::vector<std::string>({interface}));
-    try
+    auto r = sd_bus_call(bus.get(), method.get(), 0, &error, &reply);
+    if (r < 0)
     {
-        auto mapperResponseMsg = bus.call(mapper);
+        Error e{r, error.name ? error.name : "",
+                error.message ? error.message : std::strerror(-r)};
+        sd_bus_error_free(&error);
+        return std::unexpected(std::move(e));
+    }
 
-        std::vector<std::pair<std::string, std::vector<std::string>>>
-            mapperResponse;
-        mapperResponseMsg.read(mapperResponse);
-        if (mapperResponse.empty())
-        {
-            error("Error reading mapper response");
-            throw std::runtime_error("Error reading mapper response");
-        }
+    sdbusplus::message_t msg(reply);
+    sd_bus_message_unref(reply);
+    return msg;
+}
+
+namespace // anonymous
+{
+
+/** @brief Called by sd-bus with the reply of callAsync() */
+int onAsyncReply(sd_bus_message* reply, void* userdata,
+                 sd_bus_error* /* error */)
+{
+    const auto& handler = *static_cast<ReplyHandler*>(userdata);
+    if (sd_bus_message_is_method_error(reply, nullptr))
+    {
+        const auto* e = sd_bus_message_get_error(reply);
+        auto r = -sd_bus_message_get_errno(reply);
+        handler(std::unexpected(
+            Error{r, e && e->name ? e->name : "",
+                  e && e->message ? e->message : std::strerror(-r)}));
+        return 0;
+    }
+    handler(sdbusplus::message_t(reply));
+    return 0;
+}
 
-        return mapperResponse[0].first;
+/** @brief Get the service from the reply of the mapper's GetObject */
+Expected<std::string> readService(Expected<sdbusplus::message_t>& reply)
+{
+    if (!reply)
+    {
+        return std::unexpected(std::move(reply.error()));
+    }
+
+    std::vector<std::pair<std::string, std::vector<std::string>>>
+        mapperResponse;
+    try
+    {
+        reply->read(mapperResponse);
     }
     catch (const sdbusplus::exception_t& ex)
+    {
+        return std::unexpected(Error{-EBADMSG, ex.name(), ex.description()});
+    }
+
+    if (mapperResponse.empty())
+    {
+        return std::unexpected(
+            Error{-ENOENT, "", "Error reading mapper response"});
+    }
+
+    return std::move(mapperResponse[0].first);
+}
+
+} // namespace
+
+Expected<void> callAsync(sdbusplus::bus_t& bus, sdbusplus::message_t& method,
+                         ReplyHandler handler)
+{
+    auto* userdata = new ReplyHandler(std::move(handler));
+    sd_bus_slot* slot = nullptr;
+    auto r = sd_bus_call_async(bus.get(), &slot, method.get(), onAsyncReply,
+                               userdata, 0);
+    if (r < 0)
+    {
+        delete userdata;
+        return std::unexpected(Error{r, "", std::strerror(-r)});
+    }
+
+    // The bus keeps the slot until the reply comes, and the handler goes
+    // with the slot
+    sd_bus_slot_set_destroy_callback(
+        slot, [](void* p) { delete static_cast<ReplyHandler*>(p); });
+    sd_bus_slot_set_floating(slot, 1);
+    sd_bus_slot_unref(slot);
+    return {};
+}
+
+Expected<std::string> tryGetService(sdbusplus::bus_t& bus, const char* path,
+                                    const char* interface)
+{
+    auto mapper = bus.new_method_call(mapperBusname, mapperPath,
+                                      mapperInterface, "GetObject");
+
+    mapper.append(path, std::vector<std::string>({interface}));
+
+    TIME_PROBE(mapper_get_object_entry, path);
+    ++metrics::get().mapperCalls;
+    auto mapperResponseMsg = call(bus, mapper);
+    TIME_PROBE(mapper_get_object_return, path,
+               mapperResponseMsg ? 0 : mapperResponseMsg.error().errnum);
+    return readService(mapperResponseMsg);
+}
+
+Expected<void> getServiceAsync(
+    sdbusplus::bus_t& bus, const char* path, const char* interface,
+    std::function<void(Expected<std::string> service)> handler)
+{
+    auto mapper = bus.new_method_call(mapperBusname, mapperPath,
+                                      mapperInterface, "GetObject");
+
+    mapper.append(path, std::vector<std::string>({interface}));
+
+    TIME_PROBE(mapper_get_object_entry, path);
+    ++metrics::get().mapperCalls;
+    return callAsync(bus, mapper,
+                     [handler = std::move(handler)](
+                         Expected<sdbusplus::message_t> reply) {
+                         handler(readService(reply));
+                     });
+}
+
+std::string getService(sdbusplus::bus_t& bus, const char* path,
+                       const char* interface)
+{
+    auto service = tryGetService(bus, path, interface);
+    if (!service)
     {
         error(
             "Mapper call failed: path:{PATH}, interface:{INTF}, error:{ERROR}",
-            "PATH", path, "INTF", interface, "ERROR", ex);
+            "PATH", path, "INTF", interface, "ERROR", service.error().message);
         throw std::runtime_error("Mapper call failed");
     }
+
+    return std::move(*service);
 }
 
 MapperResponse getSubTree(sdbusplus::bus_t& bus, const std::string& root,
@@ -57,13 +173,58 @@ MapperResponse getSubTree(sdbusplus::bus_t& bus, const std::string& root,
     mapperCall.append(depth);
     mapperCall.append(interfaces);
 
+    TIME_PROBE(mapper_get_subtree_entry, root.c_str());
+    ++metrics::get().mapperCalls;
     auto response = bus.call(mapperCall);
+    TIME_PROBE(mapper_get_subtree_return, root.c_str());
 
     MapperResponse result;
     response.read(result);
     return result;
 }
 
+int enterChangedProperty(sd_bus_message* msg, std::string_view name,
+                         const char* contents)
+{
+    const char* interface = nullptr;
+    auto r = sd_bus_message_read_basic(msg, 's', &interface);
+    if (r < 0)
+    {
+        return r;
+    }
+    r = sd_bus_message_enter_container(msg, 'a', "{sv}");
+    if (r <= 0)
+    {
+        return r;
+    }
+
+    while ((r = sd_bus_message_enter_container(msg, 'e', "sv")) > 0)
+    {
+        const char* key = nullptr;
+        r = sd_bus_message_read_basic(msg, 's', &key);
+        if (r < 0)
+        {
+            return r;
+        }
+        if (name == key)
+        {
+            // Fails with -ENXIO if the value is of another type
+            return sd_bus_message_enter_container(msg, 'v', contents);
+        }
+        r = sd_bus_message_skip(msg, "v");
+        if (r < 0)
+        {
+            return r;
+        }
+        r = sd_bus_message_exit_container(msg);
+        if (r < 0)
+        {
+            return r;
+        }
+    }
+    return r;
+}
+
 Mode strToMode(const std::string& mode)
 {
     return ModeSetting::convertMethodFromString(mode);
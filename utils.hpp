@@ -5,7 +5,12 @@
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
 
+#include <cerrno>
+#include <expected>
+#include <functional>
+#include <optional>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace phosphor
@@ -24,7 +29,56 @@ using MapperResponse =
 
 PHOSPHOR_LOG2_USING;
 
+/** @brief A failed D-Bus call, returned by value instead of thrown */
+struct Error
+{
+    /** @brief The negative errno reported by sd-bus */
+    int errnum = 0;
+
+    /** @brief The D-Bus error name, empty if the call never left the bus */
+    std::string name;
+
+    /** @brief The description of the failure */
+    std::string message;
+};
+
+/** @brief The result of the non-throwing D-Bus helpers */
+template <typename T>
+using Expected = std::expected<T, Error>;
+
+/** @brief Call a method without throwing on failure
+ *
+ * The call is done with sd_bus_call() directly so a D-Bus error reply, a
+ * timeout or a missing peer is turned into an Error without unwinding.
+ *
+ * @param[in] bus    - The Dbus bus object
+ * @param[in] method - The method call message
+ *
+ * @return The reply message or the error of the call
+ */
+Expected<sdbusplus::message_t> call(sdbusplus::bus_t& bus,
+                                    sdbusplus::message_t& method);
+
+/** @brief The function called with the reply of an asynchronous call */
+using ReplyHandler = std::function<void(Expected<sdbusplus::message_t> reply)>;
+
+/** @brief Call a method without waiting for the reply
+ *
+ * The handler is called from the event loop once the reply, an error
+ * reply or a timeout comes. The pending call is owned by the bus.
+ *
+ * @param[in] bus     - The Dbus bus object
+ * @param[in] method  - The method call message
+ * @param[in] handler - The function called with the reply
+ *
+ * @return Nothing or the error of sending the call, the handler is not
+ *         called then
+ */
+Expected<void> callAsync(sdbusplus::bus_t& bus, sdbusplus::message_t& method,
+                         ReplyHandler handler);
+
 /** @brief The template function to get property from the requested dbus path
+ *         without throwing
  *
  * @param[in] bus          - The Dbus bus object
  * @param[in] service      - The Dbus service name
@@ -32,33 +86,68 @@ PHOSPHOR_LOG2_USING;
  * @param[in] interface    - The Dbus interface
  * @param[in] propertyName - The property name to get
  *
- * @return The value of the property
+ * @return The value of the property or the error of the call
  */
 template <typename T>
-T getProperty(sdbusplus::bus_t& bus, const char* service, const char* path,
-              const char* interface, const char* propertyName)
+Expected<T> tryGetProperty(sdbusplus::bus_t& bus, const char* service,
+                           const char* path, const char* interface,
+                           const char* propertyName)
 {
     auto method = bus.new_method_call(service, path,
                                       "org.freedesktop.DBus.Properties", "Get");
     method.append(interface, propertyName);
+
+    auto reply = call(bus, method);
+    if (!reply)
+    {
+        return std::unexpected(std::move(reply.error()));
+    }
+
+    // A reply of the wrong type is a peer bug rather than an outage, so
+    // the exception thrown by read() is only converted here.
     try
     {
         std::variant<T> value{};
-        auto reply = bus.call(method);
-        reply.read(value);
+        reply->read(value);
         return std::get<T>(value);
     }
     catch (const sdbusplus::exception_t& ex)
+    {
+        return std::unexpected(Error{-EBADMSG, ex.name(), ex.description()});
+    }
+}
+
+/** @brief The template function to get property from the requested dbus path
+ *
+ * @param[in] bus          - The Dbus bus object
+ * @param[in] service      - The Dbus service name
+ * @param[in] path         - The Dbus object path
+ * @param[in] interface    - The Dbus interface
+ * @param[in] propertyName - The property name to get
+ *
+ * @return The value of the property
+ *
+ * @throw std::runtime_error when it fails
+ */
+template <typename T>
+T getProperty(sdbusplus::bus_t& bus, const char* service, const char* path,
+              const char* interface, const char* propertyName)
+{
+    auto value =
+        tryGetProperty<T>(bus, service, path, interface, propertyName);
+    if (!value)
     {
         error("GetProperty call failed, path:{PATH}, interface:{INTF}, "
               "propertyName:{NAME}, error:{ERROR}",
               "PATH", path, "INTF", interface, "NAME", propertyName, "ERROR",
-              ex);
+              value.error().message);
         throw std::runtime_error("GetProperty call failed");
     }
+    return std::move(*value);
 }
 
 /** @brief The template function to set property to the requested dbus path
+ *         without throwing
  *
  * @param[in] bus          - The Dbus bus object
  * @param[in] service      - The Dbus service name
@@ -67,11 +156,13 @@ T getProperty(sdbusplus::bus_t& bus, const char* service, const char* path,
  * @param[in] propertyName - The property name to set
  * @param[in] value - the value to set the property to
  *
+ * @return Nothing or the error of the call
  */
 template <typename T>
-void setProperty(sdbusplus::bus_t& bus, const std::string& service,
-                 const std::string& path, const std::string& interface,
-                 const std::string& propertyName, T& value)
+Expected<void> trySetProperty(sdbusplus::bus_t& bus, const std::string& service,
+                              const std::string& path,
+                              const std::string& interface,
+                              const std::string& propertyName, T& value)
 {
     std::variant<T> propertyValue(value);
 
@@ -80,20 +171,69 @@ void setProperty(sdbusplus::bus_t& bus, const std::string& service,
 
     method.append(interface, propertyName, propertyValue);
 
-    try
+    auto reply = call(bus, method);
+    if (!reply)
     {
-        auto reply = bus.call(method);
+        return std::unexpected(std::move(reply.error()));
     }
-    catch (const sdbusplus::exception_t& ex)
+    return {};
+}
+
+/** @brief The template function to set property to the requested dbus path
+ *
+ * @param[in] bus          - The Dbus bus object
+ * @param[in] service      - The Dbus service name
+ * @param[in] path         - The Dbus object path
+ * @param[in] interface    - The Dbus interface
+ * @param[in] propertyName - The property name to set
+ * @param[in] value - the value to set the property to
+ *
+ * @throw std::runtime_error when it fails
+ */
+template <typename T>
+void setProperty(sdbusplus::bus_t& bus, const std::string& service,
+                 const std::string& path, const std::string& interface,
+                 const std::string& propertyName, T& value)
+{
+    auto result =
+        trySetProperty(bus, service, path, interface, propertyName, value);
+    if (!result)
     {
         error("SetProperty call failed, path:{PATH}, interface:{INTF}, "
               "propertyName:{NAME}, error:{ERROR}",
               "PATH", path, "INTF", interface, "NAME", propertyName, "ERROR",
-              ex);
+              result.error().message);
         throw std::runtime_error("SetProperty call failed");
     }
 }
 
+/** @brief Get service name from object path and interface without throwing
+ *
+ * @param[in] bus          - The Dbus bus object
+ * @param[in] path         - The Dbus object path
+ * @param[in] interface    - The Dbus interface
+ *
+ * @return The name of the service or the error of the mapper call
+ */
+Expected<std::string> tryGetService(sdbusplus::bus_t& bus, const char* path,
+                                    const char* interface);
+
+/** @brief Get service name from object path and interface without
+ *         waiting for the mapper
+ *
+ * @param[in] bus       - The Dbus bus object
+ * @param[in] path      - The Dbus object path
+ * @param[in] interface - The Dbus interface
+ * @param[in] handler   - The function called with the name of the service
+ *                        or the error of the mapper call
+ *
+ * @return Nothing or the error of sending the call, the handler is not
+ *         called then
+ */
+Expected<void> getServiceAsync(
+    sdbusplus::bus_t& bus, const char* path, const char* interface,
+    std::function<void(Expected<std::string> service)> handler);
+
 /** @brief Get service name from object path and interface
  *
  * @param[in] bus          - The Dbus bus object
@@ -101,6 +241,8 @@ void setProperty(sdbusplus::bus_t& bus, const std::string& service,
  * @param[in] interface    - The Dbus interface
  *
  * @return The name of the service
+ *
+ * @throw std::runtime_error when it fails
  */
 std::string getService(sdbusplus::bus_t& bus, const char* path,
                        const char* interface);
@@ -119,6 +261,68 @@ std::string getService(sdbusplus::bus_t& bus, const char* path,
 MapperResponse getSubTree(sdbusplus::bus_t& bus, const std::string& root,
                           const Interfaces& interfaces, int32_t depth);
 
+/** @brief Move a PropertiesChanged signal into the value of a property
+ *
+ * The changed properties before it are skipped without being unpacked.
+ *
+ * @param[in] msg      - The PropertiesChanged signal, not read yet
+ * @param[in] name     - The name of the property
+ * @param[in] contents - The signature of the value
+ *
+ * @return > 0 if the message is positioned at the value, 0 if the property
+ *         is not in the signal, < 0 on a malformed signal or another type
+ */
+int enterChangedProperty(sd_bus_message* msg, std::string_view name,
+                         const char* contents);
+
+/** @brief Get one property of a PropertiesChanged signal
+ *
+ * The signal is walked in place, so the other properties, whatever their
+ * type, cost no allocation. This keeps the handlers of the broad
+ * PropertiesChanged matches cheap when a storm of unrelated changes comes.
+ * The signal is rewound first, so several properties can be read from it.
+ *
+ * @param[in] msg  - The PropertiesChanged signal
+ * @param[in] name - The name of the property
+ *
+ * @return The value, or std::nullopt if the property is not in the signal
+ *         or is not of type T
+ */
+template <typename T>
+std::optional<T> getChangedProperty(sdbusplus::message_t& msg,
+                                    std::string_view name)
+{
+    static_assert(std::is_same_v<T, bool> || std::is_same_v<T, std::string>,
+                  "Only bool and string properties are supported");
+    constexpr bool isBool = std::is_same_v<T, bool>;
+
+    auto* m = msg.get();
+    if (sd_bus_message_rewind(m, true) < 0 ||
+        enterChangedProperty(m, name, isBool ? "b" : "s") <= 0)
+    {
+        return std::nullopt;
+    }
+
+    if constexpr (isBool)
+    {
+        int value = 0;
+        if (sd_bus_message_read_basic(m, 'b', &value) < 0)
+        {
+            return std::nullopt;
+        }
+        return value != 0;
+    }
+    else
+    {
+        const char* value = nullptr;
+        if (sd_bus_message_read_basic(m, 's', &value) < 0)
+        {
+            return std::nullopt;
+        }
+        return std::string(value);
+    }
+}
+
 /** @brief Convert a string to enum Mode
  *
  * Convert the time mode string to enum.
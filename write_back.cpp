@@ -0,0 +1,169 @@
+#include "write_back.hpp"
+
+#include "types.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+
+namespace phosphor
+{
+namespace time
+{
+namespace // anonymous
+{
+constexpr auto propertyPending = "Pending";
+constexpr auto propertyFailures = "Failures";
+constexpr auto propertyLastError = "LastError";
+constexpr auto emitsChange = sdbusplus::vtable::property_::emits_change;
+} // namespace
+
+PHOSPHOR_LOG2_USING;
+
+using namespace std::chrono;
+
+WriteBack::WriteBack(sdbusplus::bus_t& bus, const char* objPath, Send send) :
+    send(std::move(send)),
+    timer(bus.get_event(), CLOCK_MONOTONIC, [this]() { retry(); }),
+    interface(bus, objPath, writeBackIntf, vtable, this)
+{}
+
+void WriteBack::write(std::string value)
+{
+    bool wasPending = pending();
+    wanted = std::move(value);
+    if (!wasPending)
+    {
+        interface.property_changed(propertyPending);
+    }
+
+    // A value on its way or waiting for a retry is followed by this one
+    if (!sending && !timer.isArmed())
+    {
+        start();
+    }
+}
+
+void WriteBack::superseded(const std::string& value)
+{
+    // The value on its way is the echo of our own write, which may come
+    // after a newer value is wanted
+    if (!wanted || *wanted == value || sending == value)
+    {
+        return;
+    }
+    info("Dropped the write back of {VALUE}, changed to {NEW} since",
+         "VALUE", *wanted, "NEW", value);
+    wanted.reset();
+    timer.disarm();
+    interface.property_changed(propertyPending);
+}
+
+void WriteBack::retry()
+{
+    if (wanted && !sending)
+    {
+        start();
+    }
+}
+
+void WriteBack::start()
+{
+    sending = *wanted;
+    auto result = send(*sending, [this](utils::Expected<void> result) {
+        onDone(result);
+    });
+    if (!result)
+    {
+        onDone(result);
+    }
+}
+
+void WriteBack::onDone(const utils::Expected<void>& result)
+{
+    auto value = std::move(*sending);
+    sending.reset();
+
+    if (result)
+    {
+        if (failureCount > 0)
+        {
+            info("Wrote back {VALUE} after {FAILURES} failures", "VALUE",
+                 value, "FAILURES", failureCount);
+            failureCount = 0;
+            errorMessage.clear();
+            interface.property_changed(propertyFailures);
+            interface.property_changed(propertyLastError);
+        }
+        delay = minBackoff;
+
+        if (wanted == value)
+        {
+            wanted.reset();
+            interface.property_changed(propertyPending);
+        }
+        else if (wanted)
+        {
+            start();
+        }
+        return;
+    }
+
+    // Logged on the first failure only, the retries show in Failures
+    if (failureCount == 0)
+    {
+        error("Failed to write back {VALUE}, retrying: {ERROR}", "VALUE",
+              value, "ERROR", result.error().message);
+    }
+    ++failureCount;
+    errorMessage = result.error().message;
+    interface.property_changed(propertyFailures);
+    interface.property_changed(propertyLastError);
+
+    if (wanted)
+    {
+        timer.armRelative(delay);
+        delay = std::min(delay * 2, maxBackoff);
+    }
+}
+
+const sdbusplus::vtable_t WriteBack::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(propertyPending, "b", getPending, emitsChange),
+    sdbusplus::vtable::property(propertyFailures, "t", getFailures,
+                                emitsChange),
+    sdbusplus::vtable::property(propertyLastError, "s", getLastError,
+                                emitsChange),
+    sdbusplus::vtable::end(),
+};
+
+int WriteBack::getPending(sd_bus* /* bus */, const char* /* path */,
+                          const char* /* intf */, const char* /* property */,
+                          sd_bus_message* reply, void* userdata,
+                          sd_bus_error* /* error */)
+{
+    const auto* writeBack = static_cast<const WriteBack*>(userdata);
+    int pending = writeBack->pending();
+    return sd_bus_message_append(reply, "b", pending);
+}
+
+int WriteBack::getFailures(sd_bus* /* bus */, const char* /* path */,
+                           const char* /* intf */, const char* /* property */,
+                           sd_bus_message* reply, void* userdata,
+                           sd_bus_error* /* error */)
+{
+    const auto* writeBack = static_cast<const WriteBack*>(userdata);
+    return sd_bus_message_append(reply, "t", writeBack->failures());
+}
+
+int WriteBack::getLastError(sd_bus* /* bus */, const char* /* path */,
+                            const char* /* intf */, const char* /* property */,
+                            sd_bus_message* reply, void* userdata,
+                            sd_bus_error* /* error */)
+{
+    const auto* writeBack = static_cast<const WriteBack*>(userdata);
+    return sd_bus_message_append(reply, "s", writeBack->lastError().c_str());
+}
+
+} // namespace time
+} // namespace phosphor
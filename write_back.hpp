@@ -0,0 +1,156 @@
+#pragma once
+
+#include "event_timer.hpp"
+#include "utils.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace phosphor
+{
+namespace time
+{
+
+/** @class WriteBack
+ *  @brief Write a value to another service in the background until it
+ *         succeeds.
+ *  @details When timedated's NTP flips, the time mode is written back to
+ *  the settings. The write is sent without waiting for the reply, so the
+ *  event loop is never blocked on the settings or the mapper. Only the
+ *  latest value is kept: a value written while another is on its way is
+ *  sent once the first completes, and the ones in between are dropped. A
+ *  failed write is retried after a backoff that doubles from minBackoff
+ *  up to maxBackoff, and is reset by a success.
+ *
+ *  The state is published as xyz.openbmc_project.Time.Manager.WriteBack,
+ *  so the settings lagging behind timedated is visible:
+ *  - Pending b: a value is not written yet
+ *  - Failures t: the failed writes since the last success
+ *  - LastError s: the error of the last failed write, empty after a
+ *    success
+ */
+class WriteBack
+{
+  public:
+    /** @brief Called with the result of a write */
+    using Done = std::function<void(utils::Expected<void> result)>;
+
+    /** @brief Start writing the value, done is called once it completes,
+     *         unless the write cannot be sent and the error is returned */
+    using Send = std::function<utils::Expected<void>(const std::string& value,
+                                                     Done done)>;
+
+    /** @brief Constructor
+     *
+     * @param[in] bus     - The Dbus bus object
+     * @param[in] objPath - The object to add the interface to
+     * @param[in] send    - The function that writes a value
+     */
+    WriteBack(sdbusplus::bus_t& bus, const char* objPath, Send send);
+    ~WriteBack() = default;
+
+    WriteBack(const WriteBack&) = delete;
+    WriteBack(WriteBack&&) = delete;
+    WriteBack& operator=(const WriteBack&) = delete;
+    WriteBack& operator=(WriteBack&&) = delete;
+
+    /** @brief Write the value, replacing any value not written yet
+     *
+     * @param[in] value - The value to write
+     */
+    void write(std::string value);
+
+    /** @brief Drop a value not written yet if it differs from the given
+     *         one, as the target was changed by someone else since. The
+     *         value on its way is taken for the echo of the write.
+     *
+     * @param[in] value - The value the target was changed to
+     */
+    void superseded(const std::string& value);
+
+    /** @brief Send the value again, called by the timer */
+    void retry();
+
+    /** @brief Get whether a value is not written yet */
+    bool pending() const
+    {
+        return wanted.has_value();
+    }
+
+    /** @brief Get the failed writes since the last success */
+    uint64_t failures() const
+    {
+        return failureCount;
+    }
+
+    /** @brief Get the error of the last failed write */
+    const std::string& lastError() const
+    {
+        return errorMessage;
+    }
+
+    /** @brief Get the delay before the next retry */
+    std::chrono::seconds backoff() const
+    {
+        return delay;
+    }
+
+    /** @brief The delay before the first retry */
+    static constexpr std::chrono::seconds minBackoff{1};
+
+    /** @brief The longest delay between retries */
+    static constexpr std::chrono::seconds maxBackoff{64};
+
+  private:
+    /** @brief The function that writes a value */
+    Send send;
+
+    /** @brief The latest value not written yet */
+    std::optional<std::string> wanted;
+
+    /** @brief The value on its way, if any */
+    std::optional<std::string> sending;
+
+    /** @brief The failed writes since the last success */
+    uint64_t failureCount = 0;
+
+    /** @brief The error of the last failed write */
+    std::string errorMessage;
+
+    /** @brief The delay before the next retry */
+    std::chrono::seconds delay = minBackoff;
+
+    /** @brief The timer of the next retry */
+    EventTimer timer;
+
+    /** @brief The WriteBack interface */
+    sdbusplus::server::interface_t interface;
+
+    /** @brief The vtable of the WriteBack interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Send the wanted value */
+    void start();
+
+    /** @brief Called once the value on its way is written or failed */
+    void onDone(const utils::Expected<void>& result);
+
+    static int getPending(sd_bus* bus, const char* path, const char* intf,
+                          const char* property, sd_bus_message* reply,
+                          void* userdata, sd_bus_error* error);
+    static int getFailures(sd_bus* bus, const char* path, const char* intf,
+                           const char* property, sd_bus_message* reply,
+                           void* userdata, sd_bus_error* error);
+    static int getLastError(sd_bus* bus, const char* path, const char* intf,
+                            const char* property, sd_bus_message* reply,
+                            void* userdata, sd_bus_error* error);
+};
+
+} // namespace time
+} // namespace phosphor